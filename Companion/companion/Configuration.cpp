@@ -20,12 +20,35 @@
 
 Companion::Configuration::Configuration()
 {
-    this->source = nullptr;
+    std::promise<void> finished;
+
     this->processing = nullptr;
     this->worker = nullptr;
     this->skipFrame = 0;
+    this->adaptiveSkip = false;
+    this->targetRate = 0;
+    this->targetDepth = 1;
     this->threadsRunning = false;
     this->imageBuffer = 5;
+    this->consumerThreads = 1;
+    this->pipeline = false;
+    this->backpressure = BackpressurePolicy::BLOCK;
+    this->deadline = std::chrono::milliseconds(0);
+    this->metrics = std::make_shared<STREAM_METRICS>();
+
+    // Nothing runs yet, stopping returns a ready handle
+    finished.set_value();
+    this->running = finished.get_future().share();
+}
+
+Companion::Configuration::~Configuration()
+{
+    // Threads of a running job must not outlive this configuration
+    this->StopAsync(StopMode::ABORT);
+    if (this->runner.joinable())
+    {
+        this->runner.join();
+    }
 }
 
 void Companion::Configuration::Run()
@@ -33,56 +56,192 @@ void Companion::Configuration::Run()
     if (this->threadsRunning)
     {
         // Stop active worker if running
-        this->Stop();
+        this->StopAsync();
     }
     else
     {
-        // Create a new worker thread for execution only if no threads are active
-		this->worker = std::make_shared<STREAM_WORKER>(this->imageBuffer, this->colorFormat);
-
-        // Get all configuration data
-        // Throws Error if invalid settings are set.
-		PTR_STREAM stream = this->Source();
-        PTR_IMAGE_PROCESSING imageProcessing = this->Processing();
-        int skipFrame = this->SkipFrame();
-        std::function<ERROR_CALLBACK> errorCallback = this->ErrorCallback();
-        std::function<SUCCESS_CALLBACK> successCallback = this->ResultCallback();
-
-        // Run new worker class.
-        this->threadsRunning = true;
-        this->producer = std::thread(&Thread::StreamWorker::Produce, this->worker, stream, skipFrame, errorCallback);
-        this->consumer = std::thread(&Thread::StreamWorker::Consume, this->worker, imageProcessing, errorCallback, successCallback);
-        this->producer.join();
-        this->consumer.join();
-        this->threadsRunning = false;
+        this->RunAsync().wait();
     }
 }
 
-void Companion::Configuration::Stop()
+std::shared_future<void> Companion::Configuration::RunAsync()
 {
-    if (this->threadsRunning && (this->source != nullptr) && !this->source->IsFinished())
+    std::lock_guard<std::mutex> lk(this->runMx);
+
+    if (this->threadsRunning)
+    {
+        // Only one job runs at a time
+        return this->running;
+    }
+
+    if (this->runner.joinable())
+    {
+        // Previous job is finished, release its thread
+        this->runner.join();
+    }
+
+    // Get all configuration data
+    // Throws Error if invalid settings are set.
+    this->Source();
+    std::vector<PTR_STREAM> streams = this->sources;
+    PTR_IMAGE_PROCESSING imageProcessing = this->Processing();
+    int skipFrame = this->SkipFrame();
+    std::function<ERROR_CALLBACK> errorCallback = this->ErrorCallback();
+    std::function<STREAM_SUCCESS_CALLBACK> successCallback = this->streamCallback;
+    int consumerThreads = this->consumerThreads;
+    bool pipeline = this->pipeline;
+
+    if (!successCallback)
+    {
+        // Results of a plain result callback are not tagged
+        std::function<SUCCESS_CALLBACK> callback = this->ResultCallback();
+        successCallback = [callback](int, CALLBACK_RESULT results, cv::Mat source)
+        {
+            callback(results, source);
+        };
+    }
+
+    // Create a new worker for execution only if no threads are active
+    PTR_STREAM_WORKER worker = std::make_shared<STREAM_WORKER>(this->imageBuffer, this->colorFormat, this->backpressure, this->metrics, this->weights);
+    worker->Deadline(this->deadline);
+    worker->Stats(this->statsCallback);
+    if (this->adaptiveSkip)
     {
-        // To stop running worker threads stop streams.
-        this->source->Finish();
-        this->source = nullptr;
-        this->worker = nullptr;
+        // The slowest stage limits a pipeline, otherwise all consumers process whole frames concurrently
+        worker->AdaptiveSkip(std::make_shared<SKIP_CONTROLLER>(pipeline ? imageProcessing->Stages() : 1,
+            pipeline ? 1 : consumerThreads,
+            this->imageBuffer,
+            this->targetRate,
+            this->targetDepth,
+            skipFrame));
     }
+    std::shared_ptr<std::promise<void>> finished = std::make_shared<std::promise<void>>();
+
+    this->worker = worker;
+    this->streams = streams;
+    this->running = finished->get_future().share();
+    this->threadsRunning = true;
+
+    // Run new worker class.
+    this->runner = std::thread([this, worker, streams, imageProcessing, skipFrame, errorCallback, successCallback, consumerThreads, pipeline, finished]
+    {
+        std::vector<std::thread> threads;
+
+        // One producer for each stream because obtaining a frame blocks, all streams share the consumers
+        for (size_t i = 0; i < streams.size(); i++)
+        {
+            threads.push_back(std::thread(&Thread::StreamWorker::Produce, worker, streams.at(i), skipFrame, errorCallback, static_cast<int>(i)));
+        }
+        if (pipeline)
+        {
+            // One consumer for each stage of the image processing
+            int stages = imageProcessing->Stages();
+            worker->Pipeline(stages);
+            for (int stage = 0; stage < stages; stage++)
+            {
+                threads.push_back(std::thread(&Thread::StreamWorker::ConsumeStage, worker, stage, imageProcessing, errorCallback, successCallback));
+            }
+        }
+        else
+        {
+            for (int i = 0; i < consumerThreads; i++)
+            {
+                threads.push_back(std::thread(&Thread::StreamWorker::Consume, worker, imageProcessing, errorCallback, successCallback));
+            }
+        }
+
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            threads.at(i).join();
+        }
+
+        // Mark as stopped before the handle is ready, so waiting callers can run again right away
+        this->threadsRunning = false;
+        finished->set_value();
+    });
+
+    return this->running;
+}
+
+std::shared_future<void> Companion::Configuration::StopAsync(StopMode mode)
+{
+    std::lock_guard<std::mutex> lk(this->runMx);
+
+    if (!this->threadsRunning)
+    {
+        return this->running;
+    }
+
+    if (mode == StopMode::ABORT)
+    {
+        // Discard buffered frames and wake all waiting threads
+        this->worker->Abort();
+    }
+
+    for (size_t i = 0; i < this->streams.size(); i++)
+    {
+        if (!this->streams.at(i)->IsFinished())
+        {
+            // To stop running worker threads stop streams.
+            this->streams.at(i)->Finish();
+        }
+    }
+
+    return this->running;
+}
+
+bool Companion::Configuration::Stop(StopMode mode, std::chrono::milliseconds timeout)
+{
+    return this->StopAsync(mode).wait_for(timeout) == std::future_status::ready;
+}
+
+bool Companion::Configuration::IsRunning() const
+{
+    return this->threadsRunning;
 }
 
 PTR_STREAM Companion::Configuration::Source() const
 {
 
-    if (this->source == nullptr)
+    if (this->sources.empty() || this->sources.front() == nullptr)
     {
         throw Error::Code::stream_src_not_set;
     }
 
-    return this->source;
+    return this->sources.front();
 }
 
 void Companion::Configuration::Source(PTR_STREAM source)
 {
-    this->source = source;
+    this->sources.clear();
+    this->weights.clear();
+    if (source != nullptr)
+    {
+        this->AddSource(source);
+    }
+}
+
+int Companion::Configuration::AddSource(PTR_STREAM source, int weight)
+{
+
+    if (source == nullptr)
+    {
+        throw Error::Code::stream_src_not_set;
+    }
+
+    if (weight <= 0)
+    {
+        weight = 1;
+    }
+
+    this->sources.push_back(source);
+    this->weights.push_back(weight);
+    return static_cast<int>(this->sources.size()) - 1;
+}
+
+const std::vector<PTR_STREAM>& Companion::Configuration::Sources() const
+{
+    return this->sources;
 }
 
 PTR_IMAGE_PROCESSING Companion::Configuration::Processing() const
@@ -117,6 +276,29 @@ void Companion::Configuration::SkipFrame(int skipFrame)
     this->skipFrame = skipFrame;
 }
 
+bool Companion::Configuration::AdaptiveSkipFrame() const
+{
+    return this->adaptiveSkip;
+}
+
+void Companion::Configuration::AdaptiveSkipFrame(bool adaptive, double targetRate, int targetDepth)
+{
+
+    if (targetRate <= 0)
+    {
+        targetRate = 0;
+    }
+
+    if (targetDepth < 0)
+    {
+        targetDepth = 0;
+    }
+
+    this->adaptiveSkip = adaptive;
+    this->targetRate = targetRate;
+    this->targetDepth = targetDepth;
+}
+
 int Companion::Configuration::ImageBuffer() const
 {
     return this->imageBuffer;
@@ -133,9 +315,74 @@ void Companion::Configuration::ImageBuffer(int imageBuffer)
     this->imageBuffer = imageBuffer;
 }
 
+int Companion::Configuration::ConsumerThreads() const
+{
+    return this->consumerThreads;
+}
+
+void Companion::Configuration::ConsumerThreads(int consumerThreads)
+{
+
+    if (consumerThreads <= 0)
+    {
+        consumerThreads = 1;
+    }
+
+    this->consumerThreads = consumerThreads;
+}
+
+bool Companion::Configuration::Pipeline() const
+{
+    return this->pipeline;
+}
+
+void Companion::Configuration::Pipeline(bool pipeline)
+{
+    this->pipeline = pipeline;
+}
+
+Companion::BackpressurePolicy Companion::Configuration::Backpressure() const
+{
+    return this->backpressure;
+}
+
+void Companion::Configuration::Backpressure(BackpressurePolicy policy)
+{
+    this->backpressure = policy;
+}
+
+std::chrono::milliseconds Companion::Configuration::Deadline() const
+{
+    return this->deadline;
+}
+
+void Companion::Configuration::Deadline(std::chrono::milliseconds deadline)
+{
+
+    if (deadline.count() <= 0)
+    {
+        deadline = std::chrono::milliseconds(0);
+    }
+
+    this->deadline = deadline;
+}
+
+PTR_STREAM_METRICS Companion::Configuration::Metrics() const
+{
+    return this->metrics;
+}
+
 void Companion::Configuration::ResultCallback(std::function<SUCCESS_CALLBACK> callback, Companion::ColorFormat colorFormat)
 {
     this->callback = callback;
+    this->streamCallback = nullptr;
+    this->colorFormat = colorFormat;
+}
+
+void Companion::Configuration::StreamResultCallback(std::function<STREAM_SUCCESS_CALLBACK> callback, Companion::ColorFormat colorFormat)
+{
+    this->streamCallback = callback;
+    this->callback = nullptr;
     this->colorFormat = colorFormat;
 }
 
@@ -165,3 +412,8 @@ const std::function<ERROR_CALLBACK> &Companion::Configuration::ErrorCallback() c
 
     return this->errorCallback;
 }
+
+void Companion::Configuration::StatsCallback(std::function<STATS_CALLBACK> callback)
+{
+    this->statsCallback = callback;
+}
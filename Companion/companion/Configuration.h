@@ -19,11 +19,17 @@
 #ifndef COMPANION_CONFIGURATION_H
 #define COMPANION_CONFIGURATION_H
 
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <future>
+#include <mutex>
 #include <thread>
+#include <vector>
 #include <companion/thread/StreamWorker.h>
 #include <companion/input/Stream.h>
 #include <companion/processing/ImageProcessing.h>
+#include <companion/model/stream/StreamMetrics.h>
 #include <companion/util/Definitions.h>
 
 namespace Companion
@@ -45,34 +51,81 @@ namespace Companion
 		Configuration();
 
 		/**
-		 * Default destructor.
+		 * Destructor, aborts a running stream and waits for its threads. Must not be called from a callback.
 		 */
-		virtual ~Configuration() = default;
+		virtual ~Configuration();
 
 		/**
-		 * Execute companion configuration.
+		 * Execute companion configuration and wait until the stream is finished. If the configuration is running
+		 * already it is stopped instead.
 		 * @throws error Companion::Error::Code error code if an invalid configuration is set.
 		 */
 		void Run();
 
 		/**
-		 * Stop current running stream worker if it's executes.
+		 * Execute companion configuration without waiting for the stream. Several configurations can run
+		 * concurrently in one process, their image processing shares the task pool of the process. Each
+		 * configuration still runs its own producer and consumer threads, but at most as many consumers of all
+		 * configurations as the task pool has workers process frames at once.
+		 * @throws error Companion::Error::Code error code if an invalid configuration is set.
+		 * @return Handle which is ready once the stream is finished and all results are delivered. If the
+		 * configuration is running already the handle of the running stream is returned.
+		 */
+		std::shared_future<void> RunAsync();
+
+		/**
+		 * Stop current running stream worker without waiting for it. Can be called from any thread and from callbacks.
+		 * @param mode Stop mode, StopMode::DRAIN delivers the results of all buffered frames, StopMode::ABORT
+		 * discards them.
+		 * @return Handle which is ready once all threads of the stream are finished.
+		 */
+		std::shared_future<void> StopAsync(StopMode mode = StopMode::DRAIN);
+
+		/**
+		 * Stop current running stream worker and wait for its threads. Must not be called from a callback, use
+		 * StopAsync instead.
+		 * @param mode Stop mode, StopMode::DRAIN delivers the results of all buffered frames, StopMode::ABORT
+		 * discards them.
+		 * @param timeout Maximum time to wait. A stream which is blocked in reading a frame stops after the read.
+		 * @return <code>True</code> if the stream is stopped, <code>false</code> if the timeout expired.
 		 */
-		void Stop();
+		bool Stop(StopMode mode = StopMode::DRAIN, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000));
+
+		/**
+		 * Check if a stream is running.
+		 * @return <code>True</code> if threads of a stream are running.
+		 */
+		bool IsRunning() const;
 
 		/**
 		 * Obtain streaming source pointer if set.
 		 * @throws Companion::Error::Code Companion error code if video source is not set.
-		 * @return Streaming source to obtain images.
+		 * @return Streaming source to obtain images, the first source if several sources are set.
 		 */
 		PTR_STREAM Source() const;
 
 		/**
-		 * Set streaming source to companion.
+		 * Set streaming source to companion, replaces all sources which are set.
 		 * @param source Video source to set like an camera or video.
 		 */
 		void Source(PTR_STREAM source);
 
+		/**
+		 * Add a further streaming source. All sources are served by the same consumers and image processing, each
+		 * stream keeps its own recognition state and its results are tagged with its stream ID.
+		 * @param source Video source to add like an camera or video.
+		 * @param weight Scheduling weight of the source, consumers obtain frames from sources in proportion to their
+		 * weights if all of them have buffered frames. If weight <= 0 a weight of 1 is used.
+		 * @return Stream ID of the source which is passed to the stream result callback.
+		 */
+		int AddSource(PTR_STREAM source, int weight = 1);
+
+		/**
+		 * Get all streaming sources, the index of a source is its stream ID.
+		 * @return All streaming sources.
+		 */
+		const std::vector<PTR_STREAM>& Sources() const;
+
 		/**
 		 * Get current processing algorithm which should be used.
 		 * @throws Companion::Error::Code Companion error code if image processing is not set.
@@ -98,6 +151,24 @@ namespace Companion
 		 */
 		void SkipFrame(int skipFrame);
 
+		/**
+		 * Check if the skip frame rate adapts to the processing load.
+		 * @return <code>True</code> if adaptive skipping is used. Default is false.
+		 */
+		bool AdaptiveSkipFrame() const;
+
+		/**
+		 * Adapt the skip frame rate continuously to the processing load instead of using a fixed skip frame rate. The
+		 * stream worker measures the processing time of the consumers and the number of buffered frames and skips as
+		 * many frames as needed to hold the target output rate and the target number of buffered frames. The skip frame
+		 * rate is the minimum skip frame rate, the current skip frame rate is reported by the metrics.
+		 * @param adaptive <code>True</code> to adapt the skip frame rate.
+		 * @param targetRate Target output rate in frames per second. If targetRate <= 0 as many frames are processed as
+		 * the consumers can handle.
+		 * @param targetDepth Target number of buffered frames, low values keep the latency low.
+		 */
+		void AdaptiveSkipFrame(bool adaptive, double targetRate = 0, int targetDepth = 1);
+
 		/**
 		 * Get image buffer store rate.
 		 * @return Image buffer frame rate default 5 images are stored to buffer.
@@ -110,6 +181,68 @@ namespace Companion
 		 */
 		void ImageBuffer(int imageBuffer);
 
+		/**
+		 * Get number of consumer threads which process frames concurrently.
+		 * @return Number of consumer threads, default is one thread.
+		 */
+		int ConsumerThreads() const;
+
+		/**
+		 * Set number of consumer threads which process frames concurrently. Results are still delivered in frame order.
+		 * The image buffer should be at least as large as the number of consumers to keep all consumers busy.
+		 * @param consumerThreads Number of consumer threads. If consumerThreads <= 0 one consumer thread is used.
+		 */
+		void ConsumerThreads(int consumerThreads);
+
+		/**
+		 * Check if image processing stages are pipelined.
+		 * @return <code>True</code> if each stage runs in its own thread, <code>false</code> otherwise. Default is false.
+		 */
+		bool Pipeline() const;
+
+		/**
+		 * Enable pipelined image processing. Each stage of the image processing runs in its own thread and different
+		 * frames occupy different stages concurrently, so throughput approaches the slowest stage instead of the sum of
+		 * all stages. If pipelining is used the number of consumer threads is ignored.
+		 * @param pipeline <code>True</code> to run each stage in its own thread.
+		 */
+		void Pipeline(bool pipeline);
+
+		/**
+		 * Get backpressure policy which is applied if the image buffer is full.
+		 * @return Backpressure policy, default is BackpressurePolicy::BLOCK.
+		 */
+		BackpressurePolicy Backpressure() const;
+
+		/**
+		 * Set backpressure policy which is applied if the image buffer is full.
+		 * @param policy Backpressure policy, use BackpressurePolicy::KEEP_LATEST for live cameras where freshness
+		 * matters more than completeness.
+		 */
+		void Backpressure(BackpressurePolicy policy);
+
+		/**
+		 * Get latency deadline of each frame.
+		 * @return Latency deadline relative to the capture time of a frame, zero if no deadline is set. Default is zero.
+		 */
+		std::chrono::milliseconds Deadline() const;
+
+		/**
+		 * Set latency deadline of each frame for live video where late results are useless. Frames whose deadline has
+		 * passed before processing starts are dropped, image processings which support deadlines like
+		 * MatchRecognition stop evaluating objects once the deadline is hit and return results marked as partial.
+		 * @param deadline Latency deadline relative to the capture time of a frame. If deadline <= 0 no deadline is used.
+		 */
+		void Deadline(std::chrono::milliseconds deadline);
+
+		/**
+		 * Get stream metrics like the number of produced, consumed and dropped frames, the time the producer was blocked,
+		 * the consumer idle time, the buffer occupancy and the end-to-end latency of the frames. The metrics can be read
+		 * lock-free from another thread while the stream is running.
+		 * @return Stream metrics which are accumulated over all runs.
+		 */
+		PTR_STREAM_METRICS Metrics() const;
+
 		/**
 		 * Set a result callback handler.
 		 * The source image will be converted to the given format.
@@ -125,6 +258,14 @@ namespace Companion
 		 */
 		const std::function<SUCCESS_CALLBACK>& ResultCallback() const;
 
+		/**
+		 * Set a result callback handler which obtains the stream ID of the results, replaces the result callback.
+		 * The source image will be converted to the given format.
+		 * @param callback Function pointer which contains result event handler.
+		 * @param colorFormat Color format of the returned image.
+		 */
+		void StreamResultCallback(std::function<STREAM_SUCCESS_CALLBACK> callback, Companion::ColorFormat colorFormat = Companion::ColorFormat::BGR);
+
 		/**
 		 * Set an error callback handler.
 		 * @param callback Error handler to set.
@@ -138,6 +279,14 @@ namespace Companion
 		 */
 		const std::function<ERROR_CALLBACK>& ErrorCallback() const;
 
+		/**
+		 * Set a stats callback handler to obtain the processing times of each frame, split by steps like keypoint
+		 * detection, descriptor matching or homography estimation and by models. Stats are delivered in frame order
+		 * right before the results of their frame. Processing times are only recorded if a stats callback is set.
+		 * @param callback Stats handler to set, nullptr to record no stats.
+		 */
+		void StatsCallback(std::function<STATS_CALLBACK> callback);
+
 	private:
 
 		/**
@@ -145,15 +294,30 @@ namespace Companion
 		 */
 		std::function<SUCCESS_CALLBACK> callback;
 
+		/**
+		 * Callback event handler to send results together with their stream ID back to main application.
+		 */
+		std::function<STREAM_SUCCESS_CALLBACK> streamCallback;
+
 		/**
 		 * Callback for an error.
 		 */
 		std::function<ERROR_CALLBACK> errorCallback;
 
 		/**
-		 * Data stream source to obtain images.
+		 * Callback for the processing times of each frame.
 		 */
-		PTR_STREAM source;
+		std::function<STATS_CALLBACK> statsCallback;
+
+		/**
+		 * Data stream sources to obtain images, the index of a source is its stream ID.
+		 */
+		std::vector<PTR_STREAM> sources;
+
+		/**
+		 * Scheduling weight of each source.
+		 */
+		std::vector<int> weights;
 
 		/**
 		 * Image processing implementation, for example an object detection or recognition.
@@ -165,30 +329,80 @@ namespace Companion
 		 */
 		PTR_STREAM_WORKER worker;
 
+		/**
+		 * Streaming sources of the running job.
+		 */
+		std::vector<PTR_STREAM> streams;
+
 		/**
 		 * Number of frames to skip to process next image.
 		 */
 		int skipFrame;
 
+		/**
+		 * Indicator if the skip frame rate adapts to the processing load.
+		 */
+		bool adaptiveSkip;
+
+		/**
+		 * Target output rate of adaptive skipping in frames per second, 0 if not set.
+		 */
+		double targetRate;
+
+		/**
+		 * Target number of buffered frames of adaptive skipping.
+		 */
+		int targetDepth;
+
 		/**
 		 * Image buffer size to store image. Default is 5.
 		 */
 		int imageBuffer;
 
+		/**
+		 * Number of consumer threads which process frames concurrently. Default is 1.
+		 */
+		int consumerThreads;
+
+		/**
+		 * Indicator if image processing stages are pipelined.
+		 */
+		bool pipeline;
+
+		/**
+		 * Backpressure policy if the image buffer is full.
+		 */
+		BackpressurePolicy backpressure;
+
+		/**
+		 * Latency deadline of each frame, zero if no deadline is set.
+		 */
+		std::chrono::milliseconds deadline;
+
+		/**
+		 * Stream metrics of all runs.
+		 */
+		PTR_STREAM_METRICS metrics;
+
 		/**
 		 * Indicator if threads are currently running.
 		 */
-		bool threadsRunning;
+		std::atomic<bool> threadsRunning;
+
+		/**
+		 * Thread which runs the producer and consumer threads of a job and waits for them.
+		 */
+		std::thread runner;
 
 		/**
-		 * Consumer thread to store image data.
+		 * Handle of the current or last job.
 		 */
-		std::thread consumer;
+		std::shared_future<void> running;
 
 		/**
-		 * Producer thread to image processing given image data.
+		 * Mutex to guard starting and stopping of jobs.
 		 */
-		std::thread producer;
+		std::mutex runMx;
 
 		/**
 		 * Color format of the image in the result callback.
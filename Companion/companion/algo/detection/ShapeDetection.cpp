@@ -39,29 +39,36 @@ Companion::Algorithm::Detection::ShapeDetection::ShapeDetection(
 }
 
 std::vector<PTR_DRAW_FRAME> Companion::Algorithm::Detection::ShapeDetection::ExecuteAlgorithm(cv::Mat frame)
+{
+	cv::Mat buffer;
+	return ExecuteAlgorithm(frame, buffer);
+}
+
+std::vector<PTR_DRAW_FRAME> Companion::Algorithm::Detection::ShapeDetection::ExecuteAlgorithm(cv::Mat frame, cv::Mat& buffer)
 {
 	std::vector<PTR_DRAW_FRAME> rois;
 	std::vector<std::vector<cv::Point> > contours;
 	std::vector<cv::Vec4i> hierarchy;
 	std::vector<cv::Point> approx;
 	int minDistance = frame.size().width / 4.0f;
+	Companion::Thread::StageTimer timer(TimingStage::ROI_DETECTION);
 
 	if (frame.empty())
 	{
 		throw Companion::Error::Code::image_not_found;
 	}
 
-	cvtColor(frame, frame, cv::COLOR_BGR2GRAY);
-	cv::Canny(frame, frame, this->cannyThreshold, this->cannyThreshold * 3.0, 3);
+	cvtColor(frame, buffer, cv::COLOR_BGR2GRAY);
+	cv::Canny(buffer, buffer, this->cannyThreshold, this->cannyThreshold * 3.0, 3);
 
 	// Morphological Transformations - http://docs.opencv.org/trunk/d9/d61/tutorial_py_morphological_ops.html
-	morphologyEx(frame, frame, CV_MOP_CLOSE, this->morphKernel);
-	erode(frame, frame, this->erodeKernel);
-	dilate(frame, frame, this->dilateKernel, cv::Point(-1, -1), this->dilateIteration);
+	morphologyEx(buffer, buffer, CV_MOP_CLOSE, this->morphKernel);
+	erode(buffer, buffer, this->erodeKernel);
+	dilate(buffer, buffer, this->dilateKernel, cv::Point(-1, -1), this->dilateIteration);
 
 	// Contour Retrieval Mode - http://docs.opencv.org/3.1.0/d9/d8b/tutorial_py_contours_hierarchy.html
 	// CV_RETR_EXTERNAL, CV_RETR_LIST, CV_RETR_CCOMP, CV_RETR_TREE
-	findContours(frame, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE, cv::Point(0, 0));
+	findContours(buffer, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE, cv::Point(0, 0));
 
 	for (size_t i = 0; i < contours.size(); i++)
 	{
@@ -21,6 +21,7 @@
 
 #include <opencv2/imgproc.hpp>
 #include <companion/algo/detection/Detection.h>
+#include <companion/thread/StageTimer.h>
 #include <companion/util/CompanionError.h>
 
 namespace Companion {
@@ -69,6 +70,15 @@ namespace Companion {
 				 */
 				std::vector<PTR_DRAW_FRAME> ExecuteAlgorithm(cv::Mat frame);
 
+				/**
+				 * Shape detection algorithm to obtain possible regions of interest (ROI) with a reusable edge image.
+				 * @param frame Image frame to obtain all roi objects from.
+				 * @param buffer Buffer for the edge image, its memory is reused if images of the same size are processed.
+				 * @throws Companion::Error::Code If an error occurred in search operation.
+				 * @return A vector of frames that represent the detected shapes.
+				 */
+				std::vector<PTR_DRAW_FRAME> ExecuteAlgorithm(cv::Mat frame, cv::Mat& buffer);
+
 				/**
 				 * Indicator if this algorithm uses cuda.
 				 * @return True if cuda will be used otherwise false for CPU/OpenCL usage.
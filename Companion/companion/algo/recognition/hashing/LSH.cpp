@@ -23,10 +23,12 @@ PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Hashing::LSH::ExecuteA
 	PTR_DRAW_FRAME roi)
 {
 	PTR_RESULT_RECOGNITION result = nullptr;
-	std::vector<std::pair<int, float>> scores = model->Scores();
-	std::pair<cv::Mat_<float>, cv::Mat> dataset = model->GenerateDataset();
-	cv::Mat_<float> hashImages = dataset.first;
-	cv::Mat datasetImages = dataset.second;
+	Companion::Thread::StageTimer timer(TimingStage::LSH);
+	// Dataset is generated once after models were added, frames only read it
+	PTR_IMAGE_HASH_DATASET dataset = model->GenerateDataset();
+	std::vector<std::pair<int, float>> scores = dataset->scores;
+	const cv::Mat_<float>& hashImages = dataset->hash;
+	const cv::Mat& datasetImages = dataset->index;
 
 	query.reshape(1, 1).convertTo(query, CV_32F);
 	query = query * hashImages;
@@ -20,6 +20,7 @@
 #define COMPANION_LSH_H
 
 #include "Hashing.h"
+#include <companion/thread/StageTimer.h>
 
 namespace Companion {
 	namespace Algorithm {
@@ -18,6 +18,91 @@
 
 #include "FeatureMatching.h"
 
+/**
+ * Per-thread buffers of the feature matching, they grow to the largest frame and are reused for every model and frame
+ * instead of allocating new lists. Each buffer is used by one method only, so methods calling each other never share
+ * a buffer, and no buffer is used anymore when the algorithm repeats itself without IRA or ROI.
+ */
+struct FeatureMatchingBuffer
+{
+	/**
+	 * K nearest neighbor matches of all features.
+	 */
+	std::vector<std::vector<cv::DMatch>> matches;
+
+	/**
+	 * Matches which passed the ratio test.
+	 */
+	std::vector<cv::DMatch> goodMatches;
+
+	/**
+	 * Object descriptors converted for flann based matching.
+	 */
+	cv::Mat descriptorsObject;
+
+	/**
+	 * Best scene match of each object feature in the symmetric ratio test.
+	 */
+	std::vector<cv::DMatch> best;
+
+	/**
+	 * Second best scene distance of each object feature in the symmetric ratio test.
+	 */
+	std::vector<float> secondBest;
+
+	/**
+	 * Object points of the good matches.
+	 */
+	std::vector<cv::Point2f> featurePointsObject;
+
+	/**
+	 * Scene points of the good matches.
+	 */
+	std::vector<cv::Point2f> featurePointsScene;
+
+	/**
+	 * Inlier mask of the homography.
+	 */
+	std::vector<uchar> inlierMask;
+
+	/**
+	 * Object points of the homography inliers.
+	 */
+	std::vector<cv::Point2f> inliersObject;
+
+	/**
+	 * Scene points of the homography inliers.
+	 */
+	std::vector<cv::Point2f> inliersScene;
+
+	/**
+	 * Inlier mask of the refined homography.
+	 */
+	std::vector<uchar> refinedMask;
+
+	/**
+	 * Object points of the inliers to refine the homography.
+	 */
+	std::vector<cv::Point2f> refineObject;
+
+	/**
+	 * Scene points of the inliers to refine the homography.
+	 */
+	std::vector<cv::Point2f> refineScene;
+
+	/**
+	 * Object points projected by a homography hypothesis.
+	 */
+	std::vector<cv::Point2f> projected;
+
+	/**
+	 * Scene features of the IRA search window or the ROI, reused by every search of this thread.
+	 */
+	std::shared_ptr<SCENE_FEATURES> subset = std::make_shared<SCENE_FEATURES>();
+};
+
+static thread_local FeatureMatchingBuffer featureMatchingBuffer;
+
 Companion::Algorithm::Recognition::Matching::FeatureMatching::FeatureMatching(
 	cv::Ptr<cv::FeatureDetector> detector,
 	cv::Ptr<cv::DescriptorExtractor> extractor,
@@ -41,6 +126,14 @@ Companion::Algorithm::Recognition::Matching::FeatureMatching::FeatureMatching(
 	this->reprojThreshold = reprojThreshold;
 	this->ransacMaxIters = ransacMaxIters;
 	this->findHomographyMethod = findHomographyMethod;
+	this->homographyHits = 0;
+	this->homographyMisses = 0;
+
+	if (matcherType == HammingMatcher::BRUTEFORCE_HAMMING_SIMD && dynamic_cast<HammingMatcher*>(matcher.get()) == nullptr)
+	{
+		// Use the native SIMD hamming matcher for binary descriptors
+		this->matcher = HammingMatcher::create();
+	}
 }
 
 #if Companion_USE_CUDA
@@ -61,6 +154,8 @@ Companion::Algorithm::Recognition::Matching::FeatureMatching::FeatureMatching(
 	this->reprojThreshold = reprojThreshold;
 	this->ransacMaxIters = ransacMaxIters;
 	this->findHomographyMethod = findHomographyMethod;
+	this->homographyHits = 0;
+	this->homographyMisses = 0;
 }
 #endif
 
@@ -79,6 +174,8 @@ Companion::Algorithm::Recognition::Matching::FeatureMatching::FeatureMatching(cv
 	this->reprojThreshold = reprojThreshold;
 	this->ransacMaxIters = ransacMaxIters;
 	this->findHomographyMethod = findHomographyMethod;
+	this->homographyHits = 0;
+	this->homographyMisses = 0;
 }
 #endif
 
@@ -90,21 +187,18 @@ PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Matching::FeatureMatch
 
 	// Set of variables for feature matching
 	cv::Mat sceneImage, objectImage;
-	std::vector<std::vector<cv::DMatch>> matches;
-	std::vector<cv::DMatch> goodMatches;
-	std::vector<cv::KeyPoint> keypointsScene, keypointsObject;
-	cv::Mat descriptorsScene, descriptorsObject;
+	std::vector<std::vector<cv::DMatch>>& matches = featureMatchingBuffer.matches;
+	std::vector<cv::DMatch>& goodMatches = featureMatchingBuffer.goodMatches;
+	cv::Mat descriptorsObject;
+	PTR_SCENE_FEATURES sceneFeatures = nullptr;
 	PTR_RESULT_RECOGNITION result = nullptr;
 	PTR_DRAW drawable = nullptr;
 	bool isIRAUsed = false;
 	bool isROIUsed = false;
 	PTR_IMAGE_REDUCTION_ALGORITHM ira;
 
-	// Clear all lists from last run
-	matches.clear();
+	// Clear all lists from last run, the match lists are overwritten by the matcher and keep their memory
 	goodMatches.clear();
-	keypointsScene.clear();
-	keypointsObject.clear();
 
 	sceneImage = sceneModel->Image(); // Get image scene
 	objectImage = objectModel->Image(); // Get object scene
@@ -116,63 +210,61 @@ PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Matching::FeatureMatch
 		throw Companion::Error::Code::image_not_found;
 	}
 
-	cvtColor(sceneImage, sceneImage, CV_BGR2GRAY); // Convert image to grayscale
-
 	// --------------------------------------------------
 	// Scene and model preparation start
 	// --------------------------------------------------
 
-	// ------ IRA scene handling. Currently works only for CPU usage ------
-	if (this->useIRA && ira->IsObjectRecognized()) // IRA USED & OBJECT RECOGNIZED
+	if (!this->cudaUsed)
 	{
-		// Cut out scene from last recognized object and set this as new scene to check
-		sceneImage = cv::Mat(sceneImage, ira->LastObjectPosition());
+		// Use the scene features which are shared by all models of this frame and only calculate them if they are not cached
+		sceneFeatures = sceneModel->Features();
+		if (sceneFeatures == nullptr)
+		{
+			sceneFeatures = std::make_shared<SCENE_FEATURES>(sceneImage, this->detector, this->extractor, this->matcherType);
+		}
 
-		// Detect keypoints from cut scene
-		this->detector->detect(sceneImage, keypointsScene);
-		// Calculate descriptors from cut scene (feature vectors)
-		this->extractor->compute(sceneImage, keypointsScene, descriptorsScene);
+		sceneImage = sceneFeatures->Image(); // Grayscale scene
 
-		isIRAUsed = true;
-	}
-	else if (this->useIRA && roi != nullptr) // IRA USED & OBJECT NOT RECOGNIZED & ROI EXISTS
-	{
-		// Get ROI position
-		cv::Rect roiObject(roi->TopLeft(), roi->BottomRight());
+		// ------ IRA scene handling. Currently works only for CPU usage ------
+		if (this->useIRA && ira->IsObjectRecognized()) // IRA USED & OBJECT RECOGNIZED
+		{
+			if (ira->Ring() == 0)
+			{
+				// New search in this frame, the object position is predicted from its motion once per frame
+				ira->Predict(sceneImage.size(), sceneModel);
+			}
 
-		// Cut out scene from last recognized object and set this as new scene to check
-		sceneImage = cv::Mat(sceneImage, roiObject);
+			// Obtain keypoints and descriptors of the predicted search window from the full scene features
+			sceneFeatures->Subset(ira->SearchWindow(), *featureMatchingBuffer.subset);
+			sceneFeatures = featureMatchingBuffer.subset;
+			sceneImage = sceneFeatures->Image();
 
-		// Detect keypoints from cut scene
-		this->detector->detect(sceneImage, keypointsScene);
-		// Calculate descriptors from cut scene (feature vectors)
-		this->extractor->compute(sceneImage, keypointsScene, descriptorsScene);
+			isIRAUsed = true;
+		}
+		else if (this->useIRA && roi != nullptr) // IRA USED & OBJECT NOT RECOGNIZED & ROI EXISTS
+		{
+			// Get ROI position
+			cv::Rect roiObject(roi->TopLeft(), roi->BottomRight());
 
-		isROIUsed = true;
-	}
-	else if (this->useIRA && sceneModel->KeypointsCalculated()) // IRA USED & OBJECT NOT RECOGNIZED & SCENE KEYPOINTS CALCULATED
-	{
-		keypointsScene = sceneModel->Keypoints();
-		descriptorsScene = sceneModel->Descriptors();
-	}
-	else if (!this->cudaUsed) // IRA NOT USED & OBJECT NOT RECOGNIZED & SCENE KEYPOINTS NOT CALCULATED & NOT CUDA USAGE
-	{
-		// Detect keypoints
-		this->detector->detect(sceneImage, keypointsScene);
-		// Calculate descriptors
-		this->extractor->compute(sceneImage, keypointsScene, descriptorsScene);
-	}
+			// Obtain keypoints and descriptors of the ROI from the full scene features
+			sceneFeatures->Subset(roiObject, *featureMatchingBuffer.subset);
+			sceneFeatures = featureMatchingBuffer.subset;
+			sceneImage = sceneFeatures->Image();
 
-	// Check if object has calculated keypoints and descriptors and CUDA is not used
-	if (!objectModel->KeypointsCalculated() && !this->cudaUsed)
+			isROIUsed = true;
+		}
+
+		// Check if object has calculated keypoints and descriptors
+		if (!objectModel->KeypointsCalculated())
+		{
+			objectModel->CalculateKeyPointsAndDescriptors(this->detector, this->extractor); // Calculate keypoints from model
+		}
+	}
+	else
 	{
-		objectModel->CalculateKeyPointsAndDescriptors(this->detector, this->extractor); // Calculate keypoints from model
+		cvtColor(sceneImage, sceneImage, CV_BGR2GRAY); // Convert image to grayscale
 	}
 
-	// Get keypoints and descriptors from model
-	keypointsObject = objectModel->Keypoints();
-	descriptorsObject = objectModel->Descriptors();
-
 	// --------------------------------------------------
 	// Scene and model preparation end
 	// --------------------------------------------------
@@ -181,27 +273,63 @@ PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Matching::FeatureMatch
 	// Feature matching algorithm
 	// --------------------------------------------------
 	// If object and scene descriptor and keypoints exists..
-	if (!this->cudaUsed && !descriptorsObject.empty() && !descriptorsScene.empty() && !keypointsObject.empty() && !keypointsScene.empty())
+	if (!this->cudaUsed && !objectModel->Descriptors().empty() && !sceneFeatures->Descriptors().empty())
 	{
-		// If matching type is flan based, scene and object must be in CV_32F format
-		if (matcherType == cv::DescriptorMatcher::FLANNBASED)
+		const std::vector<cv::KeyPoint>& keypointsScene = sceneFeatures->Keypoints();
+		const cv::Mat& descriptorsScene = sceneFeatures->Descriptors();
+
+		if (this->useModelIndex && objectModel->Matcher() != nullptr)
 		{
-			descriptorsScene.convertTo(descriptorsScene, CV_32F);
-			descriptorsObject.convertTo(descriptorsObject, CV_32F);
+			// ------ CPU USAGE ------
+			// Scene descriptors are the queries for the persistent index of the model
+			Companion::Thread::StageTimer matchTimer(TimingStage::KNN_MATCH, objectModel->ID());
+			HammingMatcher* hammingMatcher = dynamic_cast<HammingMatcher*>(objectModel->Matcher().get());
+			if (hammingMatcher != nullptr)
+			{
+				// Reuse the match lists of the last model instead of allocating one list per scene feature
+				hammingMatcher->KnnMatchInto(descriptorsScene, matches, DEFAULT_NEIGHBOR);
+			}
+			else
+			{
+				objectModel->Matcher()->knnMatch(descriptorsScene, matches, DEFAULT_NEIGHBOR);
+			}
+			matchTimer.Stop();
+
+			// Ratio test in both directions, approximates the object to scene ratio test from the scene to object matches
+			Companion::Thread::StageTimer ratioTimer(TimingStage::RATIO_TEST, objectModel->ID());
+			SymmetricRatioTest(matches, goodMatches, DEFAULT_RATIO_VALUE, objectModel->Keypoints().size());
+			ratioTimer.Stop();
 		}
+		else
+		{
+			// Models without an index (e.g. added before the model index was enabled) are matched against the scene,
+			// the index is never trained here because the model is shared by concurrent frames and streams
+			descriptorsObject = objectModel->Descriptors();
 
-		// ------ CPU USAGE ------
-		// matching descriptor vectors
-		matcher->knnMatch(descriptorsObject, descriptorsScene, matches, DEFAULT_NEIGHBOR);
+			// If matching type is flan based, object must be in CV_32F format (scene features are already converted)
+			if (matcherType == cv::DescriptorMatcher::FLANNBASED && descriptorsObject.type() != CV_32F)
+			{
+				descriptorsObject.convertTo(featureMatchingBuffer.descriptorsObject, CV_32F);
+				descriptorsObject = featureMatchingBuffer.descriptorsObject;
+			}
 
-		// Ratio test for good matches - http://www.cs.ubc.ca/~lowe/papers/ijcv04.pdf#page=20
-		// Neighbourhoods comparison
-		RatioTest(matches, goodMatches, DEFAULT_RATIO_VALUE);
+			// ------ CPU USAGE ------
+			// matching descriptor vectors
+			Companion::Thread::StageTimer matchTimer(TimingStage::KNN_MATCH, objectModel->ID());
+			matcher->knnMatch(descriptorsObject, descriptorsScene, matches, DEFAULT_NEIGHBOR);
+			matchTimer.Stop();
+
+			// Ratio test for good matches - http://www.cs.ubc.ca/~lowe/papers/ijcv04.pdf#page=20
+			// Neighbourhoods comparison
+			Companion::Thread::StageTimer ratioTimer(TimingStage::RATIO_TEST, objectModel->ID());
+			RatioTest(matches, goodMatches, DEFAULT_RATIO_VALUE);
+			ratioTimer.Stop();
+		}
 
 		drawable = ObtainMatchingResult(sceneImage,
 			objectImage,
 			goodMatches,
-			keypointsObject,
+			objectModel->Keypoints(),
 			keypointsScene,
 			sceneModel,
 			objectModel,
@@ -222,6 +350,7 @@ PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Matching::FeatureMatch
 		cv::cuda::GpuMat gpu_object(objectImage); // Load object as an gpu mat
 		cv::cuda::GpuMat gpu_descriptors_scene, gpu_descriptors_object;
 		cv::Ptr<cv::cuda::DescriptorMatcher> gpu_matcher;
+		std::vector<cv::KeyPoint> keypointsScene, keypointsObject;
 
 		if (cudaFeatureMatching != nullptr)
 		{
@@ -266,7 +395,7 @@ PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Matching::FeatureMatch
 		// If results are not good enough and empty for keypoints and descriptors
 		sceneImage.release();
 		objectImage.release();
-		RepeatAlgorithm(sceneModel, objectModel, roi, isIRAUsed, ira, isROIUsed);
+		return RepeatAlgorithm(sceneModel, objectModel, roi, isIRAUsed, ira, isROIUsed);
 	}
 
 	if (drawable != nullptr)
@@ -283,7 +412,7 @@ PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Matching::FeatureMatch
 		// No results and IRA or ROI was used
 		sceneImage.release();
 		objectImage.release();
-		RepeatAlgorithm(sceneModel, objectModel, roi, isIRAUsed, ira, isROIUsed);
+		result = RepeatAlgorithm(sceneModel, objectModel, roi, isIRAUsed, ira, isROIUsed);
 	}
 
 	return result;
@@ -302,6 +431,96 @@ void Companion::Algorithm::Recognition::Matching::FeatureMatching::CalculateKeyP
 	}
 }
 
+void Companion::Algorithm::Recognition::Matching::FeatureMatching::CalculateSceneFeatures(PTR_MODEL_FEATURE_MATCHING sceneModel)
+{
+	if (!IsCuda())
+	{
+		sceneModel->Features(std::make_shared<SCENE_FEATURES>(sceneModel->Image(),
+			this->detector,
+			this->extractor,
+			this->matcherType));
+	}
+}
+
+void Companion::Algorithm::Recognition::Matching::FeatureMatching::TrainModel(PTR_MODEL_FEATURE_MATCHING model)
+{
+	cv::Mat descriptors;
+	cv::Ptr<cv::DescriptorMatcher> index;
+
+	if (IsCuda())
+	{
+		return;
+	}
+
+	if (!model->KeypointsCalculated())
+	{
+		model->CalculateKeyPointsAndDescriptors(this->detector, this->extractor);
+	}
+
+	// Convert descriptors only once if matching type is flann based
+	descriptors = model->Descriptors();
+	if (this->matcherType == cv::DescriptorMatcher::FLANNBASED && !descriptors.empty() && descriptors.type() != CV_32F)
+	{
+		descriptors.convertTo(descriptors, CV_32F);
+		model->Descriptors(descriptors);
+	}
+
+	if (this->useModelIndex && !descriptors.empty())
+	{
+		// Create an empty matcher with the same configuration and train it only with the model descriptors
+		index = this->matcher->clone(true);
+		index->add(std::vector<cv::Mat>(1, descriptors));
+		index->train();
+		model->Matcher(index);
+	}
+}
+
+PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Matching::FeatureMatching::VerifyCandidate(
+	PTR_MODEL_FEATURE_MATCHING sceneModel,
+	PTR_MODEL_FEATURE_MATCHING objectModel,
+	std::vector<cv::DMatch>& goodMatches)
+{
+	PTR_SCENE_FEATURES sceneFeatures = sceneModel->Features();
+	PTR_DRAW drawable = nullptr;
+	cv::Mat sceneImage, objectImage;
+
+	if (this->cudaUsed || sceneFeatures == nullptr)
+	{
+		// Candidate verification works only with cached cpu scene features
+		return nullptr;
+	}
+
+	sceneImage = sceneFeatures->Image();
+	objectImage = objectModel->Image();
+
+	if (!Util::IsImageLoaded(sceneImage) || !Util::IsImageLoaded(objectImage))
+	{
+		throw Companion::Error::Code::image_not_found;
+	}
+
+	// Keep only the best matches like the ratio test does
+	MatchFilter::SelectBest(goodMatches, this->countMatches);
+
+	drawable = ObtainMatchingResult(sceneImage,
+		objectImage,
+		goodMatches,
+		objectModel->Keypoints(),
+		sceneFeatures->Keypoints(),
+		sceneModel,
+		objectModel,
+		false,
+		false,
+		nullptr);
+
+	if (drawable == nullptr)
+	{
+		return nullptr;
+	}
+
+	// TODO := SCORING CALCULATION
+	return std::make_shared<RESULT_RECOGNITION>(100, objectModel->ID(), drawable);
+}
+
 PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Matching::FeatureMatching::RepeatAlgorithm(
 	PTR_MODEL_FEATURE_MATCHING sceneModel,
 	PTR_MODEL_FEATURE_MATCHING objectModel,
@@ -312,6 +531,11 @@ PTR_RESULT_RECOGNITION Companion::Algorithm::Recognition::Matching::FeatureMatch
 {
 	if (isIRAUsed)
 	{
+		if (ira->SearchTime() < this->iraTimeBudget && ira->Expand(sceneModel->Image().size()))
+		{
+			return ExecuteAlgorithm(sceneModel, objectModel, roi); // Repeat algorithm with the next ring around the prediction
+		}
+
 		ira->Clear(); // Clear last recognized object position
 		return ExecuteAlgorithm(sceneModel, objectModel, roi); // Repeat algorithm and full scene or roi
 	}
@@ -327,37 +551,61 @@ void Companion::Algorithm::Recognition::Matching::FeatureMatching::RatioTest(con
 	std::vector<cv::DMatch>& good_matches,
 	float ratio)
 {
-	unsigned long position = 0;
-	bool insertElement;
+	// Ratio test, cross-check and selection of the best matches in one pass
+	MatchFilter::RatioTest(matches, good_matches, ratio, this->countMatches, this->crossCheck);
+}
+
+void Companion::Algorithm::Recognition::Matching::FeatureMatching::SymmetricRatioTest(
+	const std::vector<std::vector<cv::DMatch>>& matches,
+	std::vector<cv::DMatch>& good_matches,
+	float ratio,
+	size_t objectFeatures)
+{
+	const float noMatch = std::numeric_limits<float>::max();
+	std::vector<cv::DMatch>& best = featureMatchingBuffer.best;
+	std::vector<float>& secondBest = featureMatchingBuffer.secondBest;
+	int objectIdx;
+
+	best.assign(objectFeatures, cv::DMatch(-1, -1, noMatch));
+	secondBest.assign(objectFeatures, noMatch);
+
+	// Keep the nearest and second nearest scene feature of each object feature from all neighbours of all scene
+	// features, the nearest one is only a candidate if it also passes the ratio test in scene direction
 	for (size_t i = 0; i < matches.size(); ++i)
 	{
-		if (matches[i].size() >= 2 && (matches[i][0].distance < ratio * matches[i][1].distance))
+		for (size_t k = 0; k < matches[i].size(); ++k)
 		{
-			position = 0;
-			insertElement = false;
-			if (good_matches.empty()) {
-				good_matches.push_back(matches[i][0]);
+			const cv::DMatch& match = matches[i][k];
+			objectIdx = match.trainIdx;
+			if (objectIdx < 0 || static_cast<size_t>(objectIdx) >= objectFeatures)
+			{
+				continue;
 			}
-			else {
-				while (position < good_matches.size() && !insertElement) {
-					if (good_matches.at(position).distance > matches[i][0].distance) {
-						good_matches.insert(good_matches.begin() + position, matches[i][0]);
-						insertElement = true;
-						if (good_matches.size() > this->countMatches) {
-							// Delete last element if maximum is reached
-							good_matches.erase(good_matches.end() - 1);
-						}
-					}
-					position++;
-				}
-				if (!insertElement && good_matches.size() < this->countMatches) {
-					good_matches.push_back(matches[i][0]);
-				}
+
+			if (match.distance < best[objectIdx].distance)
+			{
+				bool distinctive = k == 0 && matches[i].size() >= 2 && match.distance < ratio * matches[i][1].distance;
+				secondBest[objectIdx] = best[objectIdx].distance;
+				best[objectIdx] = cv::DMatch(objectIdx, distinctive ? match.queryIdx : -1, match.distance);
+			}
+			else if (match.distance < secondBest[objectIdx])
+			{
+				secondBest[objectIdx] = match.distance;
 			}
+		}
+	}
 
+	// Ratio test in object direction between competing scene features
+	for (size_t i = 0; i < best.size(); ++i)
+	{
+		if (best[i].trainIdx >= 0 && (secondBest[i] == noMatch || best[i].distance < ratio * secondBest[i]))
+		{
+			good_matches.push_back(best[i]);
 		}
 	}
 
+	// Keep only the best matches sorted by distance like the ratio test does
+	MatchFilter::SelectBest(good_matches, this->countMatches);
 }
 
 void Companion::Algorithm::Recognition::Matching::FeatureMatching::ObtainKeypointsFromGoodMatches(
@@ -389,8 +637,8 @@ PTR_DRAW Companion::Algorithm::Recognition::Matching::FeatureMatching::ObtainMat
 	cv::Mat& sceneImage,
 	cv::Mat& objectImage,
 	std::vector<cv::DMatch>& good_matches,
-	std::vector<cv::KeyPoint>& keypoints_object,
-	std::vector<cv::KeyPoint>& keypoints_scene,
+	const std::vector<cv::KeyPoint>& keypoints_object,
+	const std::vector<cv::KeyPoint>& keypoints_scene,
 	PTR_MODEL_FEATURE_MATCHING sModel,
 	PTR_MODEL_FEATURE_MATCHING cModel,
 	bool isIRAUsed,
@@ -399,11 +647,19 @@ PTR_DRAW Companion::Algorithm::Recognition::Matching::FeatureMatching::ObtainMat
 {
 
 	PTR_DRAW drawable = nullptr;
-	cv::Mat homography;
-	std::vector<cv::Point2f> feature_points_object, feature_points_scene;
+	cv::Mat homography, searchToScene;
+	std::vector<cv::Point2f>& feature_points_object = featureMatchingBuffer.featurePointsObject;
+	std::vector<cv::Point2f>& feature_points_scene = featureMatchingBuffer.featurePointsScene;
+	std::vector<cv::Point2f>& inliers_object = featureMatchingBuffer.inliersObject;
+	std::vector<cv::Point2f>& inliers_scene = featureMatchingBuffer.inliersScene;
+	std::vector<uchar>& inlierMask = featureMatchingBuffer.inlierMask;
+	cv::Point2f offset;
 
 	feature_points_object.clear();
 	feature_points_scene.clear();
+	inliers_object.clear();
+	inliers_scene.clear();
+	inlierMask.clear();
 
 	// Count of good matches if results are good enough.
 	if (good_matches.size() >= this->countMatches)
@@ -418,24 +674,194 @@ PTR_DRAW Companion::Algorithm::Recognition::Matching::FeatureMatching::ObtainMat
 		// Find Homography if only features points are filled
 		if (!feature_points_object.empty() && !feature_points_scene.empty())
 		{
-			homography = cv::findHomography(feature_points_object,
-				feature_points_scene,
-				this->findHomographyMethod,
-				this->reprojThreshold,
-				cv::noArray(),
-				this->ransacMaxIters);
+			// Offset must be obtained before IRA is updated by the calculated area
+			offset = SearchOffset(cModel, sModel->Image().size(), isIRAUsed, isROIUsed, roi);
+			searchToScene = (cv::Mat_<double>(3, 3) << 1.0, 0.0, offset.x, 0.0, 1.0, offset.y, 0.0, 0.0, 1.0);
+
+			Companion::Thread::StageTimer homographyTimer(TimingStage::HOMOGRAPHY, cModel->ID());
+			if (this->useHomographyVerification && !cModel->Homography().empty())
+			{
+				// Verify the homography of the last frame first, moved into the searched scene part
+				homography = VerifyHomography(searchToScene.inv() * cModel->Homography(),
+					feature_points_object,
+					feature_points_scene,
+					inlierMask);
+
+				if (!homography.empty())
+				{
+					this->homographyHits++;
+				}
+				else
+				{
+					this->homographyMisses++;
+				}
+			}
 
 			if (!homography.empty())
 			{
+				// Previous homography verified, no robust estimation needed
+			}
+			else if (this->findHomographyMethod == ProsacHomography::PROSAC)
+			{
+				// Good matches are sorted by distance, sample the best ones first
+				homography = ProsacHomography(this->reprojThreshold, this->ransacMaxIters).Estimate(feature_points_object,
+					feature_points_scene,
+					inlierMask);
+			}
+			else
+			{
+				homography = cv::findHomography(feature_points_object,
+					feature_points_scene,
+					this->findHomographyMethod,
+					this->reprojThreshold,
+					inlierMask,
+					this->ransacMaxIters);
+			}
+
+			homographyTimer.Stop();
+
+			if (!homography.empty())
+			{
+				Companion::Thread::StageTimer areaTimer(TimingStage::CALCULATE_AREA, cModel->ID());
 				drawable = CalculateArea(homography, sceneImage, objectImage, sModel, cModel, isIRAUsed, isROIUsed, roi);
 			}
+
+			if (drawable != nullptr)
+			{
+				// Store homography inliers in full scene coordinates, they can be tracked until the next recognition
+				for (size_t i = 0; i < inlierMask.size(); i++)
+				{
+					if (inlierMask[i])
+					{
+						inliers_object.push_back(feature_points_object[i]);
+						inliers_scene.push_back(feature_points_scene[i] + offset);
+					}
+				}
+				cModel->Tracking()->Inliers(inliers_object, inliers_scene);
+
+				// Cache homography in full scene coordinates for the next frame
+				cModel->Homography(searchToScene * homography);
+			}
 		}
 
 	}
 
+	if (drawable == nullptr)
+	{
+		// Object not found, the cached homography belongs to an outdated pose
+		cModel->Homography(cv::Mat());
+	}
+
 	return drawable;
 }
 
+cv::Mat Companion::Algorithm::Recognition::Matching::FeatureMatching::VerifyHomography(const cv::Mat& hypothesis,
+	const std::vector<cv::Point2f>& feature_points_object,
+	const std::vector<cv::Point2f>& feature_points_scene,
+	std::vector<uchar>& inlierMask)
+{
+	cv::Mat homography = hypothesis;
+	cv::Mat refined;
+	std::vector<uchar>& refinedMask = featureMatchingBuffer.refinedMask;
+	std::vector<cv::Point2f>& inliers_object = featureMatchingBuffer.refineObject;
+	std::vector<cv::Point2f>& inliers_scene = featureMatchingBuffer.refineScene;
+	size_t inliers, refinedInliers;
+
+	// Score the hypothesis in one pass
+	inliers = CountInliers(homography, feature_points_object, feature_points_scene, inlierMask);
+	if (inliers < 4 || inliers < this->minInlierRatio * feature_points_object.size())
+	{
+		inlierMask.clear();
+		return cv::Mat();
+	}
+
+	// Refine by least squares on the inliers until the inlier set is stable
+	for (int iteration = 0; iteration < HOMOGRAPHY_REFINE_ITERATIONS; iteration++)
+	{
+		inliers_object.clear();
+		inliers_scene.clear();
+		for (size_t i = 0; i < inlierMask.size(); i++)
+		{
+			if (inlierMask[i])
+			{
+				inliers_object.push_back(feature_points_object[i]);
+				inliers_scene.push_back(feature_points_scene[i]);
+			}
+		}
+
+		refined = cv::findHomography(inliers_object, inliers_scene, 0);
+		if (refined.empty())
+		{
+			break;
+		}
+
+		refinedInliers = CountInliers(refined, feature_points_object, feature_points_scene, refinedMask);
+		if (refinedInliers < inliers)
+		{
+			break;
+		}
+
+		homography = refined;
+		inlierMask.swap(refinedMask);
+		if (refinedInliers == inliers)
+		{
+			break;
+		}
+		inliers = refinedInliers;
+	}
+
+	return homography;
+}
+
+size_t Companion::Algorithm::Recognition::Matching::FeatureMatching::CountInliers(const cv::Mat& homography,
+	const std::vector<cv::Point2f>& feature_points_object,
+	const std::vector<cv::Point2f>& feature_points_scene,
+	std::vector<uchar>& inlierMask)
+{
+	std::vector<cv::Point2f>& projected = featureMatchingBuffer.projected;
+	size_t inliers = 0;
+	double threshold = this->reprojThreshold * this->reprojThreshold;
+
+	inlierMask.assign(feature_points_object.size(), 0);
+	cv::perspectiveTransform(feature_points_object, projected, homography);
+
+	for (size_t i = 0; i < projected.size(); i++)
+	{
+		cv::Point2f difference = projected[i] - feature_points_scene[i];
+		if (difference.dot(difference) <= threshold)
+		{
+			inlierMask[i] = 1;
+			inliers++;
+		}
+	}
+
+	return inliers;
+}
+
+cv::Point2f Companion::Algorithm::Recognition::Matching::FeatureMatching::SearchOffset(
+	PTR_MODEL_FEATURE_MATCHING cModel,
+	const cv::Size& sceneSize,
+	bool isIRAUsed,
+	bool isROIUsed,
+	PTR_DRAW_FRAME roi)
+{
+	cv::Rect lastRect = cv::Rect();
+
+	if (isIRAUsed) // IRA was used
+	{
+		lastRect = cModel->Ira()->SearchWindow();
+	}
+	else if (isROIUsed)
+	{
+		lastRect = cv::Rect(roi->TopLeft(), roi->BottomRight());
+	}
+
+	// Scene features of the scene part are moved by the part inside the scene
+	lastRect &= cv::Rect(0, 0, sceneSize.width, sceneSize.height);
+
+	return cv::Point2f(static_cast<float>(lastRect.x), static_cast<float>(lastRect.y));
+}
+
 PTR_DRAW Companion::Algorithm::Recognition::Matching::FeatureMatching::CalculateArea(
 	cv::Mat& homography,
 	cv::Mat& sceneImage,
@@ -461,20 +887,10 @@ PTR_DRAW Companion::Algorithm::Recognition::Matching::FeatureMatching::Calculate
 	cv::perspectiveTransform(obj_corners, scene_corners, homography);
 
 	//-- Draw lines between the corners (the mapped object in the scene - image_2 )
-	cv::Rect lastRect = cv::Rect();
 	PTR_IMAGE_REDUCTION_ALGORITHM ira = cModel->Ira();
 
-	if (isIRAUsed) // IRA was used
-	{
-		lastRect = ira->LastObjectPosition();
-	}
-	else if (isROIUsed)
-	{
-		lastRect = cv::Rect(roi->TopLeft(), roi->BottomRight());
-	}
-
 	// Offset is recalculate position from last recognition if exists
-	cv::Point2f offset = cv::Point2f(lastRect.x, lastRect.y);
+	cv::Point2f offset = SearchOffset(cModel, originalImg.size(), isIRAUsed, isROIUsed, roi);
 
 	// Focus area - Scene Corners
 	//   0               1
@@ -523,6 +939,9 @@ PTR_DRAW Companion::Algorithm::Recognition::Matching::FeatureMatching::Calculate
 	if (useIRA && frame != nullptr)
 	{
 
+		// Update the motion model with the measured object center
+		ira->Correct(cv::Point2f((minX + maxX) / 2.0f, (minY + maxY) / 2.0f) + offset, sModel);
+
 		// IRA stores position from the recognized object
 		ira->LastObjectPosition(start.x, start.y, end.x - start.x, end.y - start.y);
 		const cv::Rect& lastObjectPosition = ira->LastObjectPosition();
@@ -563,4 +982,36 @@ void Companion::Algorithm::Recognition::Matching::FeatureMatching::UseIRA(bool u
 	this->useIRA = useIRA;
 }
 
+void Companion::Algorithm::Recognition::Matching::FeatureMatching::IRATimeBudget(double iraTimeBudget)
+{
+	this->iraTimeBudget = iraTimeBudget;
+}
+
+void Companion::Algorithm::Recognition::Matching::FeatureMatching::UseHomographyVerification(bool useHomographyVerification,
+	float minInlierRatio)
+{
+	this->useHomographyVerification = useHomographyVerification;
+	this->minInlierRatio = minInlierRatio;
+}
+
+unsigned long long Companion::Algorithm::Recognition::Matching::FeatureMatching::HomographyHits() const
+{
+	return this->homographyHits;
+}
+
+unsigned long long Companion::Algorithm::Recognition::Matching::FeatureMatching::HomographyMisses() const
+{
+	return this->homographyMisses;
+}
+
+void Companion::Algorithm::Recognition::Matching::FeatureMatching::UseCrossCheck(bool crossCheck)
+{
+	this->crossCheck = crossCheck;
+}
+
+void Companion::Algorithm::Recognition::Matching::FeatureMatching::UseModelIndex(bool useModelIndex)
+{
+	this->useModelIndex = useModelIndex;
+}
+
 
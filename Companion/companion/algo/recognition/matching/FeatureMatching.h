@@ -19,8 +19,15 @@
 #ifndef COMPANION_FEATUREMATCHING_H
 #define COMPANION_FEATUREMATCHING_H
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
 #include <companion/algo/recognition/matching/Matching.h>
 #include <companion/algo/recognition/matching/util/IRA.h>
+#include <companion/algo/recognition/matching/util/HammingMatcher.h>
+#include <companion/algo/recognition/matching/util/MatchFilter.h>
+#include <companion/algo/recognition/matching/util/ProsacHomography.h>
+#include <companion/thread/StageTimer.h>
 #include <companion/util/CompanionError.h>
 
 namespace Companion {
@@ -45,19 +52,22 @@ namespace Companion {
 					 * Extractor  : BRISK, ORB, KAZE, AKAZE.
 					 * Matcher    : FLANNBASED, BRUTEFORCE, BRUTEFORCE_L1, BruteForce-Hamming, BRUTEFORCE_HAMMINGLUT, BRUTEFORCE_SL2.
 					 *
+					 * For binary descriptors the matcher type HammingMatcher::BRUTEFORCE_HAMMING_SIMD selects the SIMD hamming
+					 * matcher, in this case the given matcher can be nullptr.
+					 *
 					 * If you want to use SIFT: detector + descriptor and  SURF: detector + descriptor you have to build
 					 * Companion with XFeatures2D support.
 					 *
 					 * @param detector FeatureDetector to set.
 					 * @param extractor FeatureExtractor to set.
 					 * @param matcher FeatureMatcher to set.
-					 * @param matcherType FeatureMatcher type which is used like FlannBased or Bruteforce.
+					 * @param matcherType FeatureMatcher type which is used like FlannBased, Bruteforce or BRUTEFORCE_HAMMING_SIMD.
 					 * @param minSidelLength Minimum length of the recognized area's sides (in pixels). Default value is 10.
 					 * @param countMatches Maximum number from feature matches to obtain a good matching result. Default is by 40.
 					 * @param useIRA Indicator to use IRA to use last recognized objects from last scene. By default IRA is deactivated.
 					 * @param reprojThreshold Homography parameter: Maximum allowed reprojection error to treat a point pair as an inlier. Default is by 3.0.
 					 * @param ransacMaxIters Homography parameter: Maximum number of RANSAC iterations (2000 is the maximum). Default is by 500.
-					 * @param findHomographyMethod Method used to compute a homography matrix. Default is by RANSAC.
+					 * @param findHomographyMethod Method used to compute a homography matrix, OpenCV method or ProsacHomography::PROSAC. Default is by RANSAC.
 					 */
 					FeatureMatching(cv::Ptr<cv::FeatureDetector> detector,
 						cv::Ptr<cv::DescriptorExtractor> extractor,
@@ -123,6 +133,20 @@ namespace Companion {
 					 */
 					void CalculateKeyPoints(PTR_MODEL_FEATURE_MATCHING model);
 
+					/**
+					 * Calculate the scene features (grayscale image, keypoints and descriptors) once per frame and cache them
+					 * in the given scene model. All object models searched in this scene share these features read-only.
+					 * @param sceneModel Scene model to calculate and cache the features for.
+					 */
+					void CalculateSceneFeatures(PTR_MODEL_FEATURE_MATCHING sceneModel);
+
+					/**
+					 * Prepare the given object model once when it is added: calculate its keypoints and descriptors, convert them
+					 * for the used matcher type and build its persistent matcher index if the model index is used.
+					 * @param model Object model to prepare.
+					 */
+					void TrainModel(PTR_MODEL_FEATURE_MATCHING model);
+
 					/**
 					 * Feature matching algorithm implementation to search in a scene model for the given object model.
 					 * @param sceneModel Scene model to verify for matching.
@@ -134,6 +158,18 @@ namespace Companion {
 						PTR_MODEL_FEATURE_MATCHING objectModel,
 						PTR_DRAW_FRAME roi);
 
+					/**
+					 * Verify an object model candidate for which the good matches are already known, for example from a catalog
+					 * wide index. Only the best matches are used to find the homography of the object in the full scene.
+					 * @param sceneModel Scene model with calculated scene features.
+					 * @param objectModel Object model candidate to verify.
+					 * @param goodMatches Good matches in object to scene direction, will be sorted and truncated.
+					 * @return A recognition result model if the object is recognized, otherwise nullptr.
+					 */
+					PTR_RESULT_RECOGNITION VerifyCandidate(PTR_MODEL_FEATURE_MATCHING sceneModel,
+						PTR_MODEL_FEATURE_MATCHING objectModel,
+						std::vector<cv::DMatch>& goodMatches);
+
 					/**
 					 * Indicator if this algorithm uses cuda.
 					 * @return True if cuda will be used otherwise false.
@@ -146,6 +182,51 @@ namespace Companion {
 					 */
 					void UseIRA(bool useIRA);
 
+					/**
+					 * Set the time budget of the IRA ring search. If an object is not found in the predicted search window, the
+					 * window is expanded as long as the search time in this frame is below the budget, afterwards the full scene
+					 * is searched.
+					 * @param iraTimeBudget Time budget in milliseconds.
+					 */
+					void IRATimeBudget(double iraTimeBudget);
+
+					/**
+					 * Set to disable or enable the cross-check of good matches. If enabled each scene feature is used only by
+					 * its best matching object feature.
+					 * @param crossCheck Use cross-check in the ratio test.
+					 */
+					void UseCrossCheck(bool crossCheck);
+
+					/**
+					 * Set to disable or enable the verification of the previous homography. If enabled, the homography of an
+					 * object from the last frame is scored against the new matches first and only refined by least squares if
+					 * enough matches are inliers, so RANSAC is skipped. Disabled by default.
+					 * @param useHomographyVerification Verify the previous homography before estimating a new one.
+					 * @param minInlierRatio Minimum ratio of inliers to accept the previous homography. Default is by 0.6.
+					 */
+					void UseHomographyVerification(bool useHomographyVerification, float minInlierRatio = 0.6f);
+
+					/**
+					 * Get the count of recognitions where the verified previous homography was used and RANSAC was skipped.
+					 * @return Count of homography cache hits.
+					 */
+					unsigned long long HomographyHits() const;
+
+					/**
+					 * Get the count of recognitions where the previous homography was rejected and RANSAC was used.
+					 * @return Count of homography cache misses.
+					 */
+					unsigned long long HomographyMisses() const;
+
+					/**
+					 * Set to disable or enable the per-model matcher index. If enabled each object model owns a trained matcher
+					 * index which is built once and the scene descriptors are used as queries, instead of indexing the scene
+					 * for every model on every frame. The index is built by TrainModel when a model is added, so this must be
+					 * set before models are added. Models without an index keep matching against the scene.
+					 * @param useModelIndex Use a persistent matcher index per object model.
+					 */
+					void UseModelIndex(bool useModelIndex);
+
 				private:
 
 					/**
@@ -173,18 +254,64 @@ namespace Companion {
 					 */
 					bool useIRA = false;
 
+					/**
+					 * Default time budget of the IRA ring search in milliseconds.
+					 */
+					static constexpr double DEFAULT_IRA_TIME_BUDGET = 20.0;
+
+					/**
+					 * Time budget of the IRA ring search in milliseconds.
+					 */
+					double iraTimeBudget = DEFAULT_IRA_TIME_BUDGET;
+
+					/**
+					 * Indicator to use the cross-check in the ratio test.
+					 */
+					bool crossCheck = false;
+
+					/**
+					 * Least squares refinement iterations of a verified homography.
+					 */
+					static constexpr int HOMOGRAPHY_REFINE_ITERATIONS = 3;
+
+					/**
+					 * Indicator to verify the previous homography before estimating a new one.
+					 */
+					bool useHomographyVerification = false;
+
+					/**
+					 * Minimum ratio of inliers to accept the previous homography.
+					 */
+					float minInlierRatio = 0.6f;
+
+					/**
+					 * Count of recognitions which used the verified previous homography.
+					 */
+					std::atomic<unsigned long long> homographyHits;
+
+					/**
+					 * Count of recognitions which rejected the previous homography.
+					 */
+					std::atomic<unsigned long long> homographyMisses;
+
+					/**
+					 * Indicator to use a persistent matcher index per object model.
+					 */
+					bool useModelIndex = false;
+
 					/**
 					 * Homography parameter: Method used to compute a homography matrix. The following methods are possible:
 					 *      - 0      (a regular method using all the points)
 					 *      - RANSAC (RANSAC-based robust method)
 					 *      - LMEDS  (Least-Median robust method)
 					 *      - RHO    (PROSAC-based robust method)
+					 *      - ProsacHomography::PROSAC (PROSAC on the distance sorted good matches with early termination)
 					 * Default value is RANSAC.
 					 */
 					int findHomographyMethod = cv::RANSAC;
 
 					/**
-					 * Homography parameter: Maximum allowed reprojection error to treat a point pair as an inlier (used in the RANSAC and RHO methods only).
+					 * Homography parameter: Maximum allowed reprojection error to treat a point pair as an inlier (used in the RANSAC, RHO and PROSAC methods only).
 					 * Default value is 3.0.
 					 */
 					double reprojThreshold = 3.0;
@@ -261,6 +388,23 @@ namespace Companion {
 						std::vector<cv::DMatch>& good_matches,
 						float ratio);
 
+					/**
+					 * Symmetric ratio test for matches from scene descriptors (query) to object descriptors (train). The ratio test
+					 * is applied in scene direction and between competing scene features of each object feature, so only mutually
+					 * distinctive one-to-one matches remain. Good matches are returned in object to scene direction like RatioTest.
+					 * The distances in object direction are only known for scene features which list the object feature among
+					 * their nearest neighbours. They can be larger than the true nearest distances of the object feature, so the
+					 * accepted matches are not equal to those of RatioTest with object to scene matches.
+					 * @param matches Matches from the scene to the object model index.
+					 * @param good_matches Vector to store good matches.
+					 * @param ratio Ratio to determine which matches are good enough.
+					 * @param objectFeatures Number of object features.
+					 */
+					void SymmetricRatioTest(const std::vector<std::vector<cv::DMatch>>& matches,
+						std::vector<cv::DMatch>& good_matches,
+						float ratio,
+						size_t objectFeatures);
+
 					/**
 					 * Filter to obtain only good feature point matches.
 					 * @param good_matches Good matches to store.
@@ -275,6 +419,50 @@ namespace Companion {
 						std::vector<cv::Point2f>& feature_points_object,
 						std::vector<cv::Point2f>& feature_points_scene);
 
+					/**
+					 * Score a homography hypothesis against the given matches in one pass and refine it by least squares if
+					 * enough matches are inliers.
+					 * @param hypothesis Homography hypothesis from object to the searched scene.
+					 * @param feature_points_object Feature points from object.
+					 * @param feature_points_scene Feature points from scene.
+					 * @param inlierMask Inlier mask of the returned homography.
+					 * @return Refined homography or an empty cv::Mat if the hypothesis is rejected.
+					 */
+					cv::Mat VerifyHomography(const cv::Mat& hypothesis,
+						const std::vector<cv::Point2f>& feature_points_object,
+						const std::vector<cv::Point2f>& feature_points_scene,
+						std::vector<uchar>& inlierMask);
+
+					/**
+					 * Count the matches which follow the given homography.
+					 * @param homography Homography from object to scene.
+					 * @param feature_points_object Feature points from object.
+					 * @param feature_points_scene Feature points from scene.
+					 * @param inlierMask Inlier mask to fill.
+					 * @return Count of inliers.
+					 */
+					size_t CountInliers(const cv::Mat& homography,
+						const std::vector<cv::Point2f>& feature_points_object,
+						const std::vector<cv::Point2f>& feature_points_scene,
+						std::vector<uchar>& inlierMask);
+
+					/**
+					 * Obtain the offset of the searched scene part in the full scene image. The scene part is clamped to the
+					 * scene like SceneFeatures::Subset does, so points of the scene part are moved back correctly also if
+					 * the scene part crosses the image border.
+					 * @param cModel Feature matching model of the object.
+					 * @param sceneSize Size of the full scene image.
+					 * @param isIRAUsed Flag if IRA was used.
+					 * @param isROIUsed Flag if ROI was used.
+					 * @param roi Region of interest.
+					 * @return Top left position of the searched scene part.
+					 */
+					cv::Point2f SearchOffset(PTR_MODEL_FEATURE_MATCHING cModel,
+						const cv::Size& sceneSize,
+						bool isIRAUsed,
+						bool isROIUsed,
+						PTR_DRAW_FRAME roi);
+
 					/**
 					 * Calculate area position from recognized object in scene.
 					 * @param homography Homography to find objects position.
@@ -313,8 +501,8 @@ namespace Companion {
 					PTR_DRAW ObtainMatchingResult(cv::Mat& sceneImage,
 						cv::Mat& objectImage,
 						std::vector<cv::DMatch>& good_matches,
-						std::vector<cv::KeyPoint>& keypoints_object,
-						std::vector<cv::KeyPoint>& keypoints_scene,
+						const std::vector<cv::KeyPoint>& keypoints_object,
+						const std::vector<cv::KeyPoint>& keypoints_scene,
 						PTR_MODEL_FEATURE_MATCHING sModel,
 						PTR_MODEL_FEATURE_MATCHING cModel,
 						bool isIRAUsed,
@@ -0,0 +1,143 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CatalogIndex.h"
+
+Companion::Algorithm::Recognition::Matching::CatalogIndex::CatalogIndex()
+{
+	this->models = 0;
+	this->index = nullptr;
+}
+
+void Companion::Algorithm::Recognition::Matching::CatalogIndex::Build(const std::vector<PTR_MODEL_FEATURE_MATCHING>& models)
+{
+	size_t rows = 0;
+	int offset = 0;
+	cv::Mat descriptors;
+
+	Clear();
+	this->models = models.size();
+
+	for (size_t i = 0; i < models.size(); i++)
+	{
+		rows += models[i]->Descriptors().rows;
+	}
+
+	this->rowModel.reserve(rows);
+	this->rowFeature.reserve(rows);
+
+	// Concatenate all model descriptors to one catalog and store the origin of each row
+	for (size_t i = 0; i < models.size(); i++)
+	{
+		descriptors = models[i]->Descriptors();
+		if (descriptors.empty() || (!this->catalog.empty() && (descriptors.type() != this->catalog.type() || descriptors.cols != this->catalog.cols)))
+		{
+			continue;
+		}
+
+		if (this->catalog.empty())
+		{
+			this->catalog.create(static_cast<int>(rows), descriptors.cols, descriptors.type());
+		}
+
+		descriptors.copyTo(this->catalog.rowRange(offset, offset + descriptors.rows));
+		for (int row = 0; row < descriptors.rows; row++)
+		{
+			this->rowModel.push_back(static_cast<int>(i));
+			this->rowFeature.push_back(row);
+		}
+		offset += descriptors.rows;
+	}
+
+	if (offset == 0)
+	{
+		Clear();
+		return;
+	}
+
+	this->catalog = this->catalog.rowRange(0, offset);
+
+	if (this->catalog.type() == CV_8U)
+	{
+		// Binary descriptors - multi-probe LSH
+		this->index = cv::makePtr<cv::FlannBasedMatcher>(cv::makePtr<cv::flann::LshIndexParams>(12, 20, 2));
+	}
+	else
+	{
+		// Float descriptors - randomized KD-forest
+		if (this->catalog.type() != CV_32F)
+		{
+			this->catalog.convertTo(this->catalog, CV_32F);
+		}
+		this->index = cv::makePtr<cv::FlannBasedMatcher>(cv::makePtr<cv::flann::KDTreeIndexParams>(4));
+	}
+
+	this->index->add(std::vector<cv::Mat>(1, this->catalog));
+	this->index->train();
+}
+
+void Companion::Algorithm::Recognition::Matching::CatalogIndex::Clear()
+{
+	this->catalog.release();
+	this->rowModel.clear();
+	this->rowFeature.clear();
+	this->models = 0;
+	this->index = nullptr;
+}
+
+bool Companion::Algorithm::Recognition::Matching::CatalogIndex::Empty() const
+{
+	return this->index == nullptr;
+}
+
+void Companion::Algorithm::Recognition::Matching::CatalogIndex::Vote(const cv::Mat& sceneDescriptors,
+	float ratio,
+	std::vector<std::vector<cv::DMatch>>& modelMatches) const
+{
+	std::vector<std::vector<cv::DMatch>> matches;
+	cv::Mat queries = sceneDescriptors;
+	int row;
+
+	modelMatches.assign(this->models, std::vector<cv::DMatch>());
+
+	if (Empty() || queries.empty())
+	{
+		return;
+	}
+
+	if (queries.type() != this->catalog.type())
+	{
+		queries.convertTo(queries, this->catalog.type());
+	}
+
+	// Single query of all scene descriptors against the whole catalog
+	this->index->knnMatch(queries, matches, NEIGHBORS);
+
+	for (size_t i = 0; i < matches.size(); i++)
+	{
+		if (matches[i].size() >= 2 && (matches[i][0].distance < ratio * matches[i][1].distance))
+		{
+			row = matches[i][0].trainIdx;
+			if (row >= 0 && static_cast<size_t>(row) < this->rowModel.size())
+			{
+				// Vote for the model of this row in object to scene direction
+				modelMatches[this->rowModel[row]].push_back(cv::DMatch(this->rowFeature[row], matches[i][0].queryIdx, matches[i][0].distance));
+			}
+		}
+	}
+}
@@ -0,0 +1,119 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_CATALOGINDEX_H
+#define COMPANION_CATALOGINDEX_H
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <opencv2/features2d.hpp>
+#include <companion/model/processing/FeatureMatchingModel.h>
+#include <companion/util/Definitions.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Algorithm {
+		namespace Recognition {
+			namespace Matching
+			{
+				/**
+				 * Catalog-wide descriptor index which concatenates the descriptors of all models into one contiguous catalog
+				 * matrix and searches it with a single approximate nearest neighbor index (FLANN KD-forest for float
+				 * descriptors and multi-probe LSH for binary descriptors).
+				 * @author Andreas Sekulski, Dimitri Kotlovsky
+				 */
+				class COMP_EXPORTS CatalogIndex
+				{
+
+				public:
+
+					/**
+					 * Default constructor to create an empty catalog index.
+					 */
+					CatalogIndex();
+
+					/**
+					 * Destructor.
+					 */
+					virtual ~CatalogIndex() = default;
+
+					/**
+					 * Build the catalog and its index from the descriptors of the given models. Models without descriptors are skipped.
+					 * @param models Models to build the catalog from, descriptors must already be calculated.
+					 */
+					void Build(const std::vector<PTR_MODEL_FEATURE_MATCHING>& models);
+
+					/**
+					 * Clear the catalog and its index.
+					 */
+					void Clear();
+
+					/**
+					 * Check if the catalog contains any descriptors.
+					 * @return <code>True</code> if the catalog is empty, <code>false</code> otherwise.
+					 */
+					bool Empty() const;
+
+					/**
+					 * Match the scene descriptors once against the whole catalog and vote for each model with all matches which
+					 * pass the ratio test. Several threads can vote at the same time as long as the catalog is not rebuilt.
+					 * @param sceneDescriptors Scene descriptors as queries.
+					 * @param ratio Ratio to determine which matches are good enough.
+					 * @param modelMatches Good matches for each model in the order of the built models. Matches are stored in
+					 * object to scene direction (query index is the model keypoint, train index the scene keypoint).
+					 */
+					void Vote(const cv::Mat& sceneDescriptors, float ratio, std::vector<std::vector<cv::DMatch>>& modelMatches) const;
+
+				private:
+
+					/**
+					 * Contiguous catalog matrix which contains the descriptors of all models.
+					 */
+					cv::Mat catalog;
+
+					/**
+					 * Row to model table, stores for each catalog row the index of its model.
+					 */
+					std::vector<int> rowModel;
+
+					/**
+					 * Row to feature table, stores for each catalog row the keypoint index within its model.
+					 */
+					std::vector<int> rowFeature;
+
+					/**
+					 * Number of models the catalog was built from.
+					 */
+					size_t models;
+
+					/**
+					 * Approximate nearest neighbor index over the catalog.
+					 */
+					cv::Ptr<cv::DescriptorMatcher> index;
+
+					/**
+					 * Number of nearest neighbors used for the ratio test.
+					 */
+					static constexpr int NEIGHBORS = 2;
+				};
+			}
+		}
+	}
+}
+
+#endif //COMPANION_CATALOGINDEX_H
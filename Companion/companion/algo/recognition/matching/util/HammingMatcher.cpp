@@ -0,0 +1,559 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HammingMatcher.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#include <cpuid.h>
+	#include <immintrin.h>
+	#define COMPANION_HAMMING_X86 1
+	#define COMPANION_HAMMING_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+	#include <immintrin.h>
+	#define COMPANION_HAMMING_X86 1
+	#define COMPANION_HAMMING_TARGET(isa)
+#else
+	#define COMPANION_HAMMING_X86 0
+#endif
+
+/**
+ * Per-thread buffers of the k nearest neighbor search, they grow to the largest query and are reused for every frame.
+ */
+struct HammingMatcherBuffer
+{
+	/**
+	 * Packed query rows.
+	 */
+	std::vector<uint8_t> queries;
+
+	/**
+	 * Distances from one query row to a train block.
+	 */
+	std::vector<int> distances;
+
+	/**
+	 * Sorted k best distances of each query row.
+	 */
+	std::vector<int> bestDistances;
+
+	/**
+	 * Train rows of the k best distances of each query row.
+	 */
+	std::vector<int> bestRows;
+};
+
+static thread_local HammingMatcherBuffer hammingMatcherBuffer;
+
+/**
+ * Portable popcount of a 64 bit word.
+ * @param value Word to count bits of.
+ * @return Count of set bits.
+ */
+static inline int PopCount64(uint64_t value)
+{
+	value = value - ((value >> 1) & 0x5555555555555555ULL);
+	value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return static_cast<int>((value * 0x0101010101010101ULL) >> 56);
+}
+
+/**
+ * Scalar hamming distance kernel, compares 8 bytes per step.
+ */
+static void DistancesScalar(const uint8_t* query, const uint8_t* train, size_t rows, size_t stride, size_t bytes, int* distances)
+{
+	const uint64_t* q = reinterpret_cast<const uint64_t*>(query);
+	const size_t words = bytes / sizeof(uint64_t);
+
+	for (size_t r = 0; r < rows; r++)
+	{
+		const uint64_t* t = reinterpret_cast<const uint64_t*>(train + r * stride);
+		int distance = 0;
+		for (size_t w = 0; w < words; w++)
+		{
+			distance += PopCount64(q[w] ^ t[w]);
+		}
+		distances[r] = distance;
+	}
+}
+
+#if COMPANION_HAMMING_X86
+/**
+ * AVX2 hamming distance kernel, counts bits with a nibble lookup table and compares 32 bytes per step.
+ */
+COMPANION_HAMMING_TARGET("avx2")
+static void DistancesAvx2(const uint8_t* query, const uint8_t* train, size_t rows, size_t stride, size_t bytes, int* distances)
+{
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i lowMask = _mm256_set1_epi8(0x0F);
+	const __m256i zero = _mm256_setzero_si256();
+
+	for (size_t r = 0; r < rows; r++)
+	{
+		const uint8_t* t = train + r * stride;
+		__m256i sum = zero;
+		for (size_t b = 0; b < bytes; b += 32)
+		{
+			__m256i x = _mm256_xor_si256(_mm256_load_si256(reinterpret_cast<const __m256i*>(query + b)),
+				_mm256_load_si256(reinterpret_cast<const __m256i*>(t + b)));
+			__m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, lowMask));
+			__m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), lowMask));
+			sum = _mm256_add_epi64(sum, _mm256_sad_epu8(_mm256_add_epi8(low, high), zero));
+		}
+		__m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		distances[r] = static_cast<int>(_mm_cvtsi128_si32(half) + _mm_extract_epi32(half, 2));
+	}
+}
+
+/**
+ * AVX-512 hamming distance kernel, uses the native 64 bit popcount (VPOPCNTDQ) and compares 64 bytes per step.
+ */
+COMPANION_HAMMING_TARGET("avx512f,avx512vpopcntdq")
+static void DistancesAvx512(const uint8_t* query, const uint8_t* train, size_t rows, size_t stride, size_t bytes, int* distances)
+{
+	for (size_t r = 0; r < rows; r++)
+	{
+		const uint8_t* t = train + r * stride;
+		__m512i sum = _mm512_setzero_si512();
+		for (size_t b = 0; b < bytes; b += 64)
+		{
+			__m512i x = _mm512_xor_si512(_mm512_load_si512(query + b), _mm512_load_si512(t + b));
+			sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(x));
+		}
+		distances[r] = static_cast<int>(_mm512_reduce_add_epi64(sum));
+	}
+}
+
+/**
+ * Read the extended control register to check which register states are enabled by the operating system.
+ * @return Value of XCR0.
+ */
+static uint64_t ReadXCR0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+/**
+ * Query cpuid leaf with sub leaf.
+ * @param leaf Leaf to query.
+ * @param subLeaf Sub leaf to query.
+ * @param registers Output registers eax, ebx, ecx, edx.
+ */
+static void ReadCpuid(uint32_t leaf, uint32_t subLeaf, uint32_t registers[4])
+{
+#if defined(_MSC_VER)
+	int values[4];
+	__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subLeaf));
+	for (int i = 0; i < 4; i++)
+	{
+		registers[i] = static_cast<uint32_t>(values[i]);
+	}
+#else
+	registers[0] = registers[1] = registers[2] = registers[3] = 0;
+	__get_cpuid_count(leaf, subLeaf, &registers[0], &registers[1], &registers[2], &registers[3]);
+#endif
+}
+#endif
+
+/**
+ * Supported instruction sets of this CPU.
+ */
+enum class HammingIsa
+{
+	SCALAR, ///< Portable scalar code.
+	AVX2, ///< AVX2 nibble lookup popcount.
+	AVX512 ///< AVX-512 VPOPCNTDQ popcount.
+};
+
+/**
+ * Detect the best supported instruction set once, checks CPU and operating system support.
+ * @return Best supported instruction set.
+ */
+static HammingIsa DetectIsa()
+{
+	static const HammingIsa isa = []()
+	{
+#if COMPANION_HAMMING_X86
+		uint32_t registers[4];
+		uint64_t xcr0;
+
+		ReadCpuid(0, 0, registers);
+		if (registers[0] < 7)
+		{
+			return HammingIsa::SCALAR;
+		}
+
+		// OSXSAVE is required to read XCR0
+		ReadCpuid(1, 0, registers);
+		if ((registers[2] & (1u << 27)) == 0)
+		{
+			return HammingIsa::SCALAR;
+		}
+		xcr0 = ReadXCR0();
+
+		ReadCpuid(7, 0, registers);
+		// AVX512F (ebx 16), VPOPCNTDQ (ecx 14) and opmask, ZMM and YMM state enabled
+		if ((registers[1] & (1u << 16)) && (registers[2] & (1u << 14)) && (xcr0 & 0xE6) == 0xE6)
+		{
+			return HammingIsa::AVX512;
+		}
+		// AVX2 (ebx 5) and YMM state enabled
+		if ((registers[1] & (1u << 5)) && (xcr0 & 0x6) == 0x6)
+		{
+			return HammingIsa::AVX2;
+		}
+#endif
+		return HammingIsa::SCALAR;
+	}();
+
+	return isa;
+}
+
+Companion::Algorithm::Recognition::Matching::HammingMatcher::HammingMatcher()
+{
+	this->packed = nullptr;
+	this->rows = 0;
+	this->cols = 0;
+	this->stride = 0;
+	this->trained = false;
+}
+
+cv::Ptr<Companion::Algorithm::Recognition::Matching::HammingMatcher> Companion::Algorithm::Recognition::Matching::HammingMatcher::create()
+{
+	return cv::makePtr<HammingMatcher>();
+}
+
+std::string Companion::Algorithm::Recognition::Matching::HammingMatcher::InstructionSet()
+{
+	switch (DetectIsa())
+	{
+	case HammingIsa::AVX512:
+		return "avx512";
+	case HammingIsa::AVX2:
+		return "avx2";
+	default:
+		return "scalar";
+	}
+}
+
+void Companion::Algorithm::Recognition::Matching::HammingMatcher::add(cv::InputArrayOfArrays descriptors)
+{
+	cv::DescriptorMatcher::add(descriptors);
+	this->trained = false;
+}
+
+void Companion::Algorithm::Recognition::Matching::HammingMatcher::clear()
+{
+	cv::DescriptorMatcher::clear();
+	this->storage.clear();
+	this->imageOffsets.clear();
+	this->packed = nullptr;
+	this->rows = 0;
+	this->cols = 0;
+	this->stride = 0;
+	this->trained = false;
+}
+
+void Companion::Algorithm::Recognition::Matching::HammingMatcher::train()
+{
+	size_t row = 0;
+
+	if (this->trained)
+	{
+		return;
+	}
+
+	this->rows = 0;
+	this->cols = 0;
+	this->imageOffsets.clear();
+
+	for (size_t i = 0; i < this->trainDescCollection.size(); i++)
+	{
+		const cv::Mat& descriptors = this->trainDescCollection[i];
+		if (!descriptors.empty())
+		{
+			CV_Assert(descriptors.type() == CV_8U && (this->cols == 0 || static_cast<size_t>(descriptors.cols) == this->cols));
+			this->cols = descriptors.cols;
+		}
+		this->imageOffsets.push_back(static_cast<int>(this->rows));
+		this->rows += descriptors.rows;
+	}
+
+	// Round rows up to the alignment, padding bytes are zero and do not change the distance
+	this->stride = ((this->cols + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+	this->packed = AlignedBuffer(this->storage, this->rows * this->stride);
+	std::fill(this->packed, this->packed + this->rows * this->stride, static_cast<uint8_t>(0));
+
+	for (size_t i = 0; i < this->trainDescCollection.size(); i++)
+	{
+		const cv::Mat& descriptors = this->trainDescCollection[i];
+		for (int r = 0; r < descriptors.rows; r++, row++)
+		{
+			std::copy(descriptors.ptr<uint8_t>(r), descriptors.ptr<uint8_t>(r) + this->cols, this->packed + row * this->stride);
+		}
+	}
+
+	this->trained = true;
+}
+
+bool Companion::Algorithm::Recognition::Matching::HammingMatcher::isMaskSupported() const
+{
+	return false;
+}
+
+cv::Ptr<cv::DescriptorMatcher> Companion::Algorithm::Recognition::Matching::HammingMatcher::clone(bool emptyTrainData) const
+{
+	cv::Ptr<HammingMatcher> matcher = create();
+
+	if (!emptyTrainData)
+	{
+		for (size_t i = 0; i < this->trainDescCollection.size(); i++)
+		{
+			matcher->trainDescCollection.push_back(this->trainDescCollection[i].clone());
+		}
+	}
+
+	return matcher;
+}
+
+void Companion::Algorithm::Recognition::Matching::HammingMatcher::knnMatchImpl(cv::InputArray queryDescriptors,
+	std::vector<std::vector<cv::DMatch>>& matches,
+	int k,
+	cv::InputArrayOfArrays masks,
+	bool compactResult)
+{
+	cv::Mat query = queryDescriptors.getMat();
+
+	matches.clear();
+	train();
+
+	if (query.empty() || this->rows == 0 || k <= 0)
+	{
+		if (!compactResult)
+		{
+			matches.resize(query.rows);
+		}
+		return;
+	}
+
+	KnnMatchInto(query, matches, k);
+}
+
+void Companion::Algorithm::Recognition::Matching::HammingMatcher::KnnMatchInto(const cv::Mat& queryDescriptors,
+	std::vector<std::vector<cv::DMatch>>& matches,
+	int k)
+{
+	std::vector<int>& distances = hammingMatcherBuffer.distances;
+	std::vector<int>& bestDistances = hammingMatcherBuffer.bestDistances;
+	std::vector<int>& bestRows = hammingMatcherBuffer.bestRows;
+	const uint8_t* queries;
+	DistanceKernel kernel;
+	size_t bytes, blockRows, neighbors;
+
+	train();
+
+	// Match lists keep their capacity, only surplus lists are released
+	matches.resize(queryDescriptors.rows);
+	for (size_t q = 0; q < matches.size(); q++)
+	{
+		matches[q].clear();
+	}
+
+	if (queryDescriptors.empty() || this->rows == 0 || k <= 0)
+	{
+		return;
+	}
+
+	CV_Assert(queryDescriptors.type() == CV_8U && static_cast<size_t>(queryDescriptors.cols) == this->cols);
+
+	kernel = SelectKernel(this->cols, bytes);
+	queries = PackQueries(queryDescriptors, hammingMatcherBuffer.queries);
+	neighbors = std::min(static_cast<size_t>(k), this->rows);
+	blockRows = std::max<size_t>(1, BLOCK_BYTES / this->stride);
+	distances.resize(blockRows);
+	bestDistances.assign(static_cast<size_t>(queryDescriptors.rows) * neighbors, std::numeric_limits<int>::max());
+	bestRows.assign(static_cast<size_t>(queryDescriptors.rows) * neighbors, -1);
+
+	// Tile queries and train rows so a train block stays in cache for all queries of a tile
+	for (int tile = 0; tile < queryDescriptors.rows; tile += QUERY_TILE)
+	{
+		int tileEnd = std::min(tile + QUERY_TILE, queryDescriptors.rows);
+		for (size_t block = 0; block < this->rows; block += blockRows)
+		{
+			size_t count = std::min(blockRows, this->rows - block);
+			for (int q = tile; q < tileEnd; q++)
+			{
+				int* best = &bestDistances[q * neighbors];
+				int* bestRow = &bestRows[q * neighbors];
+
+				kernel(queries + q * this->stride, this->packed + block * this->stride, count, this->stride, bytes, distances.data());
+
+				for (size_t r = 0; r < count; r++)
+				{
+					int distance = distances[r];
+					if (distance < best[neighbors - 1])
+					{
+						// Insert into sorted k best list
+						size_t position = neighbors - 1;
+						while (position > 0 && best[position - 1] > distance)
+						{
+							best[position] = best[position - 1];
+							bestRow[position] = bestRow[position - 1];
+							position--;
+						}
+						best[position] = distance;
+						bestRow[position] = static_cast<int>(block + r);
+					}
+				}
+			}
+		}
+	}
+
+	for (int q = 0; q < queryDescriptors.rows; q++)
+	{
+		for (size_t n = 0; n < neighbors; n++)
+		{
+			matches[q].push_back(CreateMatch(q, bestRows[q * neighbors + n], bestDistances[q * neighbors + n]));
+		}
+	}
+}
+
+void Companion::Algorithm::Recognition::Matching::HammingMatcher::radiusMatchImpl(cv::InputArray queryDescriptors,
+	std::vector<std::vector<cv::DMatch>>& matches,
+	float maxDistance,
+	cv::InputArrayOfArrays masks,
+	bool compactResult)
+{
+	cv::Mat query = queryDescriptors.getMat();
+	std::vector<uint8_t> queryBuffer;
+	std::vector<int> distances;
+	const uint8_t* queries;
+	DistanceKernel kernel;
+	size_t bytes, blockRows;
+
+	matches.clear();
+	train();
+
+	if (query.empty() || this->rows == 0)
+	{
+		if (!compactResult)
+		{
+			matches.resize(query.rows);
+		}
+		return;
+	}
+
+	CV_Assert(query.type() == CV_8U && static_cast<size_t>(query.cols) == this->cols);
+
+	kernel = SelectKernel(this->cols, bytes);
+	queries = PackQueries(query, queryBuffer);
+	blockRows = std::max<size_t>(1, BLOCK_BYTES / this->stride);
+	distances.resize(blockRows);
+	matches.resize(query.rows);
+
+	for (int tile = 0; tile < query.rows; tile += QUERY_TILE)
+	{
+		int tileEnd = std::min(tile + QUERY_TILE, query.rows);
+		for (size_t block = 0; block < this->rows; block += blockRows)
+		{
+			size_t count = std::min(blockRows, this->rows - block);
+			for (int q = tile; q < tileEnd; q++)
+			{
+				kernel(queries + q * this->stride, this->packed + block * this->stride, count, this->stride, bytes, distances.data());
+				for (size_t r = 0; r < count; r++)
+				{
+					if (distances[r] <= maxDistance)
+					{
+						matches[q].push_back(CreateMatch(q, static_cast<int>(block + r), distances[r]));
+					}
+				}
+			}
+		}
+	}
+
+	for (size_t q = 0; q < matches.size(); q++)
+	{
+		std::sort(matches[q].begin(), matches[q].end());
+	}
+
+	if (compactResult)
+	{
+		matches.erase(std::remove_if(matches.begin(), matches.end(),
+			[](const std::vector<cv::DMatch>& queryMatches) { return queryMatches.empty(); }), matches.end());
+	}
+}
+
+Companion::Algorithm::Recognition::Matching::HammingMatcher::DistanceKernel
+Companion::Algorithm::Recognition::Matching::HammingMatcher::SelectKernel(size_t cols, size_t& bytes)
+{
+#if COMPANION_HAMMING_X86
+	HammingIsa isa = DetectIsa();
+
+	// Short descriptors like ORB (32 bytes) would waste half of an AVX-512 step, use AVX2 for them
+	if (isa == HammingIsa::AVX512 && cols > 32)
+	{
+		bytes = ((cols + 63) / 64) * 64;
+		return DistancesAvx512;
+	}
+	if (isa != HammingIsa::SCALAR)
+	{
+		bytes = ((cols + 31) / 32) * 32;
+		return DistancesAvx2;
+	}
+#endif
+	bytes = ((cols + 7) / 8) * 8;
+	return DistancesScalar;
+}
+
+uint8_t* Companion::Algorithm::Recognition::Matching::HammingMatcher::AlignedBuffer(std::vector<uint8_t>& buffer, size_t size)
+{
+	uintptr_t address;
+
+	buffer.resize(size + ALIGNMENT);
+	address = reinterpret_cast<uintptr_t>(buffer.data());
+	return buffer.data() + ((ALIGNMENT - (address % ALIGNMENT)) % ALIGNMENT);
+}
+
+uint8_t* Companion::Algorithm::Recognition::Matching::HammingMatcher::PackQueries(const cv::Mat& queryDescriptors,
+	std::vector<uint8_t>& buffer) const
+{
+	uint8_t* queries = AlignedBuffer(buffer, queryDescriptors.rows * this->stride);
+
+	std::fill(queries, queries + queryDescriptors.rows * this->stride, static_cast<uint8_t>(0));
+	for (int r = 0; r < queryDescriptors.rows; r++)
+	{
+		std::copy(queryDescriptors.ptr<uint8_t>(r), queryDescriptors.ptr<uint8_t>(r) + this->cols, queries + r * this->stride);
+	}
+
+	return queries;
+}
+
+cv::DMatch Companion::Algorithm::Recognition::Matching::HammingMatcher::CreateMatch(int queryIdx, int row, int distance) const
+{
+	// Find the train image of the packed row
+	size_t image = std::upper_bound(this->imageOffsets.begin(), this->imageOffsets.end(), row) - this->imageOffsets.begin() - 1;
+	return cv::DMatch(queryIdx, row - this->imageOffsets[image], static_cast<int>(image), static_cast<float>(distance));
+}
@@ -0,0 +1,245 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_HAMMINGMATCHER_H
+#define COMPANION_HAMMINGMATCHER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <opencv2/core/core.hpp>
+#include <opencv2/features2d.hpp>
+#include <companion/util/Definitions.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Algorithm {
+		namespace Recognition {
+			namespace Matching
+			{
+				/**
+				 * Brute force matcher for binary descriptors (ORB, BRISK, AKAZE) which computes the hamming distance with
+				 * AVX2 or AVX-512 popcount kernels. Train descriptors are stored bit-packed in 64-byte aligned rows and are
+				 * searched in cache sized blocks. The used instruction set is detected at runtime, a scalar kernel is used as
+				 * fallback on all other CPUs.
+				 * @author Andreas Sekulski, Dimitri Kotlovsky
+				 */
+				class COMP_EXPORTS HammingMatcher : public cv::DescriptorMatcher
+				{
+
+				public:
+
+					/**
+					 * Matcher type to select this matcher in feature matching, continues the OpenCV matcher types.
+					 */
+					static constexpr int BRUTEFORCE_HAMMING_SIMD = 100;
+
+					/**
+					 * Default constructor to create an empty hamming matcher.
+					 */
+					HammingMatcher();
+
+					/**
+					 * Destructor.
+					 */
+					virtual ~HammingMatcher() = default;
+
+					/**
+					 * Create an empty hamming matcher.
+					 * @return Hamming matcher.
+					 */
+					static cv::Ptr<HammingMatcher> create();
+
+					/**
+					 * Name of the instruction set which is used by the distance kernel on this CPU.
+					 * @return "avx512", "avx2" or "scalar".
+					 */
+					static std::string InstructionSet();
+
+					/**
+					 * Add train descriptors to the collection, the packed descriptors are rebuilt on next train.
+					 * @param descriptors Train descriptors in CV_8U format.
+					 */
+					virtual void add(cv::InputArrayOfArrays descriptors);
+
+					/**
+					 * Clear the train descriptor collection.
+					 */
+					virtual void clear();
+
+					/**
+					 * Pack all train descriptors into 64-byte aligned rows if the collection has changed.
+					 */
+					virtual void train();
+
+					/**
+					 * Masks are not supported by this matcher.
+					 * @return Always <code>false</code>.
+					 */
+					virtual bool isMaskSupported() const;
+
+					/**
+					 * Clone this matcher.
+					 * @param emptyTrainData If <code>true</code> the train descriptors are not copied.
+					 * @return Cloned matcher.
+					 */
+					virtual cv::Ptr<cv::DescriptorMatcher> clone(bool emptyTrainData = false) const;
+
+					/**
+					 * Find the k nearest train descriptors for each query descriptor like knnMatch, but keep the memory of
+					 * the given matches. Repeated calls with the same matches do not allocate once they have grown to the
+					 * largest query, knnMatch clears all match lists instead.
+					 * @param queryDescriptors Query descriptors in CV_8U format.
+					 * @param matches Matches for each query descriptor sorted by distance.
+					 * @param k Count of nearest neighbors.
+					 */
+					void KnnMatchInto(const cv::Mat& queryDescriptors, std::vector<std::vector<cv::DMatch>>& matches, int k);
+
+				protected:
+
+					/**
+					 * Find the k nearest train descriptors for each query descriptor.
+					 * @param queryDescriptors Query descriptors in CV_8U format.
+					 * @param matches Matches for each query descriptor sorted by distance.
+					 * @param k Count of nearest neighbors.
+					 * @param masks Not supported.
+					 * @param compactResult If <code>true</code> queries without matches are removed.
+					 */
+					virtual void knnMatchImpl(cv::InputArray queryDescriptors,
+						std::vector<std::vector<cv::DMatch>>& matches,
+						int k,
+						cv::InputArrayOfArrays masks = cv::noArray(),
+						bool compactResult = false);
+
+					/**
+					 * Find all train descriptors for each query descriptor with a distance not greater than max distance.
+					 * @param queryDescriptors Query descriptors in CV_8U format.
+					 * @param matches Matches for each query descriptor sorted by distance.
+					 * @param maxDistance Maximum hamming distance.
+					 * @param masks Not supported.
+					 * @param compactResult If <code>true</code> queries without matches are removed.
+					 */
+					virtual void radiusMatchImpl(cv::InputArray queryDescriptors,
+						std::vector<std::vector<cv::DMatch>>& matches,
+						float maxDistance,
+						cv::InputArrayOfArrays masks = cv::noArray(),
+						bool compactResult = false);
+
+				private:
+
+					/**
+					 * Kernel to calculate the hamming distances from one query row to a block of packed train rows.
+					 */
+					typedef void(*DistanceKernel)(const uint8_t* query,
+						const uint8_t* train,
+						size_t rows,
+						size_t stride,
+						size_t bytes,
+						int* distances);
+
+					/**
+					 * Row alignment and row stride granularity in bytes.
+					 */
+					static constexpr size_t ALIGNMENT = 64;
+
+					/**
+					 * Size in bytes of a train block which is searched at once, fits into the L1 data cache.
+					 */
+					static constexpr size_t BLOCK_BYTES = 32 * 1024;
+
+					/**
+					 * Count of query rows which are matched against the same train block.
+					 */
+					static constexpr int QUERY_TILE = 32;
+
+					/**
+					 * Memory of the packed train descriptors.
+					 */
+					std::vector<uint8_t> storage;
+
+					/**
+					 * Aligned pointer into storage to the first packed train row.
+					 */
+					uint8_t* packed;
+
+					/**
+					 * Count of packed train rows.
+					 */
+					size_t rows;
+
+					/**
+					 * Descriptor length in bytes.
+					 */
+					size_t cols;
+
+					/**
+					 * Distance between two packed rows in bytes.
+					 */
+					size_t stride;
+
+					/**
+					 * First packed row of each train image.
+					 */
+					std::vector<int> imageOffsets;
+
+					/**
+					 * Indicator if the packed rows match the train descriptor collection.
+					 */
+					bool trained;
+
+					/**
+					 * Select the fastest distance kernel for this CPU.
+					 * @param cols Descriptor length in bytes.
+					 * @param bytes Number of bytes the kernel compares per row, multiple of its vector width.
+					 * @return Distance kernel.
+					 */
+					static DistanceKernel SelectKernel(size_t cols, size_t& bytes);
+
+					/**
+					 * Get an aligned pointer into the given buffer with enough memory for the given size.
+					 * @param buffer Buffer to resize.
+					 * @param size Size in bytes.
+					 * @return Aligned pointer.
+					 */
+					static uint8_t* AlignedBuffer(std::vector<uint8_t>& buffer, size_t size);
+
+					/**
+					 * Pack query descriptors into aligned rows with the same stride as the train rows.
+					 * @param queryDescriptors Query descriptors.
+					 * @param buffer Buffer to use.
+					 * @return Aligned pointer to the first query row.
+					 */
+					uint8_t* PackQueries(const cv::Mat& queryDescriptors, std::vector<uint8_t>& buffer) const;
+
+					/**
+					 * Create a match from a packed train row.
+					 * @param queryIdx Query index.
+					 * @param row Packed train row.
+					 * @param distance Hamming distance.
+					 * @return Match with train and image index.
+					 */
+					cv::DMatch CreateMatch(int queryIdx, int row, int distance) const;
+				};
+			}
+		}
+	}
+}
+
+#endif //COMPANION_HAMMINGMATCHER_H
@@ -22,6 +22,19 @@ Companion::Algorithm::Recognition::Matching::IRA::IRA()
 {
 	this->lop.x = NO_OBJECT_RECOGNIZED;
 	this->lop.y = NO_OBJECT_RECOGNIZED;
+	this->ring = 0;
+	this->motionInitialized = false;
+
+	// Constant velocity model with a time step of one frame
+	this->motion.init(4, 2, 0, CV_32F);
+	this->motion.transitionMatrix = (cv::Mat_<float>(4, 4) <<
+		1, 0, 1, 0,
+		0, 1, 0, 1,
+		0, 0, 1, 0,
+		0, 0, 0, 1);
+	cv::setIdentity(this->motion.measurementMatrix);
+	cv::setIdentity(this->motion.processNoiseCov, cv::Scalar::all(1.0));
+	cv::setIdentity(this->motion.measurementNoiseCov, cv::Scalar::all(4.0));
 }
 
 const cv::Rect& Companion::Algorithm::Recognition::Matching::IRA::LastObjectPosition() const
@@ -63,9 +76,109 @@ void Companion::Algorithm::Recognition::Matching::IRA::Clear()
 	this->lop.y = NO_OBJECT_RECOGNIZED;
 	this->lop.width = NO_OBJECT_RECOGNIZED;
 	this->lop.height = NO_OBJECT_RECOGNIZED;
+	this->searchWindow = cv::Rect();
+	this->ring = 0;
+	this->motionInitialized = false;
+	this->predictedScene.reset();
+	this->correctedScene.reset();
 }
 
 bool Companion::Algorithm::Recognition::Matching::IRA::IsObjectRecognized()
 {
 	return (this->lop.width > NO_OBJECT_RECOGNIZED) && (this->lop.height > NO_OBJECT_RECOGNIZED);
 }
+
+void Companion::Algorithm::Recognition::Matching::IRA::Predict(const cv::Size& sceneSize, const std::shared_ptr<void>& scene)
+{
+	this->searchStart = std::chrono::steady_clock::now();
+	this->ring = 0;
+
+	if (this->predictedScene.lock() == scene)
+	{
+		// Scene was already predicted, a further search (e.g. of another ROI) keeps the motion model of this frame
+	}
+	else if (this->motionInitialized)
+	{
+		const cv::Mat& prediction = this->motion.predict();
+		this->predictedCenter = cv::Point2f(prediction.at<float>(0), prediction.at<float>(1));
+	}
+	else
+	{
+		this->predictedCenter = cv::Point2f(this->lop.x + this->lop.width / 2.0f, this->lop.y + this->lop.height / 2.0f);
+	}
+
+	this->predictedScene = scene;
+	this->searchWindow = CalculateWindow(sceneSize);
+}
+
+void Companion::Algorithm::Recognition::Matching::IRA::Correct(const cv::Point2f& center, const std::shared_ptr<void>& scene)
+{
+	cv::Mat measurement = (cv::Mat_<float>(2, 1) << center.x, center.y);
+
+	if (this->correctedScene.lock() == scene)
+	{
+		// Object was already measured in this frame, a second measurement would count as a further time step
+	}
+	else if (!this->motionInitialized)
+	{
+		// First measurement, object is not moving
+		this->motion.statePost = (cv::Mat_<float>(4, 1) << center.x, center.y, 0.0f, 0.0f);
+		cv::setIdentity(this->motion.errorCovPost, cv::Scalar::all(1.0));
+		this->motionInitialized = true;
+	}
+	else
+	{
+		this->motion.correct(measurement);
+	}
+
+	this->correctedScene = scene;
+	this->ring = 0;
+}
+
+bool Companion::Algorithm::Recognition::Matching::IRA::Expand(const cv::Size& sceneSize)
+{
+	if (this->ring >= MAX_RINGS || this->searchWindow == cv::Rect(0, 0, sceneSize.width, sceneSize.height))
+	{
+		return false;
+	}
+
+	this->ring++;
+	this->searchWindow = CalculateWindow(sceneSize);
+	return true;
+}
+
+const cv::Rect& Companion::Algorithm::Recognition::Matching::IRA::SearchWindow() const
+{
+	return this->searchWindow;
+}
+
+int Companion::Algorithm::Recognition::Matching::IRA::Ring() const
+{
+	return this->ring;
+}
+
+double Companion::Algorithm::Recognition::Matching::IRA::SearchTime() const
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->searchStart).count();
+}
+
+cv::Rect Companion::Algorithm::Recognition::Matching::IRA::CalculateWindow(const cv::Size& sceneSize) const
+{
+	float growth = 1.0f + this->ring * RING_GROWTH;
+	float width = this->lop.width * growth;
+	float height = this->lop.height * growth;
+	cv::Rect scene(0, 0, sceneSize.width, sceneSize.height);
+	cv::Rect window(cvRound(this->predictedCenter.x - width / 2.0f),
+		cvRound(this->predictedCenter.y - height / 2.0f),
+		cvRound(width),
+		cvRound(height));
+
+	window &= scene;
+	if (window.area() <= 0)
+	{
+		// Prediction left the scene, search the whole scene
+		window = scene;
+	}
+
+	return window;
+}
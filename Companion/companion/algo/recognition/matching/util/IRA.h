@@ -19,7 +19,10 @@
 #ifndef COMPANION_IRA_H
 #define COMPANION_IRA_H
 
+#include <chrono>
+#include <memory>
 #include <opencv2/core/core.hpp>
+#include <opencv2/video/tracking.hpp>
 #include <companion/util/exportapi/ExportAPIDefinitions.h>
 
 namespace Companion {
@@ -27,7 +30,9 @@ namespace Companion {
 		namespace Recognition {
 			namespace Matching {
 				/**
-				 * Image reduction algorithm (IRA) to improve performance for a supported object recognition.
+				 * Image reduction algorithm (IRA) to improve performance for a supported object recognition. The object center is
+				 * followed by a constant velocity Kalman filter to predict the search window of the next frame. If the object is
+				 * not found in the predicted window the window is expanded ring by ring.
 				 * @author Andreas Sekulski, Dimitri Kotlovsky
 				 */
 				class COMP_EXPORTS IRA
@@ -95,6 +100,49 @@ namespace Companion {
 					 */
 					bool IsObjectRecognized();
 
+					/**
+					 * Predict the object position in a new frame and set the search window to the predicted position. The
+					 * motion model advances only once per scene, further searches in the same scene restart at the same
+					 * prediction.
+					 * @param sceneSize Size of the scene image.
+					 * @param scene Scene of the frame which is searched.
+					 */
+					void Predict(const cv::Size& sceneSize, const std::shared_ptr<void>& scene);
+
+					/**
+					 * Correct the motion model with the measured object center of a recognition. The motion model is
+					 * corrected only once per scene.
+					 * @param center Measured object center in scene image coordinates.
+					 * @param scene Scene of the frame in which the object was recognized.
+					 */
+					void Correct(const cv::Point2f& center, const std::shared_ptr<void>& scene);
+
+					/**
+					 * Expand the search window by one ring around the predicted position.
+					 * @param sceneSize Size of the scene image.
+					 * @return <code>True</code> if the window was expanded, <code>false</code> if the maximum ring is reached or the
+					 * window already covers the whole scene.
+					 */
+					bool Expand(const cv::Size& sceneSize);
+
+					/**
+					 * Get the current search window.
+					 * @return Search window in scene image coordinates.
+					 */
+					const cv::Rect& SearchWindow() const;
+
+					/**
+					 * Get the current ring of the search, 0 is the predicted window.
+					 * @return Current ring.
+					 */
+					int Ring() const;
+
+					/**
+					 * Get the elapsed search time since the last prediction.
+					 * @return Elapsed time in milliseconds.
+					 */
+					double SearchTime() const;
+
 				private:
 
 					/**
@@ -102,11 +150,68 @@ namespace Companion {
 					 */
 					cv::Rect lop;
 
+					/**
+					 * Constant velocity Kalman filter of the object center, state is (x, y, vx, vy).
+					 */
+					cv::KalmanFilter motion;
+
+					/**
+					 * Indicator if the motion model is initialized with a first measurement.
+					 */
+					bool motionInitialized;
+
+					/**
+					 * Predicted object center of the current frame.
+					 */
+					cv::Point2f predictedCenter;
+
+					/**
+					 * Scene of the last prediction, the motion model is not advanced again for this scene.
+					 */
+					std::weak_ptr<void> predictedScene;
+
+					/**
+					 * Scene of the last correction, the motion model is not corrected again for this scene.
+					 */
+					std::weak_ptr<void> correctedScene;
+
+					/**
+					 * Current search window.
+					 */
+					cv::Rect searchWindow;
+
+					/**
+					 * Current ring of the search.
+					 */
+					int ring;
+
+					/**
+					 * Start time of the search in the current frame.
+					 */
+					std::chrono::steady_clock::time_point searchStart;
+
 					/**
 					 * Default initial position if no object was recognized in the last frame.
 					 */
 					static constexpr int NO_OBJECT_RECOGNIZED = 0;
 
+					/**
+					 * Maximum count of rings to expand the search window.
+					 */
+					static constexpr int MAX_RINGS = 3;
+
+					/**
+					 * Growth of the search window size per ring relative to the last object position.
+					 */
+					static constexpr float RING_GROWTH = 0.5f;
+
+					/**
+					 * Calculate the search window around the predicted center for the current ring.
+					 * @param sceneSize Size of the scene image.
+					 * @return Search window clamped to the scene image.
+					 */
+					cv::Rect CalculateWindow(const cv::Size& sceneSize) const;
+
 				};
 			}
 		}
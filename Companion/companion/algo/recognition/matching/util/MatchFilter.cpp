@@ -0,0 +1,118 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MatchFilter.h"
+
+/**
+ * Per-thread buffers of the match filter, they grow to the largest match set and are reused for every frame.
+ */
+struct MatchFilterBuffer
+{
+	/**
+	 * Matches which passed the ratio test.
+	 */
+	std::vector<cv::DMatch> candidates;
+
+	/**
+	 * Candidate index of the best query for each train feature, used for the cross-check.
+	 */
+	std::vector<int> bestForTrain;
+};
+
+static thread_local MatchFilterBuffer matchFilterBuffer;
+
+void Companion::Algorithm::Recognition::Matching::MatchFilter::RatioTest(const std::vector<std::vector<cv::DMatch>>& matches,
+	std::vector<cv::DMatch>& good_matches,
+	float ratio,
+	size_t maxMatches,
+	bool crossCheck)
+{
+	std::vector<cv::DMatch>& candidates = matchFilterBuffer.candidates;
+	std::vector<int>& bestForTrain = matchFilterBuffer.bestForTrain;
+	int trainIdx;
+
+	candidates.clear();
+
+	for (size_t i = 0; i < matches.size(); ++i)
+	{
+		if (matches[i].size() < 2 || !(matches[i][0].distance < ratio * matches[i][1].distance))
+		{
+			continue;
+		}
+
+		const cv::DMatch& match = matches[i][0];
+		trainIdx = match.trainIdx;
+
+		if (!crossCheck)
+		{
+			candidates.push_back(match);
+			continue;
+		}
+
+		if (trainIdx < 0)
+		{
+			// Invalid train index (e.g. from flann), cannot be cross-checked
+			continue;
+		}
+
+		// Cross-check, a train feature keeps only its best query feature
+		if (static_cast<size_t>(trainIdx) >= bestForTrain.size())
+		{
+			bestForTrain.resize(trainIdx + 1, -1);
+		}
+
+		if (bestForTrain[trainIdx] < 0)
+		{
+			bestForTrain[trainIdx] = static_cast<int>(candidates.size());
+			candidates.push_back(match);
+		}
+		else if (IsBetter(match, candidates[bestForTrain[trainIdx]]))
+		{
+			candidates[bestForTrain[trainIdx]] = match;
+		}
+	}
+
+	if (crossCheck)
+	{
+		// Reset only the used entries so the buffer stays valid for the next call
+		for (size_t i = 0; i < candidates.size(); ++i)
+		{
+			bestForTrain[candidates[i].trainIdx] = -1;
+		}
+	}
+
+	SelectBest(candidates, maxMatches);
+	good_matches.insert(good_matches.end(), candidates.begin(), candidates.end());
+}
+
+void Companion::Algorithm::Recognition::Matching::MatchFilter::SelectBest(std::vector<cv::DMatch>& matches, size_t maxMatches)
+{
+	if (matches.size() > maxMatches)
+	{
+		// Linear selection of the best matches, only those are sorted
+		std::nth_element(matches.begin(), matches.begin() + maxMatches, matches.end(), IsBetter);
+		matches.resize(maxMatches);
+	}
+
+	std::sort(matches.begin(), matches.end(), IsBetter);
+}
+
+bool Companion::Algorithm::Recognition::Matching::MatchFilter::IsBetter(const cv::DMatch& first, const cv::DMatch& second)
+{
+	return first.distance < second.distance || (first.distance == second.distance && first.queryIdx < second.queryIdx);
+}
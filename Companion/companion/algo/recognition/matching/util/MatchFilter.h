@@ -0,0 +1,79 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_MATCHFILTER_H
+#define COMPANION_MATCHFILTER_H
+
+#include <algorithm>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Algorithm {
+		namespace Recognition {
+			namespace Matching
+			{
+				/**
+				 * Match filter stage which applies the ratio test, an optional cross-check and a bounded selection of the best
+				 * matches in one pass over the knn matches. Intermediate matches are stored in a preallocated per-thread buffer.
+				 * @author Andreas Sekulski, Dimitri Kotlovsky
+				 */
+				class COMP_EXPORTS MatchFilter
+				{
+
+				public:
+
+					/**
+					 * Ratio test implementation to obtain only good matches. <br>
+					 * Paper -> Neighborhoods comparison - <a href="http://www.cs.ubc.ca/~lowe/papers/ijcv04.pdf#page=20"> Paper </a>
+					 * @param matches Knn matches with at least two neighbors per query.
+					 * @param good_matches Vector to store the good matches sorted by distance.
+					 * @param ratio Ratio to determine which matches are good enough.
+					 * @param maxMatches Maximum count of good matches to keep.
+					 * @param crossCheck If <code>true</code> each train feature is used only by its best query feature.
+					 */
+					static void RatioTest(const std::vector<std::vector<cv::DMatch>>& matches,
+						std::vector<cv::DMatch>& good_matches,
+						float ratio,
+						size_t maxMatches,
+						bool crossCheck = false);
+
+					/**
+					 * Keep only the best matches sorted by distance.
+					 * @param matches Matches to select from.
+					 * @param maxMatches Maximum count of matches to keep.
+					 */
+					static void SelectBest(std::vector<cv::DMatch>& matches, size_t maxMatches);
+
+				private:
+
+					/**
+					 * Strict ordering by distance and query index, so the selection is deterministic for equal distances.
+					 * @param first First match.
+					 * @param second Second match.
+					 * @return <code>True</code> if first is better than second.
+					 */
+					static bool IsBetter(const cv::DMatch& first, const cv::DMatch& second);
+				};
+			}
+		}
+	}
+}
+
+#endif //COMPANION_MATCHFILTER_H
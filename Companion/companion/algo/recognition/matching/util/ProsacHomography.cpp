@@ -0,0 +1,297 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ProsacHomography.h"
+
+Companion::Algorithm::Recognition::Matching::ProsacHomography::ProsacHomography(double reprojThreshold,
+	int maxIters,
+	double confidence)
+{
+	this->reprojThreshold = reprojThreshold;
+	this->maxIters = maxIters;
+	this->confidence = confidence;
+	this->iterations = 0;
+}
+
+cv::Mat Companion::Algorithm::Recognition::Matching::ProsacHomography::Estimate(const std::vector<cv::Point2f>& objectPoints,
+	const std::vector<cv::Point2f>& scenePoints,
+	std::vector<uchar>& inlierMask)
+{
+	const int count = static_cast<int>(std::min(objectPoints.size(), scenePoints.size()));
+	std::vector<uchar> mask(count, 0);
+	std::vector<cv::Point2f> inliersObject, inliersScene;
+	double homography[9], bestHomography[9];
+	double growth, growthNext;
+	int sample[SAMPLE_SIZE];
+	int bestInliers = 0;
+	int inliers, subset, growthIteration, iterationLimit;
+	cv::RNG rng(0xFFFFFFFF);
+	cv::Mat refined;
+
+	inlierMask.assign(count, 0);
+	this->iterations = 0;
+
+	if (count < SAMPLE_SIZE)
+	{
+		return cv::Mat();
+	}
+
+	// Expected number of samples drawn from the first SAMPLE_SIZE correspondences (PROSAC growth function)
+	growth = this->maxIters;
+	for (int i = 0; i < SAMPLE_SIZE; i++)
+	{
+		growth *= static_cast<double>(SAMPLE_SIZE - i) / (count - i);
+	}
+	growthIteration = 1;
+	subset = SAMPLE_SIZE;
+	iterationLimit = this->maxIters;
+
+	while (this->iterations < iterationLimit)
+	{
+		this->iterations++;
+
+		// Grow the set of best correspondences to sample from
+		if (this->iterations == growthIteration && subset < count)
+		{
+			growthNext = growth * (subset + 1) / (subset + 1 - SAMPLE_SIZE);
+			growthIteration += static_cast<int>(std::ceil(growthNext - growth));
+			growth = growthNext;
+			subset++;
+		}
+
+		// Sample the newest correspondence and the rest from the better ones, or uniform if the set is complete
+		int start = 0;
+		if (growthIteration >= this->iterations)
+		{
+			sample[0] = subset - 1;
+			start = 1;
+		}
+		for (int i = start; i < SAMPLE_SIZE; i++)
+		{
+			bool unique;
+			do
+			{
+				sample[i] = rng.uniform(0, start == 1 ? subset - 1 : subset);
+				unique = true;
+				for (int j = 0; j < i; j++)
+				{
+					unique = unique && sample[j] != sample[i];
+				}
+			} while (!unique);
+		}
+
+		if (IsDegenerate(objectPoints, scenePoints, sample) || !MinimalSolve(objectPoints, scenePoints, sample, homography))
+		{
+			continue;
+		}
+
+		inliers = CountInliers(objectPoints, scenePoints, homography, mask);
+		if (inliers > bestInliers)
+		{
+			bestInliers = inliers;
+			std::copy(homography, homography + 9, bestHomography);
+			inlierMask = mask;
+
+			// Stop early if the confidence is reached with this inlier ratio
+			iterationLimit = std::min(this->maxIters, RequiredIterations(static_cast<double>(bestInliers) / count));
+		}
+	}
+
+	if (bestInliers < SAMPLE_SIZE)
+	{
+		inlierMask.assign(count, 0);
+		return cv::Mat();
+	}
+
+	// Least squares refinement on all inliers of the best model
+	for (int i = 0; i < count; i++)
+	{
+		if (inlierMask[i])
+		{
+			inliersObject.push_back(objectPoints[i]);
+			inliersScene.push_back(scenePoints[i]);
+		}
+	}
+
+	if (inliersObject.size() > SAMPLE_SIZE)
+	{
+		refined = cv::findHomography(inliersObject, inliersScene, 0);
+		if (!refined.empty() && refined.type() == CV_64F)
+		{
+			inliers = CountInliers(objectPoints, scenePoints, refined.ptr<double>(), mask);
+			if (inliers >= bestInliers)
+			{
+				inlierMask = mask;
+				return refined;
+			}
+		}
+	}
+
+	return cv::Mat(3, 3, CV_64F, bestHomography).clone();
+}
+
+int Companion::Algorithm::Recognition::Matching::ProsacHomography::Iterations() const
+{
+	return this->iterations;
+}
+
+bool Companion::Algorithm::Recognition::Matching::ProsacHomography::IsDegenerate(const std::vector<cv::Point2f>& objectPoints,
+	const std::vector<cv::Point2f>& scenePoints,
+	const int sample[SAMPLE_SIZE])
+{
+	static const int triangles[4][3] = { { 0, 1, 2 }, { 0, 1, 3 }, { 0, 2, 3 }, { 1, 2, 3 } };
+	int orientation = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		const cv::Point2f& a = objectPoints[sample[triangles[i][0]]];
+		const cv::Point2f& b = objectPoints[sample[triangles[i][1]]];
+		const cv::Point2f& c = objectPoints[sample[triangles[i][2]]];
+		const cv::Point2f& d = scenePoints[sample[triangles[i][0]]];
+		const cv::Point2f& e = scenePoints[sample[triangles[i][1]]];
+		const cv::Point2f& f = scenePoints[sample[triangles[i][2]]];
+
+		// Doubled signed triangle areas in object and scene
+		double objectArea = (b.x - a.x) * static_cast<double>(c.y - a.y) - (b.y - a.y) * static_cast<double>(c.x - a.x);
+		double sceneArea = (e.x - d.x) * static_cast<double>(f.y - d.y) - (e.y - d.y) * static_cast<double>(f.x - d.x);
+
+		// Collinear points
+		if (std::abs(objectArea) < 2.0 * MIN_TRIANGLE_AREA || std::abs(sceneArea) < 2.0 * MIN_TRIANGLE_AREA)
+		{
+			return true;
+		}
+
+		// A homography of a plane seen from the front keeps the orientation of all triangles the same
+		int sign = (objectArea > 0) == (sceneArea > 0) ? 1 : -1;
+		if (orientation != 0 && sign != orientation)
+		{
+			return true;
+		}
+		orientation = sign;
+	}
+
+	return false;
+}
+
+bool Companion::Algorithm::Recognition::Matching::ProsacHomography::MinimalSolve(const std::vector<cv::Point2f>& objectPoints,
+	const std::vector<cv::Point2f>& scenePoints,
+	const int sample[SAMPLE_SIZE],
+	double homography[9])
+{
+	double system[8][9];
+
+	for (int i = 0; i < SAMPLE_SIZE; i++)
+	{
+		double x = objectPoints[sample[i]].x, y = objectPoints[sample[i]].y;
+		double u = scenePoints[sample[i]].x, v = scenePoints[sample[i]].y;
+		double rowU[9] = { x, y, 1.0, 0.0, 0.0, 0.0, -u * x, -u * y, u };
+		double rowV[9] = { 0.0, 0.0, 0.0, x, y, 1.0, -v * x, -v * y, v };
+		std::copy(rowU, rowU + 9, system[2 * i]);
+		std::copy(rowV, rowV + 9, system[2 * i + 1]);
+	}
+
+	// Gaussian elimination with partial pivoting
+	for (int column = 0; column < 8; column++)
+	{
+		int pivot = column;
+		for (int row = column + 1; row < 8; row++)
+		{
+			if (std::abs(system[row][column]) > std::abs(system[pivot][column]))
+			{
+				pivot = row;
+			}
+		}
+
+		if (std::abs(system[pivot][column]) < 1e-10)
+		{
+			return false;
+		}
+
+		if (pivot != column)
+		{
+			std::swap_ranges(system[pivot], system[pivot] + 9, system[column]);
+		}
+
+		for (int row = column + 1; row < 8; row++)
+		{
+			double factor = system[row][column] / system[column][column];
+			for (int k = column; k < 9; k++)
+			{
+				system[row][k] -= factor * system[column][k];
+			}
+		}
+	}
+
+	for (int row = 7; row >= 0; row--)
+	{
+		double value = system[row][8];
+		for (int k = row + 1; k < 8; k++)
+		{
+			value -= system[row][k] * homography[k];
+		}
+		homography[row] = value / system[row][row];
+	}
+	homography[8] = 1.0;
+
+	return true;
+}
+
+int Companion::Algorithm::Recognition::Matching::ProsacHomography::CountInliers(const std::vector<cv::Point2f>& objectPoints,
+	const std::vector<cv::Point2f>& scenePoints,
+	const double homography[9],
+	std::vector<uchar>& inlierMask) const
+{
+	const double threshold = this->reprojThreshold * this->reprojThreshold;
+	int inliers = 0;
+
+	for (size_t i = 0; i < inlierMask.size(); i++)
+	{
+		double x = objectPoints[i].x, y = objectPoints[i].y;
+		double w = homography[6] * x + homography[7] * y + homography[8];
+		inlierMask[i] = 0;
+
+		if (std::abs(w) > std::numeric_limits<double>::epsilon())
+		{
+			double dx = (homography[0] * x + homography[1] * y + homography[2]) / w - scenePoints[i].x;
+			double dy = (homography[3] * x + homography[4] * y + homography[5]) / w - scenePoints[i].y;
+			if (dx * dx + dy * dy <= threshold)
+			{
+				inlierMask[i] = 1;
+				inliers++;
+			}
+		}
+	}
+
+	return inliers;
+}
+
+int Companion::Algorithm::Recognition::Matching::ProsacHomography::RequiredIterations(double inlierRatio) const
+{
+	double sampleInliers = std::pow(inlierRatio, SAMPLE_SIZE);
+
+	if (sampleInliers <= std::numeric_limits<double>::epsilon())
+	{
+		return this->maxIters;
+	}
+	if (sampleInliers >= 1.0)
+	{
+		return 1;
+	}
+
+	return static_cast<int>(std::ceil(std::log(1.0 - this->confidence) / std::log(1.0 - sampleInliers)));
+}
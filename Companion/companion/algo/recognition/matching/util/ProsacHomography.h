@@ -0,0 +1,165 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_PROSACHOMOGRAPHY_H
+#define COMPANION_PROSACHOMOGRAPHY_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <opencv2/calib3d.hpp>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Algorithm {
+		namespace Recognition {
+			namespace Matching
+			{
+				/**
+				 * Homography estimation with progressive sample consensus (PROSAC). Correspondences must be sorted by their
+				 * quality, like the distance sorted good matches of the ratio test. Samples are drawn from a growing set of the
+				 * best correspondences, degenerate samples are rejected before a model is computed and the search stops as soon
+				 * as the requested confidence is reached. The best model is refined by least squares on all its inliers.
+				 * @author Andreas Sekulski, Dimitri Kotlovsky
+				 */
+				class COMP_EXPORTS ProsacHomography
+				{
+
+				public:
+
+					/**
+					 * Method to select this estimator as homography method in feature matching, does not collide with the
+					 * OpenCV methods (0, LMEDS, RANSAC, RHO).
+					 */
+					static constexpr int PROSAC = 64;
+
+					/**
+					 * Constructor to create a PROSAC homography estimator.
+					 * @param reprojThreshold Maximum allowed reprojection error to treat a point pair as an inlier. Default is by 3.0.
+					 * @param maxIters Maximum number of iterations. Default is by 500.
+					 * @param confidence Confidence to stop the search early. Default is by 0.995.
+					 */
+					ProsacHomography(double reprojThreshold = 3.0, int maxIters = 500, double confidence = 0.995);
+
+					/**
+					 * Destructor.
+					 */
+					virtual ~ProsacHomography() = default;
+
+					/**
+					 * Estimate the homography from object points to scene points.
+					 * @param objectPoints Object points sorted by correspondence quality, best first.
+					 * @param scenePoints Corresponding scene points.
+					 * @param inlierMask Inlier mask of the estimated homography, one entry for each correspondence.
+					 * @return Homography as 3x3 CV_64F matrix or an empty matrix if no homography was found.
+					 */
+					cv::Mat Estimate(const std::vector<cv::Point2f>& objectPoints,
+						const std::vector<cv::Point2f>& scenePoints,
+						std::vector<uchar>& inlierMask);
+
+					/**
+					 * Get the number of iterations of the last estimation.
+					 * @return Number of iterations.
+					 */
+					int Iterations() const;
+
+				private:
+
+					/**
+					 * Size of a minimal sample for a homography.
+					 */
+					static constexpr int SAMPLE_SIZE = 4;
+
+					/**
+					 * Minimum area of a sample triangle, smaller triangles are treated as collinear.
+					 */
+					static constexpr double MIN_TRIANGLE_AREA = 1.0;
+
+					/**
+					 * Maximum allowed reprojection error to treat a point pair as an inlier.
+					 */
+					double reprojThreshold;
+
+					/**
+					 * Maximum number of iterations.
+					 */
+					int maxIters;
+
+					/**
+					 * Confidence to stop the search early.
+					 */
+					double confidence;
+
+					/**
+					 * Number of iterations of the last estimation.
+					 */
+					int iterations;
+
+					/**
+					 * Check if a sample is degenerate, which is the case if three points are collinear or the orientation of the
+					 * points is not preserved between object and scene.
+					 * @param objectPoints Object points.
+					 * @param scenePoints Scene points.
+					 * @param sample Sample indices.
+					 * @return <code>True</code> if the sample is degenerate.
+					 */
+					static bool IsDegenerate(const std::vector<cv::Point2f>& objectPoints,
+						const std::vector<cv::Point2f>& scenePoints,
+						const int sample[SAMPLE_SIZE]);
+
+					/**
+					 * Calculate the homography of a minimal sample by solving the 8x8 linear system with h33 = 1.
+					 * @param objectPoints Object points.
+					 * @param scenePoints Scene points.
+					 * @param sample Sample indices.
+					 * @param homography Homography with 9 elements in row major order.
+					 * @return <code>True</code> if the system could be solved.
+					 */
+					static bool MinimalSolve(const std::vector<cv::Point2f>& objectPoints,
+						const std::vector<cv::Point2f>& scenePoints,
+						const int sample[SAMPLE_SIZE],
+						double homography[9]);
+
+					/**
+					 * Count the inliers of a homography and fill the inlier mask.
+					 * @param objectPoints Object points.
+					 * @param scenePoints Scene points.
+					 * @param homography Homography with 9 elements in row major order.
+					 * @param inlierMask Inlier mask to fill.
+					 * @return Count of inliers.
+					 */
+					int CountInliers(const std::vector<cv::Point2f>& objectPoints,
+						const std::vector<cv::Point2f>& scenePoints,
+						const double homography[9],
+						std::vector<uchar>& inlierMask) const;
+
+					/**
+					 * Calculate the number of iterations which are needed to reach the confidence with the given inlier ratio.
+					 * @param inlierRatio Ratio of inliers.
+					 * @return Number of iterations.
+					 */
+					int RequiredIterations(double inlierRatio) const;
+				};
+			}
+		}
+	}
+}
+
+#endif //COMPANION_PROSACHOMOGRAPHY_H
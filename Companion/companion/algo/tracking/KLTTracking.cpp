@@ -0,0 +1,137 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KLTTracking.h"
+
+Companion::Algorithm::Tracking::KLTTracking::KLTTracking(int keyframeInterval,
+	double minQuality,
+	size_t minPoints,
+	int minSidelLength,
+	int windowSize,
+	int pyramidLevels,
+	double reprojThreshold)
+{
+	this->keyframeInterval = keyframeInterval;
+	this->minQuality = minQuality;
+	this->minPoints = std::max<size_t>(minPoints, 4);
+	this->minSidelLength = minSidelLength;
+	this->windowSize = cv::Size(windowSize, windowSize);
+	this->pyramidLevels = pyramidLevels;
+	this->reprojThreshold = reprojThreshold;
+}
+
+bool Companion::Algorithm::Tracking::KLTTracking::IsKeyframe(PTR_MODEL_FEATURE_MATCHING objectModel) const
+{
+	PTR_MODEL_TRACKING tracking = objectModel->Tracking();
+	return !tracking->IsTracking() || tracking->FramesSinceKeyframe() >= this->keyframeInterval;
+}
+
+void Companion::Algorithm::Tracking::KLTTracking::Start(const cv::Mat& frame, PTR_MODEL_FEATURE_MATCHING objectModel)
+{
+	objectModel->Tracking()->Start(frame);
+}
+
+void Companion::Algorithm::Tracking::KLTTracking::Stop(PTR_MODEL_FEATURE_MATCHING objectModel)
+{
+	objectModel->Tracking()->Clear();
+}
+
+PTR_DRAW_FRAME Companion::Algorithm::Tracking::KLTTracking::Track(const cv::Mat& frame, PTR_MODEL_FEATURE_MATCHING objectModel)
+{
+	PTR_MODEL_TRACKING tracking = objectModel->Tracking();
+	const cv::Mat& objectImage = objectModel->Image();
+	std::vector<cv::Point2f> trackedPoints, objectPoints, scenePoints;
+	std::vector<cv::Point2f> objectCorners(4), sceneCorners(4);
+	std::vector<uchar> status, inliers;
+	std::vector<float> errors;
+	cv::Mat homography;
+
+	if (!tracking->IsTracking() || frame.size() != tracking->Frame().size())
+	{
+		tracking->Clear();
+		return nullptr;
+	}
+
+	// Track the points of the last frame into the current frame
+	cv::calcOpticalFlowPyrLK(tracking->Frame(),
+		frame,
+		tracking->ScenePoints(),
+		trackedPoints,
+		status,
+		errors,
+		this->windowSize,
+		this->pyramidLevels);
+
+	for (size_t i = 0; i < status.size(); i++)
+	{
+		if (status[i] && trackedPoints[i].x >= 0 && trackedPoints[i].y >= 0 && trackedPoints[i].x < frame.cols && trackedPoints[i].y < frame.rows)
+		{
+			objectPoints.push_back(tracking->ObjectPoints()[i]);
+			scenePoints.push_back(trackedPoints[i]);
+		}
+	}
+
+	if (scenePoints.size() >= this->minPoints)
+	{
+		homography = cv::findHomography(objectPoints, scenePoints, cv::RANSAC, this->reprojThreshold, inliers);
+	}
+
+	if (homography.empty())
+	{
+		// Tracking lost
+		tracking->Clear();
+		return nullptr;
+	}
+
+	// Keep only tracked points which follow the homography
+	size_t count = 0;
+	for (size_t i = 0; i < inliers.size(); i++)
+	{
+		if (inliers[i])
+		{
+			objectPoints[count] = objectPoints[i];
+			scenePoints[count] = scenePoints[i];
+			count++;
+		}
+	}
+	objectPoints.resize(count);
+	scenePoints.resize(count);
+
+	// Tracking quality dropped, a new recognition is needed
+	if (count < this->minPoints || count < this->minQuality * tracking->KeyframePoints())
+	{
+		tracking->Clear();
+		return nullptr;
+	}
+
+	objectCorners[0] = cv::Point2f(0, 0);
+	objectCorners[1] = cv::Point2f(static_cast<float>(objectImage.cols), 0);
+	objectCorners[2] = cv::Point2f(static_cast<float>(objectImage.cols), static_cast<float>(objectImage.rows));
+	objectCorners[3] = cv::Point2f(0, static_cast<float>(objectImage.rows));
+	cv::perspectiveTransform(objectCorners, sceneCorners, homography);
+
+	if (!Companion::Util::ValidateShape(sceneCorners[1], sceneCorners[3], sceneCorners[0], sceneCorners[2], this->minSidelLength))
+	{
+		tracking->Clear();
+		return nullptr;
+	}
+
+	tracking->Update(frame, objectPoints, scenePoints);
+
+	return std::make_shared<DRAW_FRAME>(sceneCorners[0], sceneCorners[1], sceneCorners[3], sceneCorners[2]);
+}
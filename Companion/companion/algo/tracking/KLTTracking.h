@@ -0,0 +1,140 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_KLTTRACKING_H
+#define COMPANION_KLTTRACKING_H
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video/tracking.hpp>
+#include <opencv2/calib3d.hpp>
+#include <companion/model/processing/FeatureMatchingModel.h>
+#include <companion/draw/Frame.h>
+#include <companion/util/Util.h>
+#include <companion/util/Definitions.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Algorithm {
+		namespace Tracking
+		{
+			/**
+			 * Keyframe tracking with the pyramidal Lucas-Kanade optical flow. The homography inliers of a recognition are
+			 * tracked in the following frames and the object position is updated from the tracked homography, until the next
+			 * keyframe is due or the tracking quality drops.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS KLTTracking
+			{
+
+			public:
+
+				/**
+				 * Constructor to create a KLT tracking algorithm.
+				 * @param keyframeInterval Count of frames which are tracked until a full recognition is done. Default is by 10.
+				 * @param minQuality Minimum ratio of tracked inliers to keyframe inliers to keep tracking. Default is by 0.5.
+				 * @param minPoints Minimum count of tracked inliers to keep tracking. Default is by 10.
+				 * @param minSidelLength Minimum length of the tracked area's sides (in pixels). Default value is 10.
+				 * @param windowSize Search window size of the optical flow at each pyramid level. Default is by 21.
+				 * @param pyramidLevels Count of pyramid levels of the optical flow. Default is by 3.
+				 * @param reprojThreshold Maximum allowed reprojection error to treat a tracked point as an inlier. Default is by 3.0.
+				 */
+				KLTTracking(int keyframeInterval = 10,
+					double minQuality = 0.5,
+					size_t minPoints = 10,
+					int minSidelLength = 10,
+					int windowSize = 21,
+					int pyramidLevels = 3,
+					double reprojThreshold = 3.0);
+
+				/**
+				 * Destructor.
+				 */
+				virtual ~KLTTracking() = default;
+
+				/**
+				 * Check if the given object model needs a full recognition in the next frame.
+				 * @param objectModel Object model to check.
+				 * @return <code>True</code> if the object is not tracked or a keyframe is due, otherwise <code>false</code>.
+				 */
+				bool IsKeyframe(PTR_MODEL_FEATURE_MATCHING objectModel) const;
+
+				/**
+				 * Start tracking of an object model after it was recognized in the given frame.
+				 * @param frame Grayscale scene frame of the recognition.
+				 * @param objectModel Recognized object model with stored recognition inliers.
+				 */
+				void Start(const cv::Mat& frame, PTR_MODEL_FEATURE_MATCHING objectModel);
+
+				/**
+				 * Stop tracking of an object model.
+				 * @param objectModel Object model to stop tracking.
+				 */
+				void Stop(PTR_MODEL_FEATURE_MATCHING objectModel);
+
+				/**
+				 * Track an object model in the given frame.
+				 * @param frame Grayscale scene frame.
+				 * @param objectModel Tracked object model.
+				 * @return The tracked object area or nullptr if the tracking is lost.
+				 */
+				PTR_DRAW_FRAME Track(const cv::Mat& frame, PTR_MODEL_FEATURE_MATCHING objectModel);
+
+			private:
+
+				/**
+				 * Count of frames which are tracked until a full recognition is done.
+				 */
+				int keyframeInterval;
+
+				/**
+				 * Minimum ratio of tracked inliers to keyframe inliers to keep tracking.
+				 */
+				double minQuality;
+
+				/**
+				 * Minimum count of tracked inliers to keep tracking.
+				 */
+				size_t minPoints;
+
+				/**
+				 * Minimum length of the tracked area's sides (in pixels).
+				 */
+				int minSidelLength;
+
+				/**
+				 * Search window size of the optical flow at each pyramid level.
+				 */
+				cv::Size windowSize;
+
+				/**
+				 * Count of pyramid levels of the optical flow.
+				 */
+				int pyramidLevels;
+
+				/**
+				 * Maximum allowed reprojection error to treat a tracked point as an inlier.
+				 */
+				double reprojThreshold;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_KLTTRACKING_H
@@ -75,6 +75,11 @@ namespace Companion {
 			 */
 			bool AddImage(int width, int height, int type, uchar* data);
 
+			/**
+			 * Obtain images into a given frame and with their capture time like every stream.
+			 */
+			using Stream::ObtainImage;
+
 			/**
 			 * Obtain next image from open image stream.
 			 * @return An empty cv::Mat object if no image is obtained otherwise an cv::Mat entity from the obtained image.
@@ -19,6 +19,8 @@
 #ifndef COMPANION_STREAM_H
 #define COMPANION_STREAM_H
 
+#include <chrono>
+#include <opencv2/core/core.hpp>
 #include <companion/util/exportapi/ExportAPIDefinitions.h>
 
 namespace Companion {
@@ -39,6 +41,33 @@ namespace Companion {
 			 */
 			virtual cv::Mat ObtainImage() = 0;
 
+			/**
+			 * Obtain next image from open video stream into the given frame. Streams which decode images should reuse the
+			 * buffer of the given frame to avoid an allocation per image.
+			 * @param frame Frame to store the obtained image to, an empty cv::Mat if no image is obtained.
+			 * @return <code>True</code> if an image was obtained, <code>false</code> otherwise.
+			 */
+			virtual bool ObtainImage(cv::Mat& frame)
+			{
+				frame = this->ObtainImage();
+				return !frame.empty();
+			}
+
+			/**
+			 * Obtain next image from open video stream together with its capture time. Streams which know when an image
+			 * was captured, for example from a camera driver, should override this method. Default is the time the
+			 * image was obtained.
+			 * @param frame Frame to store the obtained image to, an empty cv::Mat if no image is obtained.
+			 * @param captured Capture time of the obtained image.
+			 * @return <code>True</code> if an image was obtained, <code>false</code> otherwise.
+			 */
+			virtual bool ObtainImage(cv::Mat& frame, std::chrono::steady_clock::time_point& captured)
+			{
+				bool obtained = this->ObtainImage(frame);
+				captured = std::chrono::steady_clock::now();
+				return obtained;
+			}
+
 			/**
 			 * Indicator if stream has finished.
 			 * @return True if video has finished otherwise false.
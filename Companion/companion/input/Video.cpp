@@ -67,6 +67,27 @@ cv::Mat Companion::Input::Video::ObtainImage()
 	return frame;
 }
 
+bool Companion::Input::Video::ObtainImage(cv::Mat& frame)
+{
+	if (!this->capture.isOpened() || this->finished)
+	{
+		this->finished = true;
+		frame.release();
+		return false;
+	}
+
+	// Decode into the given frame, its buffer is reused if size and type match
+	if (!this->capture.read(frame) || frame.empty())
+	{
+		// If no frame is obtained video is finished
+		this->finished = true;
+		frame.release();
+		return false;
+	}
+
+	return true;
+}
+
 bool Companion::Input::Video::IsFinished()
 {
 	return this->finished;
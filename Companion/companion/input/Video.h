@@ -56,12 +56,24 @@ namespace Companion {
 			 */
 			virtual ~Video() = default;
 
+			/**
+			 * Obtain images into a given frame and with their capture time like every stream.
+			 */
+			using Stream::ObtainImage;
+
 			/**
 			 * Obtain next image from open video stream.
 			 * @return An empty cv::Mat object if no image is obtained otherwise a cv::Mat entity from the obtained image.
 			 */
 			cv::Mat ObtainImage();
 
+			/**
+			 * Obtain next image from open video stream and decode it into the buffer of the given frame if possible.
+			 * @param frame Frame to store the obtained image to, an empty cv::Mat if no image is obtained.
+			 * @return <code>True</code> if an image was obtained, <code>false</code> otherwise.
+			 */
+			bool ObtainImage(cv::Mat& frame);
+
 			/**
 			 * Indicator if stream has finished.
 			 * @return True if video has finished otherwise false.
@@ -21,6 +21,9 @@
 Companion::Model::Processing::FeatureMatchingModel::FeatureMatchingModel()
 {
 	this->ira = std::make_shared<IMAGE_REDUCTION_ALGORITHM>();
+	this->tracking = std::make_shared<MODEL_TRACKING>();
+	this->features = nullptr;
+	this->matcher = nullptr;
 }
 
 Companion::Model::Processing::FeatureMatchingModel::~FeatureMatchingModel()
@@ -57,8 +60,14 @@ void Companion::Model::Processing::FeatureMatchingModel::CalculateKeyPointsAndDe
 	// Generates problems with detect and compute because image is not an mat object it is an gpu::mat
 	this->keypoints.clear();
 	this->descriptors.empty();
+	this->matcher = nullptr; // Index of old descriptors is invalid
+	Companion::Thread::StageTimer detectTimer(TimingStage::DETECT, this->ID());
 	detector->detect(this->image, this->keypoints);
+	detectTimer.Stop();
+
+	Companion::Thread::StageTimer extractTimer(TimingStage::EXTRACT, this->ID());
 	extractor->compute(this->image, this->keypoints, this->descriptors);
+	extractTimer.Stop();
 }
 
 bool Companion::Model::Processing::FeatureMatchingModel::KeypointsCalculated()
@@ -76,16 +85,67 @@ void Companion::Model::Processing::FeatureMatchingModel::Image(const cv::Mat& im
 	this->image = image;
 }
 
+cv::Ptr<cv::DescriptorMatcher> Companion::Model::Processing::FeatureMatchingModel::Matcher() const
+{
+	return this->matcher;
+}
+
+void Companion::Model::Processing::FeatureMatchingModel::Matcher(cv::Ptr<cv::DescriptorMatcher> matcher)
+{
+	this->matcher = matcher;
+}
+
+PTR_SCENE_FEATURES Companion::Model::Processing::FeatureMatchingModel::Features() const
+{
+	return this->features;
+}
+
+void Companion::Model::Processing::FeatureMatchingModel::Features(PTR_SCENE_FEATURES features)
+{
+	this->features = features;
+}
+
 PTR_IMAGE_REDUCTION_ALGORITHM Companion::Model::Processing::FeatureMatchingModel::Ira() const
 {
 	return this->ira;
 }
 
+const cv::Mat& Companion::Model::Processing::FeatureMatchingModel::Homography() const
+{
+	return this->homography;
+}
+
+void Companion::Model::Processing::FeatureMatchingModel::Homography(const cv::Mat& homography)
+{
+	this->homography = homography;
+}
+
+PTR_MODEL_TRACKING Companion::Model::Processing::FeatureMatchingModel::Tracking() const
+{
+	return this->tracking;
+}
+
+std::mutex& Companion::Model::Processing::FeatureMatchingModel::Mutex()
+{
+	return this->mx;
+}
+
 void Companion::Model::Processing::FeatureMatchingModel::ID(int id)
 {
 	this->id = id;
 }
 
+PTR_MODEL_FEATURE_MATCHING Companion::Model::Processing::FeatureMatchingModel::Share() const
+{
+	PTR_MODEL_FEATURE_MATCHING model = std::make_shared<MODEL_FEATURE_MATCHING>();
+	model->image = this->image;
+	model->keypoints = this->keypoints;
+	model->descriptors = this->descriptors;
+	model->matcher = this->matcher;
+	model->id = this->id;
+	return model;
+}
+
 const int Companion::Model::Processing::FeatureMatchingModel::ID() const
 {
 	return this->id;
@@ -19,9 +19,13 @@
 #ifndef COMPANION_FEATUREMATCHINGMODEL_H
 #define COMPANION_FEATUREMATCHINGMODEL_H
 
+#include <mutex>
 #include <opencv2/core/core.hpp>
 #include <opencv2/features2d.hpp>
 #include <companion/algo/recognition/matching/util/IRA.h>
+#include <companion/model/processing/SceneFeatures.h>
+#include <companion/model/processing/TrackingModel.h>
+#include <companion/thread/StageTimer.h>
 #include <companion/util/Definitions.h>
 
 namespace Companion {
@@ -98,12 +102,69 @@ namespace Companion {
 				 */
 				void Image(const cv::Mat& image);
 
+				/**
+				 * Get the trained matcher index which contains the descriptors of this model.
+				 * @return Trained matcher index or nullptr if no index is built.
+				 */
+				cv::Ptr<cv::DescriptorMatcher> Matcher() const;
+
+				/**
+				 * Set the trained matcher index which contains the descriptors of this model.
+				 * @param matcher Trained matcher index to set.
+				 */
+				void Matcher(cv::Ptr<cv::DescriptorMatcher> matcher);
+
+				/**
+				 * Get the cached scene features if this model represents a scene.
+				 * @return Cached scene features or nullptr if they are not calculated.
+				 */
+				PTR_SCENE_FEATURES Features() const;
+
+				/**
+				 * Set the cached scene features which are shared read-only by all object models of a frame.
+				 * @param features Scene features to set.
+				 */
+				void Features(PTR_SCENE_FEATURES features);
+
 				/**
 				 * Get IRA class to store last recognized object's location.
 				 * @return IRA class to obtain informations about last recognized object' location.
 				 */
 				PTR_IMAGE_REDUCTION_ALGORITHM Ira() const;
 
+				/**
+				 * Get the homography of the last recognition in full scene coordinates.
+				 * @return Homography from object to scene or an empty cv::Mat if the object was not recognized in the last frame.
+				 */
+				const cv::Mat& Homography() const;
+
+				/**
+				 * Set the homography of the last recognition in full scene coordinates.
+				 * @param homography Homography from object to scene, an empty cv::Mat clears the cached homography.
+				 */
+				void Homography(const cv::Mat& homography);
+
+				/**
+				 * Get the tracking state of this model.
+				 * @return Tracking state of this model.
+				 */
+				PTR_MODEL_TRACKING Tracking() const;
+
+				/**
+				 * Get the mutex which guards the state this model keeps between frames (IRA, tracking and cached homography).
+				 * Must be locked while a frame is processed against this model if frames are processed concurrently.
+				 * @return Mutex of this model.
+				 */
+				std::mutex& Mutex();
+
+				/**
+				 * Create a model which shares image, keypoints, descriptors and matcher index with this model but keeps its
+				 * own state between frames (IRA, tracking and cached homography). Shared models of the same model can match
+				 * different images concurrently without locking.
+				 * @return Shared model with the ID of this model.
+				 */
+				PTR_MODEL_FEATURE_MATCHING Share() const;
+
 				/**
 				 * Set the ID for this model.
 				 * @param id ID to set.
@@ -138,11 +199,36 @@ namespace Companion {
 				 */
 				cv::Mat image;
 
+				/**
+				 * Persistent matcher index trained with the descriptors of this model.
+				 */
+				cv::Ptr<cv::DescriptorMatcher> matcher;
+
+				/**
+				 * Cached scene features, only set if this model represents a scene.
+				 */
+				PTR_SCENE_FEATURES features;
+
 				/**
 				 * Image reduction algorithm to store last recognized object's location.
 				 */
 				PTR_IMAGE_REDUCTION_ALGORITHM ira;
 
+				/**
+				 * Homography of the last recognition in full scene coordinates.
+				 */
+				cv::Mat homography;
+
+				/**
+				 * Tracking state of this model between two recognitions.
+				 */
+				PTR_MODEL_TRACKING tracking;
+
+				/**
+				 * Mutex to serialize concurrent frames which update the state of this model.
+				 */
+				std::mutex mx;
+
 			};
 		}
 	}
@@ -0,0 +1,196 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameState.h"
+
+Companion::Model::Processing::FrameState::FrameState(cv::Mat frame, unsigned long sequence)
+{
+	this->frame = frame;
+	this->sequence = sequence;
+	this->stream = 0;
+	this->captured = std::chrono::steady_clock::now();
+	this->deadline = std::chrono::milliseconds(0);
+	this->partial = false;
+	this->stats = nullptr;
+	this->originalWidth = frame.cols;
+	this->originalHeight = frame.rows;
+	this->scene = nullptr;
+}
+
+unsigned long Companion::Model::Processing::FrameState::Sequence() const
+{
+	return this->sequence;
+}
+
+int Companion::Model::Processing::FrameState::Stream() const
+{
+	return this->stream;
+}
+
+void Companion::Model::Processing::FrameState::Stream(int stream)
+{
+	this->stream = stream;
+}
+
+std::chrono::steady_clock::time_point Companion::Model::Processing::FrameState::Captured() const
+{
+	return this->captured;
+}
+
+void Companion::Model::Processing::FrameState::Captured(std::chrono::steady_clock::time_point captured)
+{
+	this->captured = captured;
+}
+
+void Companion::Model::Processing::FrameState::Deadline(std::chrono::milliseconds deadline)
+{
+	this->deadline = deadline;
+}
+
+bool Companion::Model::Processing::FrameState::Expired() const
+{
+	return this->deadline.count() > 0 && std::chrono::steady_clock::now() > this->captured + this->deadline;
+}
+
+bool Companion::Model::Processing::FrameState::Partial() const
+{
+	return this->partial;
+}
+
+void Companion::Model::Processing::FrameState::Partial(bool partial)
+{
+	this->partial = partial;
+	for (size_t i = 0; i < this->results.size(); i++)
+	{
+		this->results[i]->Partial(partial);
+	}
+}
+
+PTR_FRAME_STATS Companion::Model::Processing::FrameState::Stats() const
+{
+	return this->stats;
+}
+
+void Companion::Model::Processing::FrameState::Stats(PTR_FRAME_STATS stats)
+{
+	this->stats = stats;
+}
+
+const cv::Mat& Companion::Model::Processing::FrameState::Frame() const
+{
+	return this->frame;
+}
+
+void Companion::Model::Processing::FrameState::Frame(const cv::Mat& frame)
+{
+	this->frame = frame;
+}
+
+int Companion::Model::Processing::FrameState::OriginalWidth() const
+{
+	return this->originalWidth;
+}
+
+int Companion::Model::Processing::FrameState::OriginalHeight() const
+{
+	return this->originalHeight;
+}
+
+const cv::Mat& Companion::Model::Processing::FrameState::Source() const
+{
+	return this->source;
+}
+
+void Companion::Model::Processing::FrameState::Source(const cv::Mat& source)
+{
+	this->source = source;
+}
+
+const cv::Mat& Companion::Model::Processing::FrameState::Gray() const
+{
+	return this->gray;
+}
+
+void Companion::Model::Processing::FrameState::Gray(const cv::Mat& gray)
+{
+	this->gray = gray;
+}
+
+PTR_MODEL_FEATURE_MATCHING Companion::Model::Processing::FrameState::Scene() const
+{
+	return this->scene;
+}
+
+void Companion::Model::Processing::FrameState::Scene(PTR_MODEL_FEATURE_MATCHING scene)
+{
+	this->scene = scene;
+}
+
+const std::vector<PTR_MODEL_FEATURE_MATCHING>& Companion::Model::Processing::FrameState::Models() const
+{
+	return this->models;
+}
+
+void Companion::Model::Processing::FrameState::Models(const std::vector<PTR_MODEL_FEATURE_MATCHING>& models)
+{
+	this->models = models;
+}
+
+PTR_CATALOG_INDEX Companion::Model::Processing::FrameState::Catalog() const
+{
+	return this->catalog;
+}
+
+void Companion::Model::Processing::FrameState::Catalog(PTR_CATALOG_INDEX catalog)
+{
+	this->catalog = catalog;
+}
+
+const std::vector<PTR_DRAW_FRAME>& Companion::Model::Processing::FrameState::Rois() const
+{
+	return this->rois;
+}
+
+void Companion::Model::Processing::FrameState::Rois(const std::vector<PTR_DRAW_FRAME>& rois)
+{
+	this->rois = rois;
+}
+
+const CALLBACK_RESULT& Companion::Model::Processing::FrameState::Results() const
+{
+	return this->results;
+}
+
+void Companion::Model::Processing::FrameState::AddResult(PTR_RESULT result)
+{
+	if (this->partial)
+	{
+		result->Partial(true);
+	}
+	this->results.push_back(result);
+}
+
+const std::vector<Companion::Error::Code>& Companion::Model::Processing::FrameState::Errors() const
+{
+	return this->errors;
+}
+
+void Companion::Model::Processing::FrameState::AddError(Companion::Error::Code error)
+{
+	this->errors.push_back(error);
+}
@@ -0,0 +1,335 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_FRAMESTATE_H
+#define COMPANION_FRAMESTATE_H
+
+#include <chrono>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <companion/draw/Frame.h>
+#include <companion/model/result/Result.h>
+#include <companion/model/processing/FeatureMatchingModel.h>
+#include <companion/algo/recognition/matching/util/CatalogIndex.h>
+#include <companion/model/stream/FrameStats.h>
+#include <companion/util/CompanionError.h>
+#include <companion/util/Definitions.h>
+
+namespace Companion {
+	namespace Model {
+		namespace Processing
+		{
+			/**
+			 * Intermediate state of a frame which is passed from one image processing stage to the next.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS FrameState
+			{
+
+			public:
+
+				/**
+				 * Create the state of a frame which enters the first stage.
+				 * @param frame Source image of the frame.
+				 * @param sequence Sequence number of the frame.
+				 */
+				FrameState(cv::Mat frame, unsigned long sequence = 0);
+
+				/**
+				 * Destructor.
+				 */
+				virtual ~FrameState() = default;
+
+				/**
+				 * Get sequence number of this frame.
+				 * @return Sequence number of this frame.
+				 */
+				unsigned long Sequence() const;
+
+				/**
+				 * Get ID of the stream this frame was obtained from.
+				 * @return Stream ID, default is 0.
+				 */
+				int Stream() const;
+
+				/**
+				 * Set ID of the stream this frame was obtained from.
+				 * @param stream Stream ID.
+				 */
+				void Stream(int stream);
+
+				/**
+				 * Get capture time of this frame.
+				 * @return Capture time, default is the time this state was created.
+				 */
+				std::chrono::steady_clock::time_point Captured() const;
+
+				/**
+				 * Set capture time of this frame.
+				 * @param captured Capture time obtained from the stream.
+				 */
+				void Captured(std::chrono::steady_clock::time_point captured);
+
+				/**
+				 * Set latency deadline of this frame, results which are not ready in time are useless.
+				 * @param deadline Latency deadline relative to the capture time, zero disables the deadline.
+				 */
+				void Deadline(std::chrono::milliseconds deadline);
+
+				/**
+				 * Check if the deadline of this frame has passed.
+				 * @return <code>True</code> if a deadline is set and has passed.
+				 */
+				bool Expired() const;
+
+				/**
+				 * Check if the processing of this frame was cut short by its deadline.
+				 * @return <code>True</code> if the results of this frame are incomplete.
+				 */
+				bool Partial() const;
+
+				/**
+				 * Mark the results of this frame as incomplete, all results added before and after are marked.
+				 * @param partial <code>True</code> if the results of this frame are incomplete.
+				 */
+				void Partial(bool partial);
+
+				/**
+				 * Get processing times of this frame.
+				 * @return Frame stats or nullptr if stats are not recorded.
+				 */
+				PTR_FRAME_STATS Stats() const;
+
+				/**
+				 * Set processing times of this frame, steps are recorded while the stats are bound to a thread.
+				 * @param stats Frame stats to record to, nullptr to record no stats.
+				 */
+				void Stats(PTR_FRAME_STATS stats);
+
+				/**
+				 * Get the working image of this frame, for example the resized source image.
+				 * @return Working image of this frame.
+				 */
+				const cv::Mat& Frame() const;
+
+				/**
+				 * Set the working image of this frame.
+				 * @param frame Working image to set.
+				 */
+				void Frame(const cv::Mat& frame);
+
+				/**
+				 * Get width of the source image.
+				 * @return Width of the source image.
+				 */
+				int OriginalWidth() const;
+
+				/**
+				 * Get height of the source image.
+				 * @return Height of the source image.
+				 */
+				int OriginalHeight() const;
+
+				/**
+				 * Get the image which is returned to the result callback.
+				 * @return Image for the result callback, empty if not set.
+				 */
+				const cv::Mat& Source() const;
+
+				/**
+				 * Set the image which is returned to the result callback.
+				 * @param source Image for the result callback.
+				 */
+				void Source(const cv::Mat& source);
+
+				/**
+				 * Get gray scale image of the working image if calculated.
+				 * @return Gray scale image or an empty cv::Mat.
+				 */
+				const cv::Mat& Gray() const;
+
+				/**
+				 * Set gray scale image of the working image.
+				 * @param gray Gray scale image to set.
+				 */
+				void Gray(const cv::Mat& gray);
+
+				/**
+				 * Get the scene model which caches the scene features of this frame.
+				 * @return Scene model or nullptr if not set.
+				 */
+				PTR_MODEL_FEATURE_MATCHING Scene() const;
+
+				/**
+				 * Set the scene model which caches the scene features of this frame.
+				 * @param scene Scene model to set.
+				 */
+				void Scene(PTR_MODEL_FEATURE_MATCHING scene);
+
+				/**
+				 * Get the models which are still searched for in this frame.
+				 * @return Models which are still searched for.
+				 */
+				const std::vector<PTR_MODEL_FEATURE_MATCHING>& Models() const;
+
+				/**
+				 * Set the models which are still searched for in this frame.
+				 * @param models Models which are still searched for.
+				 */
+				void Models(const std::vector<PTR_MODEL_FEATURE_MATCHING>& models);
+
+				/**
+				 * Get the catalog index this frame is voted on.
+				 * @return Catalog index which is never rebuilt, or nullptr if not set.
+				 */
+				PTR_CATALOG_INDEX Catalog() const;
+
+				/**
+				 * Set the catalog index this frame is voted on, the models of this frame must be the models of the index.
+				 * @param catalog Catalog index which is never rebuilt.
+				 */
+				void Catalog(PTR_CATALOG_INDEX catalog);
+
+				/**
+				 * Get the regions of interest of this frame.
+				 * @return Regions of interest, empty if the whole frame is searched.
+				 */
+				const std::vector<PTR_DRAW_FRAME>& Rois() const;
+
+				/**
+				 * Set the regions of interest of this frame.
+				 * @param rois Regions of interest to set.
+				 */
+				void Rois(const std::vector<PTR_DRAW_FRAME>& rois);
+
+				/**
+				 * Get all results of this frame.
+				 * @return Results of this frame.
+				 */
+				const CALLBACK_RESULT& Results() const;
+
+				/**
+				 * Add a result to this frame.
+				 * @param result Result to add.
+				 */
+				void AddResult(PTR_RESULT result);
+
+				/**
+				 * Get all errors of this frame.
+				 * @return Errors which occurred while processing this frame.
+				 */
+				const std::vector<Companion::Error::Code>& Errors() const;
+
+				/**
+				 * Add an error to this frame, following stages are not executed for a frame with errors.
+				 * @param error Error to add.
+				 */
+				void AddError(Companion::Error::Code error);
+
+			private:
+
+				/**
+				 * Sequence number of this frame.
+				 */
+				unsigned long sequence;
+
+				/**
+				 * ID of the stream this frame was obtained from.
+				 */
+				int stream;
+
+				/**
+				 * Capture time of this frame.
+				 */
+				std::chrono::steady_clock::time_point captured;
+
+				/**
+				 * Latency deadline relative to the capture time, zero if no deadline is set.
+				 */
+				std::chrono::milliseconds deadline;
+
+				/**
+				 * Indicator if the results of this frame are incomplete.
+				 */
+				bool partial;
+
+				/**
+				 * Processing times of this frame.
+				 */
+				PTR_FRAME_STATS stats;
+
+				/**
+				 * Working image of this frame.
+				 */
+				cv::Mat frame;
+
+				/**
+				 * Width of the source image.
+				 */
+				int originalWidth;
+
+				/**
+				 * Height of the source image.
+				 */
+				int originalHeight;
+
+				/**
+				 * Image which is returned to the result callback.
+				 */
+				cv::Mat source;
+
+				/**
+				 * Gray scale image of the working image.
+				 */
+				cv::Mat gray;
+
+				/**
+				 * Scene model of this frame.
+				 */
+				PTR_MODEL_FEATURE_MATCHING scene;
+
+				/**
+				 * Models which are still searched for.
+				 */
+				std::vector<PTR_MODEL_FEATURE_MATCHING> models;
+
+				/**
+				 * Catalog index of this frame.
+				 */
+				PTR_CATALOG_INDEX catalog;
+
+				/**
+				 * Regions of interest of this frame.
+				 */
+				std::vector<PTR_DRAW_FRAME> rois;
+
+				/**
+				 * Results of this frame.
+				 */
+				CALLBACK_RESULT results;
+
+				/**
+				 * Errors of this frame.
+				 */
+				std::vector<Companion::Error::Code> errors;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_FRAMESTATE_H
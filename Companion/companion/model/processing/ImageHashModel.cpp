@@ -25,66 +25,66 @@ Companion::Model::Processing::ImageHashModel::ImageHashModel()
 
 void Companion::Model::Processing::ImageHashModel::AddDescriptor(int id, cv::Mat& descriptor)
 {
+	std::lock_guard<std::mutex> lk(this->mx);
 	this->imageDataset.push_back(descriptor);
 	// Store this id for a scoring
 	this->scores.push_back({ id, 0.0f });
 	this->newModelAdded = true;
 }
 
-std::pair<cv::Mat_<float>, cv::Mat> Companion::Model::Processing::ImageHashModel::GenerateDataset()
+PTR_IMAGE_HASH_DATASET Companion::Model::Processing::ImageHashModel::GenerateDataset()
 {
-	std::pair<cv::Mat_<float>, cv::Mat> dataset;
-	dataset.first = GenerateHashImages();
-	dataset.second = GenerateIndexDataset(dataset.first);
-	this->newModelAdded = false;
-	return dataset;
+	std::lock_guard<std::mutex> lk(this->mx);
+	if (this->newModelAdded || this->dataset == nullptr)
+	{
+		// Generate a new dataset instead of updating the current one, frames may still read it
+		std::shared_ptr<IMAGE_HASH_DATASET> dataset = std::make_shared<IMAGE_HASH_DATASET>();
+		dataset->hash = GenerateHashImages();
+		dataset->index = GenerateIndexDataset(dataset->hash);
+		dataset->scores = this->scores;
+		this->dataset = dataset;
+		this->newModelAdded = false;
+	}
+
+	return this->dataset;
 }
 
 cv::Mat_<float> Companion::Model::Processing::ImageHashModel::GenerateHashImages()
 {
-	if (this->newModelAdded)
-	{
-		cv::Mat_<float> hash(this->imageDataset.cols, 100.0f);
-		std::default_random_engine gen;
-		std::normal_distribution<float> dist(0, 1);
+	cv::Mat_<float> hash(this->imageDataset.cols, 100.0f);
+	std::default_random_engine gen;
+	std::normal_distribution<float> dist(0, 1);
 
-		for (int i = 0; i < hash.rows; i++)
+	for (int i = 0; i < hash.rows; i++)
+	{
+		for (int j = 0; j < hash.cols; j++)
 		{
-			for (int j = 0; j < hash.cols; j++)
-			{
-				hash.at<float>(i, j) = dist(gen);
-			}
+			hash.at<float>(i, j) = dist(gen);
 		}
-
-		this->hash = hash;
 	}
 
-	return this->hash;
+	return hash;
 }
 
 cv::Mat Companion::Model::Processing::ImageHashModel::GenerateIndexDataset(cv::Mat_<float> hash)
 {
-	if (this->newModelAdded)
-	{
-		cv::Mat images = this->imageDataset * hash;
+	cv::Mat images = this->imageDataset * hash;
 
-		for (size_t i = 0; i < images.rows; i++)
+	for (size_t i = 0; i < images.rows; i++)
+	{
+		for (size_t j = 0; j < images.cols; j++)
 		{
-			for (size_t j = 0; j < images.cols; j++)
-			{
-				images.at<float>(i, j) = images.at<float>(i, j) > 0 ? 1 : 0;
-			}
+			images.at<float>(i, j) = images.at<float>(i, j) > 0 ? 1 : 0;
 		}
-
-		images.convertTo(images, CV_8U);
-
-		this->indexDataset = images;
 	}
 
-	return this->indexDataset;
+	images.convertTo(images, CV_8U);
+
+	return images;
 }
 
-const std::vector<std::pair<int, float>>& Companion::Model::Processing::ImageHashModel::Scores() const
+std::vector<std::pair<int, float>> Companion::Model::Processing::ImageHashModel::Scores() const
 {
+	std::lock_guard<std::mutex> lk(this->mx);
 	return this->scores;
 }
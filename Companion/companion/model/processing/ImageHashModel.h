@@ -22,6 +22,8 @@
 #include <vector>
 #include <string>
 #include <random>
+#include <mutex>
+#include <memory>
 #include <opencv2/core.hpp>
 #include <opencv2/opencv.hpp>
 #include <companion/util/Definitions.h>
@@ -40,6 +42,27 @@ namespace Companion {
 
 			public:
 
+				/**
+				 * Immutable hash dataset of all models which were added when it was generated.
+				 */
+				struct Dataset
+				{
+					/**
+					 * Hash values from all models.
+					 */
+					cv::Mat_<float> hash;
+
+					/**
+					 * Index dataset from all models.
+					 */
+					cv::Mat index;
+
+					/**
+					 * Scores from all models in the order of the index dataset.
+					 */
+					std::vector<std::pair<int, float>> scores;
+				};
+
 				/**
 				 * Constructor.
 				 */
@@ -58,16 +81,17 @@ namespace Companion {
 				void AddDescriptor(int id, cv::Mat& descriptor);
 
 				/**
-				 * Generate dataset from current image hash model.
-				 * @return Generated dataset that contains as first element the hashed images and as second element the index dataset.
+				 * Generate dataset from current image hash model. The dataset is generated once after models were added,
+				 * the returned dataset is never modified and can be read by multiple threads.
+				 * @return Generated dataset that contains the hashed images, the index dataset and the scores.
 				 */
-				std::pair<cv::Mat_<float>, cv::Mat> GenerateDataset();
+				PTR_IMAGE_HASH_DATASET GenerateDataset();
 
 				/**
 				 * Return the result scores.
 				 * @return Result scores.
 				 */
-				const std::vector<std::pair<int, float>>& Scores() const;
+				std::vector<std::pair<int, float>> Scores() const;
 
 			private:
 
@@ -82,19 +106,19 @@ namespace Companion {
 				cv::Mat imageDataset;
 
 				/**
-				 * Hash values to store from all models.
+				 * Dataset generated from all models, replaced if models are added.
 				 */
-				cv::Mat_<float> hash;
+				PTR_IMAGE_HASH_DATASET dataset;
 
 				/**
-				 * Index dataset from all models.
+				 * Scores from all given models.
 				 */
-				cv::Mat indexDataset;
+				std::vector<std::pair<int, float>> scores;
 
 				/**
-				 * Scores from all given models.
+				 * Mutex to guard the models and the generated dataset.
 				 */
-				std::vector<std::pair<int, float>> scores;
+				mutable std::mutex mx;
 
 				/**
 				 * Generate hash values from all image descriptors.
@@ -0,0 +1,106 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "KeypointGrid.h"
+
+Companion::Model::Processing::KeypointGrid::KeypointGrid()
+{
+	this->cellSize = 1;
+	this->columns = 0;
+	this->rows = 0;
+}
+
+Companion::Model::Processing::KeypointGrid::KeypointGrid(const std::vector<cv::KeyPoint>& keypoints,
+	const cv::Size& imageSize,
+	int cellSize)
+{
+	std::vector<int> cells(keypoints.size());
+	std::vector<int> position;
+	int column, row;
+
+	this->cellSize = std::max(cellSize, 1);
+	this->columns = std::max((imageSize.width + this->cellSize - 1) / this->cellSize, 1);
+	this->rows = std::max((imageSize.height + this->cellSize - 1) / this->cellSize, 1);
+	this->cellStart.assign(this->columns * this->rows + 1, 0);
+	this->indices.resize(keypoints.size());
+
+	// Count keypoints per cell
+	for (size_t i = 0; i < keypoints.size(); i++)
+	{
+		column = std::min(std::max(static_cast<int>(keypoints[i].pt.x) / this->cellSize, 0), this->columns - 1);
+		row = std::min(std::max(static_cast<int>(keypoints[i].pt.y) / this->cellSize, 0), this->rows - 1);
+		cells[i] = row * this->columns + column;
+		this->cellStart[cells[i] + 1]++;
+	}
+
+	for (size_t cell = 1; cell < this->cellStart.size(); cell++)
+	{
+		this->cellStart[cell] += this->cellStart[cell - 1];
+	}
+
+	// Store keypoint indices cell by cell, ascending within a cell
+	position.assign(this->cellStart.begin(), this->cellStart.end() - 1);
+	for (size_t i = 0; i < keypoints.size(); i++)
+	{
+		this->indices[position[cells[i]]++] = static_cast<int>(i);
+	}
+}
+
+void Companion::Model::Processing::KeypointGrid::Query(const cv::Rect& rect,
+	const std::vector<cv::KeyPoint>& keypoints,
+	std::vector<int>& indices) const
+{
+	int firstColumn, lastColumn, firstRow, lastRow;
+	bool inner;
+
+	indices.clear();
+
+	if (rect.area() <= 0 || this->columns == 0)
+	{
+		return;
+	}
+
+	firstColumn = std::max(rect.x / this->cellSize, 0);
+	lastColumn = std::min((rect.x + rect.width - 1) / this->cellSize, this->columns - 1);
+	firstRow = std::max(rect.y / this->cellSize, 0);
+	lastRow = std::min((rect.y + rect.height - 1) / this->cellSize, this->rows - 1);
+
+	for (int row = firstRow; row <= lastRow; row++)
+	{
+		for (int column = firstColumn; column <= lastColumn; column++)
+		{
+			int cell = row * this->columns + column;
+
+			// Cells completely inside the rectangle need no point test
+			inner = column * this->cellSize >= rect.x && (column + 1) * this->cellSize <= rect.x + rect.width
+				&& row * this->cellSize >= rect.y && (row + 1) * this->cellSize <= rect.y + rect.height;
+
+			for (int i = this->cellStart[cell]; i < this->cellStart[cell + 1]; i++)
+			{
+				const cv::Point2f& point = keypoints[this->indices[i]].pt;
+				if (inner || (point.x >= rect.x && point.y >= rect.y && point.x < rect.x + rect.width && point.y < rect.y + rect.height))
+				{
+					indices.push_back(this->indices[i]);
+				}
+			}
+		}
+	}
+
+	// Keep the order of the keypoints
+	std::sort(indices.begin(), indices.end());
+}
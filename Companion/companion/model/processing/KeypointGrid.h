@@ -0,0 +1,98 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_KEYPOINTGRID_H
+#define COMPANION_KEYPOINTGRID_H
+
+#include <algorithm>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Model {
+		namespace Processing
+		{
+			/**
+			 * Uniform grid bucket index over keypoints to obtain all keypoints inside a rectangle by visiting only the
+			 * overlapped cells. Keypoint indices are stored cell by cell in one contiguous array.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS KeypointGrid
+			{
+
+			public:
+
+				/**
+				 * Default constructor to create an empty grid.
+				 */
+				KeypointGrid();
+
+				/**
+				 * Constructor to build the grid over the given keypoints.
+				 * @param keypoints Keypoints to index.
+				 * @param imageSize Size of the image the keypoints belong to.
+				 * @param cellSize Side length of a grid cell in pixels. Default is by 32.
+				 */
+				KeypointGrid(const std::vector<cv::KeyPoint>& keypoints, const cv::Size& imageSize, int cellSize = 32);
+
+				/**
+				 * Destructor.
+				 */
+				virtual ~KeypointGrid() = default;
+
+				/**
+				 * Obtain the indices of all keypoints inside the given rectangle.
+				 * @param rect Rectangle in image coordinates.
+				 * @param keypoints Keypoints the grid was built from.
+				 * @param indices Indices of the keypoints inside the rectangle in ascending order.
+				 */
+				void Query(const cv::Rect& rect, const std::vector<cv::KeyPoint>& keypoints, std::vector<int>& indices) const;
+
+			private:
+
+				/**
+				 * Side length of a grid cell in pixels.
+				 */
+				int cellSize;
+
+				/**
+				 * Count of grid columns.
+				 */
+				int columns;
+
+				/**
+				 * Count of grid rows.
+				 */
+				int rows;
+
+				/**
+				 * Start of each cell in the index array, has one more entry than cells.
+				 */
+				std::vector<int> cellStart;
+
+				/**
+				 * Keypoint indices sorted by cell.
+				 */
+				std::vector<int> indices;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_KEYPOINTGRID_H
@@ -0,0 +1,123 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SceneFeatures.h"
+
+/**
+ * Keypoint indices of the last scene part of each thread, reused by all subsets.
+ */
+static thread_local std::vector<int> subsetIndices;
+
+Companion::Model::Processing::SceneFeatures::SceneFeatures(const cv::Mat& image,
+	cv::Ptr<cv::FeatureDetector> detector,
+	cv::Ptr<cv::DescriptorExtractor> extractor,
+	int matcherType)
+{
+	if (image.channels() > 1)
+	{
+		cv::cvtColor(image, this->image, cv::COLOR_BGR2GRAY); // Convert image to grayscale
+	}
+	else
+	{
+		this->image = image;
+	}
+
+	Companion::Thread::StageTimer detectTimer(TimingStage::DETECT);
+	detector->detect(this->image, this->keypoints);
+	detectTimer.Stop();
+
+	Companion::Thread::StageTimer extractTimer(TimingStage::EXTRACT);
+	extractor->compute(this->image, this->keypoints, this->descriptors);
+	extractTimer.Stop();
+
+	// If matching type is flann based, scene descriptors must be in CV_32F format
+	if (matcherType == cv::DescriptorMatcher::FLANNBASED && !this->descriptors.empty())
+	{
+		this->descriptors.convertTo(this->descriptors, CV_32F);
+	}
+
+	// Grid index is built only if a scene part is queried (ROI or IRA), it indexes the keypoints left by compute
+}
+
+const cv::Mat& Companion::Model::Processing::SceneFeatures::Image() const
+{
+	return this->image;
+}
+
+const std::vector<cv::KeyPoint>& Companion::Model::Processing::SceneFeatures::Keypoints() const
+{
+	return this->keypoints;
+}
+
+const cv::Mat& Companion::Model::Processing::SceneFeatures::Descriptors() const
+{
+	return this->descriptors;
+}
+
+const Companion::Model::Processing::KeypointGrid& Companion::Model::Processing::SceneFeatures::Grid() const
+{
+	std::lock_guard<std::mutex> lk(this->gridMx);
+	if (!this->gridBuilt)
+	{
+		this->grid = KeypointGrid(this->keypoints, this->image.size());
+		this->gridBuilt = true;
+	}
+	return this->grid;
+}
+
+PTR_SCENE_FEATURES Companion::Model::Processing::SceneFeatures::Subset(const cv::Rect& rect) const
+{
+	std::shared_ptr<SceneFeatures> subset = std::make_shared<SceneFeatures>();
+	this->Subset(rect, *subset);
+	return subset;
+}
+
+void Companion::Model::Processing::SceneFeatures::Subset(const cv::Rect& rect, SceneFeatures& subset) const
+{
+	cv::Rect area = rect & cv::Rect(0, 0, this->image.cols, this->image.rows);
+	cv::Point2f offset(static_cast<float>(area.x), static_cast<float>(area.y));
+	std::vector<int>& indices = subsetIndices;
+
+	subset.image = cv::Mat(this->image, area);
+	this->Grid().Query(area, this->keypoints, indices);
+
+	// Keypoints and descriptors keep the memory of the last scene part, it only grows for larger scene parts
+	subset.keypoints.clear();
+	subset.descriptors = cv::Mat();
+	if (!indices.empty())
+	{
+		if (subset.descriptorBuffer.rows < static_cast<int>(indices.size())
+			|| subset.descriptorBuffer.cols != this->descriptors.cols
+			|| subset.descriptorBuffer.type() != this->descriptors.type())
+		{
+			subset.descriptorBuffer.create(static_cast<int>(indices.size()), this->descriptors.cols, this->descriptors.type());
+		}
+		subset.descriptors = subset.descriptorBuffer.rowRange(0, static_cast<int>(indices.size()));
+	}
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		subset.keypoints.push_back(this->keypoints[indices[i]]);
+		subset.keypoints.back().pt -= offset;
+		this->descriptors.row(indices[i]).copyTo(subset.descriptors.row(static_cast<int>(i)));
+	}
+
+	// Matching uses only keypoints and descriptors of a subset, its grid index is built only if it is queried
+	std::lock_guard<std::mutex> lk(subset.gridMx);
+	subset.gridBuilt = false;
+}
@@ -0,0 +1,151 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_SCENEFEATURES_H
+#define COMPANION_SCENEFEATURES_H
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/features2d.hpp>
+#include <opencv2/imgproc.hpp>
+#include <mutex>
+#include <companion/model/processing/KeypointGrid.h>
+#include <companion/thread/StageTimer.h>
+#include <companion/util/Definitions.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Model {
+		namespace Processing
+		{
+			/**
+			 * Immutable per-frame cache of the scene's grayscale image, keypoints and descriptors. It is calculated once
+			 * per frame and shared read-only by all object models which are searched in this frame. Keypoints are indexed by
+			 * a uniform grid, so the features of a scene part (ROI or IRA window) are obtained without re-extraction. Scene
+			 * parts can be stored into reused scene features, which are owned by a single thread.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS SceneFeatures
+			{
+
+			public:
+
+				/**
+				 * Constructor to calculate all scene features from the given image.
+				 * @param image Scene image (BGR or grayscale).
+				 * @param detector Detector to obtain keypoints.
+				 * @param extractor Extractor to calculate descriptors.
+				 * @param matcherType FeatureMatcher type, descriptors are converted to CV_32F for FLANNBASED matchers.
+				 */
+				SceneFeatures(const cv::Mat& image,
+					cv::Ptr<cv::FeatureDetector> detector,
+					cv::Ptr<cv::DescriptorExtractor> extractor,
+					int matcherType);
+
+				/**
+				 * Constructor to create empty scene features, used for subsets.
+				 */
+				SceneFeatures() = default;
+
+				/**
+				 * Destructor.
+				 */
+				virtual ~SceneFeatures() = default;
+
+				/**
+				 * Get the grayscale scene image.
+				 * @return Grayscale scene image.
+				 */
+				const cv::Mat& Image() const;
+
+				/**
+				 * Get all keypoints from the scene.
+				 * @return Keypoints of the scene, empty if no keypoints are found.
+				 */
+				const std::vector<cv::KeyPoint>& Keypoints() const;
+
+				/**
+				 * Get the descriptors from the scene, already converted for the used matcher type.
+				 * @return Descriptors of the scene, empty if no keypoints are found.
+				 */
+				const cv::Mat& Descriptors() const;
+
+				/**
+				 * Get the grid index over the keypoints of the scene, the index is built on first use.
+				 * @return Keypoint grid index.
+				 */
+				const KeypointGrid& Grid() const;
+
+				/**
+				 * Obtain the features of a scene part from the grid index. Keypoints are moved into the coordinates of the
+				 * scene part, descriptors are the ones calculated on the full scene.
+				 * @param rect Scene part in scene image coordinates.
+				 * @return Scene features of the scene part.
+				 */
+				PTR_SCENE_FEATURES Subset(const cv::Rect& rect) const;
+
+				/**
+				 * Obtain the features of a scene part into the given scene features, which keep the memory of their last
+				 * scene part. Keypoints are moved into the coordinates of the scene part, descriptors are the ones
+				 * calculated on the full scene.
+				 * @param rect Scene part in scene image coordinates.
+				 * @param subset Scene features to overwrite with the scene part, must not be shared with other threads.
+				 */
+				void Subset(const cv::Rect& rect, SceneFeatures& subset) const;
+
+			private:
+
+				/**
+				 * Grayscale scene image.
+				 */
+				cv::Mat image;
+
+				/**
+				 * Keypoints of the scene.
+				 */
+				std::vector<cv::KeyPoint> keypoints;
+
+				/**
+				 * Descriptors of the scene.
+				 */
+				cv::Mat descriptors;
+
+				/**
+				 * Memory of the descriptors of a subset, the descriptors are a view of its first rows.
+				 */
+				cv::Mat descriptorBuffer;
+
+				/**
+				 * Grid index over the keypoints of the scene.
+				 */
+				mutable KeypointGrid grid;
+
+				/**
+				 * Indicator if the grid index is built for the current keypoints.
+				 */
+				mutable bool gridBuilt = false;
+
+				/**
+				 * Mutex to build the grid index only once, also if several threads query it.
+				 */
+				mutable std::mutex gridMx;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_SCENEFEATURES_H
@@ -0,0 +1,50 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StreamModels.h"
+
+std::vector<PTR_MODEL_FEATURE_MATCHING> Companion::Model::Processing::StreamModels::Models(int stream,
+	const std::vector<PTR_MODEL_FEATURE_MATCHING>& models)
+{
+	if (stream == 0)
+	{
+		return models;
+	}
+
+	std::vector<PTR_MODEL_FEATURE_MATCHING> shared;
+	std::lock_guard<std::mutex> lk(this->mx);
+	std::map<PTR_MODEL_FEATURE_MATCHING, PTR_MODEL_FEATURE_MATCHING>& streamModels = this->streams[stream];
+	for (size_t i = 0; i < models.size(); i++)
+	{
+		PTR_MODEL_FEATURE_MATCHING& model = streamModels[models.at(i)];
+		if (model == nullptr)
+		{
+			// Share descriptors and matcher index, only the state between frames is kept per stream
+			model = models.at(i)->Share();
+		}
+		shared.push_back(model);
+	}
+
+	return shared;
+}
+
+void Companion::Model::Processing::StreamModels::Clear()
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+	this->streams.clear();
+}
@@ -0,0 +1,84 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_STREAMMODELS_H
+#define COMPANION_STREAMMODELS_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include <companion/model/processing/FeatureMatchingModel.h>
+#include <companion/util/Definitions.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Model {
+		namespace Processing
+		{
+			/**
+			 * Feature matching models of each stream. Models keep state between frames (IRA, tracking and cached
+			 * homography) which belongs to a single stream, so each stream matches with its own shared models.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS StreamModels
+			{
+
+			public:
+
+				/**
+				 * Create an empty set of stream models.
+				 */
+				StreamModels() = default;
+
+				/**
+				 * Destructor.
+				 */
+				virtual ~StreamModels() = default;
+
+				/**
+				 * Get the models of a stream. Stream 0 uses the given models, other streams use shared models which are
+				 * created on first use of each model. Shared models are assigned by the identity of the given models, so
+				 * frames with an older model list still obtain the shared models of their own list.
+				 * @param stream Stream ID.
+				 * @param models Models to share.
+				 * @return Models of the stream in the order of the given models.
+				 */
+				std::vector<PTR_MODEL_FEATURE_MATCHING> Models(int stream, const std::vector<PTR_MODEL_FEATURE_MATCHING>& models);
+
+				/**
+				 * Remove the shared models of all streams, releases the shared models of removed models.
+				 */
+				void Clear();
+
+			private:
+
+				/**
+				 * Shared models of each stream except stream 0 by their original model.
+				 */
+				std::map<int, std::map<PTR_MODEL_FEATURE_MATCHING, PTR_MODEL_FEATURE_MATCHING>> streams;
+
+				/**
+				 * Mutex to guard the shared models.
+				 */
+				std::mutex mx;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_STREAMMODELS_H
@@ -0,0 +1,90 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TrackingModel.h"
+
+Companion::Model::Processing::TrackingModel::TrackingModel()
+{
+	this->keyframePoints = 0;
+	this->framesSinceKeyframe = 0;
+}
+
+void Companion::Model::Processing::TrackingModel::Inliers(const std::vector<cv::Point2f>& objectPoints,
+	const std::vector<cv::Point2f>& scenePoints)
+{
+	this->frame.release();
+	this->objectPoints = objectPoints;
+	this->scenePoints = scenePoints;
+	this->keyframePoints = scenePoints.size();
+	this->framesSinceKeyframe = 0;
+}
+
+void Companion::Model::Processing::TrackingModel::Start(const cv::Mat& frame)
+{
+	this->frame = frame;
+	this->framesSinceKeyframe = 0;
+}
+
+void Companion::Model::Processing::TrackingModel::Update(const cv::Mat& frame,
+	const std::vector<cv::Point2f>& objectPoints,
+	const std::vector<cv::Point2f>& scenePoints)
+{
+	this->frame = frame;
+	this->objectPoints = objectPoints;
+	this->scenePoints = scenePoints;
+	this->framesSinceKeyframe++;
+}
+
+void Companion::Model::Processing::TrackingModel::Clear()
+{
+	this->frame.release();
+	this->objectPoints.clear();
+	this->scenePoints.clear();
+	this->keyframePoints = 0;
+	this->framesSinceKeyframe = 0;
+}
+
+bool Companion::Model::Processing::TrackingModel::IsTracking() const
+{
+	return !this->frame.empty() && !this->scenePoints.empty();
+}
+
+const cv::Mat& Companion::Model::Processing::TrackingModel::Frame() const
+{
+	return this->frame;
+}
+
+const std::vector<cv::Point2f>& Companion::Model::Processing::TrackingModel::ObjectPoints() const
+{
+	return this->objectPoints;
+}
+
+const std::vector<cv::Point2f>& Companion::Model::Processing::TrackingModel::ScenePoints() const
+{
+	return this->scenePoints;
+}
+
+size_t Companion::Model::Processing::TrackingModel::KeyframePoints() const
+{
+	return this->keyframePoints;
+}
+
+int Companion::Model::Processing::TrackingModel::FramesSinceKeyframe() const
+{
+	return this->framesSinceKeyframe;
+}
@@ -0,0 +1,144 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_TRACKINGMODEL_H
+#define COMPANION_TRACKINGMODEL_H
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <companion/util/Definitions.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Model {
+		namespace Processing
+		{
+			/**
+			 * Tracking data model which stores the state of an object between two recognitions, the inlier points of the last
+			 * recognition and their tracked positions in the last frame.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS TrackingModel
+			{
+
+			public:
+
+				/**
+				 * Constructor to create an inactive tracking model.
+				 */
+				TrackingModel();
+
+				/**
+				 * Destructor.
+				 */
+				virtual ~TrackingModel() = default;
+
+				/**
+				 * Store the homography inliers of a recognition. Tracking starts if a frame is set afterwards.
+				 * @param objectPoints Inlier points in object image coordinates.
+				 * @param scenePoints Corresponding inlier points in scene image coordinates.
+				 */
+				void Inliers(const std::vector<cv::Point2f>& objectPoints, const std::vector<cv::Point2f>& scenePoints);
+
+				/**
+				 * Start tracking from the stored recognition inliers in the given frame. The frame is a keyframe.
+				 * @param frame Grayscale scene frame of the recognition.
+				 */
+				void Start(const cv::Mat& frame);
+
+				/**
+				 * Update the tracked points after tracking the given frame successfully.
+				 * @param frame Grayscale scene frame which was tracked.
+				 * @param objectPoints Object points which are still tracked.
+				 * @param scenePoints Tracked scene points in the given frame.
+				 */
+				void Update(const cv::Mat& frame, const std::vector<cv::Point2f>& objectPoints, const std::vector<cv::Point2f>& scenePoints);
+
+				/**
+				 * Stop tracking and clear all points.
+				 */
+				void Clear();
+
+				/**
+				 * Indicator if the object is currently tracked.
+				 * @return <code>True</code> if the object is tracked, <code>false</code> otherwise.
+				 */
+				bool IsTracking() const;
+
+				/**
+				 * Get the last tracked grayscale frame.
+				 * @return Last tracked frame.
+				 */
+				const cv::Mat& Frame() const;
+
+				/**
+				 * Get the tracked object points.
+				 * @return Object points in object image coordinates.
+				 */
+				const std::vector<cv::Point2f>& ObjectPoints() const;
+
+				/**
+				 * Get the tracked scene points of the last frame.
+				 * @return Scene points in scene image coordinates.
+				 */
+				const std::vector<cv::Point2f>& ScenePoints() const;
+
+				/**
+				 * Get the count of inliers from the last keyframe.
+				 * @return Count of keyframe inliers.
+				 */
+				size_t KeyframePoints() const;
+
+				/**
+				 * Get the count of frames which were tracked since the last keyframe.
+				 * @return Count of tracked frames.
+				 */
+				int FramesSinceKeyframe() const;
+
+			private:
+
+				/**
+				 * Last tracked grayscale frame.
+				 */
+				cv::Mat frame;
+
+				/**
+				 * Tracked object points in object image coordinates.
+				 */
+				std::vector<cv::Point2f> objectPoints;
+
+				/**
+				 * Tracked scene points in scene image coordinates.
+				 */
+				std::vector<cv::Point2f> scenePoints;
+
+				/**
+				 * Count of inliers from the last keyframe.
+				 */
+				size_t keyframePoints;
+
+				/**
+				 * Count of frames which were tracked since the last keyframe.
+				 */
+				int framesSinceKeyframe;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_TRACKINGMODEL_H
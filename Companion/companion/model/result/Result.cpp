@@ -22,6 +22,7 @@ Companion::Model::Result::Result::Result(int scoring, PTR_DRAW drawable)
 {
     this->scoring = scoring;
     this->drawable = drawable;
+    this->partial = false;
 }
 
 int Companion::Model::Result::Result::Scoring() const
@@ -33,3 +34,13 @@ PTR_DRAW Companion::Model::Result::Result::Drawable() const
 {
 	return this->drawable;
 }
+
+bool Companion::Model::Result::Result::Partial() const
+{
+    return this->partial;
+}
+
+void Companion::Model::Result::Result::Partial(bool partial)
+{
+    this->partial = partial;
+}
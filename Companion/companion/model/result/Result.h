@@ -76,6 +76,19 @@ namespace Companion {
 				 */
 				virtual ResultType Type() const = 0;
 
+				/**
+				 * Check if this result belongs to a frame whose processing was cut short by its deadline. Objects which
+				 * were not evaluated in time are missing from the results of the frame.
+				 * @return <code>True</code> if the results of the frame are incomplete.
+				 */
+				bool Partial() const;
+
+				/**
+				 * Mark this result as part of incomplete results.
+				 * @param partial <code>True</code> if the results of the frame are incomplete.
+				 */
+				void Partial(bool partial);
+
 			private:
 
 				/**
@@ -87,6 +100,11 @@ namespace Companion {
 				 * Drawable result.
 				 */
 				PTR_DRAW drawable;
+
+				/**
+				 * Indicator if the results of the frame are incomplete.
+				 */
+				bool partial;
 			};
 		}
 	}
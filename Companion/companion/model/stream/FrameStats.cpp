@@ -0,0 +1,137 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameStats.h"
+
+constexpr int Companion::Model::Stream::FrameStats::NO_MODEL;
+constexpr int Companion::Model::Stream::FrameStats::STAGES;
+
+Companion::Model::Stream::FrameStats::FrameStats(int stream, unsigned long sequence)
+{
+	this->stream = stream;
+	this->sequence = sequence;
+	for (int i = 0; i < STAGES; i++)
+	{
+		this->durations[i].store(0, std::memory_order_relaxed);
+		this->counts[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+int Companion::Model::Stream::FrameStats::Stream() const
+{
+	return this->stream;
+}
+
+unsigned long Companion::Model::Stream::FrameStats::Sequence() const
+{
+	return this->sequence;
+}
+
+void Companion::Model::Stream::FrameStats::Add(TimingStage stage, std::chrono::nanoseconds duration, int model)
+{
+	int index = static_cast<int>(stage);
+
+	if (index < 0 || index >= STAGES)
+	{
+		return;
+	}
+
+	this->durations[index].fetch_add(duration.count(), std::memory_order_relaxed);
+	this->counts[index].fetch_add(1, std::memory_order_relaxed);
+
+	if (model != NO_MODEL)
+	{
+		std::lock_guard<std::mutex> lk(this->mx);
+		std::vector<long long>& modelDuration = this->modelDurations[model];
+		if (modelDuration.empty())
+		{
+			modelDuration = std::vector<long long>(STAGES, 0);
+		}
+		modelDuration[index] += duration.count();
+	}
+}
+
+double Companion::Model::Stream::FrameStats::Duration(TimingStage stage) const
+{
+	int index = static_cast<int>(stage);
+	return index >= 0 && index < STAGES ? this->durations[index].load(std::memory_order_relaxed) / 1e6 : 0;
+}
+
+double Companion::Model::Stream::FrameStats::Duration(TimingStage stage, int model) const
+{
+	int index = static_cast<int>(stage);
+	std::lock_guard<std::mutex> lk(this->mx);
+	std::map<int, std::vector<long long>>::const_iterator it = this->modelDurations.find(model);
+
+	if (index < 0 || index >= STAGES || it == this->modelDurations.end())
+	{
+		return 0;
+	}
+
+	return it->second[index] / 1e6;
+}
+
+unsigned long Companion::Model::Stream::FrameStats::Count(TimingStage stage) const
+{
+	int index = static_cast<int>(stage);
+	return index >= 0 && index < STAGES ? this->counts[index].load(std::memory_order_relaxed) : 0;
+}
+
+std::vector<int> Companion::Model::Stream::FrameStats::Models() const
+{
+	std::vector<int> models;
+	std::lock_guard<std::mutex> lk(this->mx);
+
+	for (std::map<int, std::vector<long long>>::const_iterator it = this->modelDurations.begin(); it != this->modelDurations.end(); ++it)
+	{
+		models.push_back(it->first);
+	}
+
+	return models;
+}
+
+const char* Companion::Model::Stream::FrameStats::Name(TimingStage stage)
+{
+	switch (stage)
+	{
+	case TimingStage::CONVERT:
+		return "convert";
+	case TimingStage::DETECT:
+		return "detect";
+	case TimingStage::EXTRACT:
+		return "extract";
+	case TimingStage::KNN_MATCH:
+		return "knn_match";
+	case TimingStage::RATIO_TEST:
+		return "ratio_test";
+	case TimingStage::HOMOGRAPHY:
+		return "homography";
+	case TimingStage::CALCULATE_AREA:
+		return "calculate_area";
+	case TimingStage::ROI_DETECTION:
+		return "roi_detection";
+	case TimingStage::TRACKING:
+		return "tracking";
+	case TimingStage::LSH:
+		return "lsh";
+	case TimingStage::PROCESSING:
+		return "processing";
+	default:
+		return "unknown";
+	}
+}
@@ -0,0 +1,171 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_FRAMESTATS_H
+#define COMPANION_FRAMESTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion
+{
+	/**
+	 * Timed steps of the image processing.
+	 */
+	enum class TimingStage
+	{
+		CONVERT, ///< Color conversion of the image for the result callback.
+		DETECT, ///< Keypoint detection like detector->detect.
+		EXTRACT, ///< Descriptor extraction like extractor->compute.
+		KNN_MATCH, ///< K nearest neighbour matching of descriptors.
+		RATIO_TEST, ///< Ratio test of the matches.
+		HOMOGRAPHY, ///< Homography estimation like cv::findHomography.
+		CALCULATE_AREA, ///< Calculation and validation of the recognized area.
+		ROI_DETECTION, ///< Shape detection of regions of interest.
+		TRACKING, ///< Tracking of recognized objects.
+		LSH, ///< Hashing and search of locality sensitive hashing.
+		PROCESSING, ///< Whole image processing of a frame.
+		COUNT ///< Number of timed steps, no step.
+	};
+
+	namespace Model {
+		namespace Stream
+		{
+			/**
+			 * Processing times of a single frame, split by timed steps and models. Durations can be added concurrently by
+			 * all threads which process the frame.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS FrameStats
+			{
+
+			public:
+
+				/**
+				 * Model ID of durations which belong to no model.
+				 */
+				static constexpr int NO_MODEL = -1;
+
+				/**
+				 * Create empty stats of a frame.
+				 * @param stream ID of the stream of the frame.
+				 * @param sequence Sequence number of the frame within its stream.
+				 */
+				FrameStats(int stream = 0, unsigned long sequence = 0);
+
+				/**
+				 * Get ID of the stream of the frame.
+				 * @return Stream ID.
+				 */
+				int Stream() const;
+
+				/**
+				 * Get sequence number of the frame within its stream.
+				 * @return Sequence number.
+				 */
+				unsigned long Sequence() const;
+
+				/**
+				 * Add the duration of a timed step.
+				 * @param stage Timed step.
+				 * @param duration Duration of the step.
+				 * @param model ID of the model the step belongs to, NO_MODEL if it belongs to the whole frame.
+				 */
+				void Add(TimingStage stage, std::chrono::nanoseconds duration, int model = NO_MODEL);
+
+				/**
+				 * Get total duration of a timed step over all models.
+				 * @param stage Timed step.
+				 * @return Total duration in milliseconds.
+				 */
+				double Duration(TimingStage stage) const;
+
+				/**
+				 * Get total duration of a timed step of a single model.
+				 * @param stage Timed step.
+				 * @param model Model ID.
+				 * @return Total duration in milliseconds, 0 if the model has no duration for this step.
+				 */
+				double Duration(TimingStage stage, int model) const;
+
+				/**
+				 * Get number of times a timed step was executed.
+				 * @param stage Timed step.
+				 * @return Number of executions.
+				 */
+				unsigned long Count(TimingStage stage) const;
+
+				/**
+				 * Get IDs of all models which have durations.
+				 * @return Model IDs in ascending order.
+				 */
+				std::vector<int> Models() const;
+
+				/**
+				 * Get name of a timed step.
+				 * @param stage Timed step.
+				 * @return Name of the step in lower case, for example "knn_match".
+				 */
+				static const char* Name(TimingStage stage);
+
+			private:
+
+				/**
+				 * Number of timed steps.
+				 */
+				static constexpr int STAGES = static_cast<int>(TimingStage::COUNT);
+
+				/**
+				 * ID of the stream of the frame.
+				 */
+				int stream;
+
+				/**
+				 * Sequence number of the frame.
+				 */
+				unsigned long sequence;
+
+				/**
+				 * Total duration of each step in nanoseconds.
+				 */
+				std::atomic<long long> durations[STAGES];
+
+				/**
+				 * Number of executions of each step.
+				 */
+				std::atomic<unsigned long> counts[STAGES];
+
+				/**
+				 * Mutex to guard the durations of the models.
+				 */
+				mutable std::mutex mx;
+
+				/**
+				 * Duration of each step in nanoseconds for each model.
+				 */
+				std::map<int, std::vector<long long>> modelDurations;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_FRAMESTATS_H
@@ -0,0 +1,154 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Histogram.h"
+
+#include <algorithm>
+
+constexpr int Companion::Model::Stream::Histogram::PRECISION_BITS;
+constexpr int Companion::Model::Stream::Histogram::MAX_BIT;
+constexpr int Companion::Model::Stream::Histogram::SUB_BUCKETS;
+constexpr int Companion::Model::Stream::Histogram::BUCKETS;
+
+Companion::Model::Stream::Histogram::Histogram()
+{
+	this->Reset();
+}
+
+void Companion::Model::Stream::Histogram::Record(long long value)
+{
+	const long long maxValue = (1LL << (MAX_BIT + 1)) - 1;
+
+	if (value < 0)
+	{
+		value = 0;
+	}
+	else if (value > maxValue)
+	{
+		value = maxValue;
+	}
+
+	this->buckets[Bucket(value)].fetch_add(1, std::memory_order_relaxed);
+	this->sum.fetch_add(value, std::memory_order_relaxed);
+	this->count.fetch_add(1, std::memory_order_relaxed);
+
+	long long largest = this->max.load(std::memory_order_relaxed);
+	while (value > largest && !this->max.compare_exchange_weak(largest, value, std::memory_order_relaxed))
+	{
+	}
+}
+
+unsigned long long Companion::Model::Stream::Histogram::Count() const
+{
+	return this->count.load(std::memory_order_relaxed);
+}
+
+long long Companion::Model::Stream::Histogram::Max() const
+{
+	return this->max.load(std::memory_order_relaxed);
+}
+
+double Companion::Model::Stream::Histogram::Mean() const
+{
+	unsigned long long recorded = this->Count();
+	if (recorded == 0)
+	{
+		return 0;
+	}
+	return static_cast<double>(this->sum.load(std::memory_order_relaxed)) / recorded;
+}
+
+long long Companion::Model::Stream::Histogram::Percentile(double percentile) const
+{
+	unsigned long long total = 0;
+	unsigned long long seen = 0;
+	std::array<unsigned long long, BUCKETS> counts;
+
+	// Read each bucket once, values recorded meanwhile change the snapshot only slightly
+	for (int i = 0; i < BUCKETS; i++)
+	{
+		counts[i] = this->buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+
+	if (total == 0)
+	{
+		return 0;
+	}
+
+	percentile = std::min(100.0, std::max(0.0, percentile));
+	unsigned long long rank = static_cast<unsigned long long>(percentile / 100.0 * total + 0.5);
+	rank = std::max(1ULL, std::min(total, rank));
+
+	for (int i = 0; i < BUCKETS; i++)
+	{
+		seen += counts[i];
+		if (seen >= rank)
+		{
+			// Middle of the bucket, the largest value is exact
+			long long lowest = LowestValue(i);
+			long long highest = i + 1 < BUCKETS ? LowestValue(i + 1) - 1 : lowest;
+			return std::min(lowest + (highest - lowest) / 2, this->Max());
+		}
+	}
+
+	return this->Max();
+}
+
+void Companion::Model::Stream::Histogram::Reset()
+{
+	for (int i = 0; i < BUCKETS; i++)
+	{
+		this->buckets[i].store(0, std::memory_order_relaxed);
+	}
+	this->count.store(0, std::memory_order_relaxed);
+	this->sum.store(0, std::memory_order_relaxed);
+	this->max.store(0, std::memory_order_relaxed);
+}
+
+int Companion::Model::Stream::Histogram::Bucket(long long value)
+{
+	if (value < (1LL << PRECISION_BITS))
+	{
+		return static_cast<int>(value);
+	}
+
+	int highestBit = PRECISION_BITS;
+	while ((value >> (highestBit + 1)) != 0)
+	{
+		highestBit++;
+	}
+
+	// Keep the highest bits of the value, the first of them is always set
+	int shift = highestBit - PRECISION_BITS + 1;
+	return (1 << PRECISION_BITS) + (highestBit - PRECISION_BITS) * SUB_BUCKETS
+		+ static_cast<int>(value >> shift) - SUB_BUCKETS;
+}
+
+long long Companion::Model::Stream::Histogram::LowestValue(int bucket)
+{
+	if (bucket < (1 << PRECISION_BITS))
+	{
+		return bucket;
+	}
+
+	int group = (bucket - (1 << PRECISION_BITS)) / SUB_BUCKETS;
+	int subBucket = (bucket - (1 << PRECISION_BITS)) % SUB_BUCKETS;
+	int shift = group + 1;
+	return static_cast<long long>(SUB_BUCKETS + subBucket) << shift;
+}
@@ -0,0 +1,144 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_HISTOGRAM_H
+#define COMPANION_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Model {
+		namespace Stream
+		{
+			/**
+			 * Histogram of non negative values with a bounded relative error in the style of a HDR histogram. Values are
+			 * recorded lock-free into logarithmic buckets which are linearly divided, so each bucket covers about 3% of
+			 * its value. All statistics can be read while values are recorded from other threads.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS Histogram
+			{
+
+			public:
+
+				/**
+				 * Constructor.
+				 */
+				Histogram();
+
+				/**
+				 * Record a value.
+				 * @param value Value to record, negative values are recorded as 0 and values above the maximum
+				 * trackable value as the maximum.
+				 */
+				void Record(long long value);
+
+				/**
+				 * Get number of recorded values.
+				 * @return Number of recorded values.
+				 */
+				unsigned long long Count() const;
+
+				/**
+				 * Get largest recorded value.
+				 * @return Largest recorded value or 0 if no value is recorded.
+				 */
+				long long Max() const;
+
+				/**
+				 * Get mean of all recorded values.
+				 * @return Mean value or 0 if no value is recorded.
+				 */
+				double Mean() const;
+
+				/**
+				 * Get the value below which the given percentage of all recorded values fall.
+				 * @param percentile Percentile between 0 and 100.
+				 * @return Value of the percentile within the bucket precision or 0 if no value is recorded.
+				 */
+				long long Percentile(double percentile) const;
+
+				/**
+				 * Remove all recorded values.
+				 */
+				void Reset();
+
+			private:
+
+				/**
+				 * Number of bits of the values which are tracked exactly, larger values keep this precision relative to
+				 * their magnitude.
+				 */
+				static constexpr int PRECISION_BITS = 6;
+
+				/**
+				 * Highest bit of the maximum trackable value, covers more than 18 minutes in nanoseconds.
+				 */
+				static constexpr int MAX_BIT = 40;
+
+				/**
+				 * Number of linear buckets of each power of two.
+				 */
+				static constexpr int SUB_BUCKETS = 1 << (PRECISION_BITS - 1);
+
+				/**
+				 * Number of all buckets.
+				 */
+				static constexpr int BUCKETS = (1 << PRECISION_BITS) + (MAX_BIT - PRECISION_BITS + 1) * SUB_BUCKETS;
+
+				/**
+				 * Get bucket of a value.
+				 * @param value Value between 0 and the maximum trackable value.
+				 * @return Index of the bucket.
+				 */
+				static int Bucket(long long value);
+
+				/**
+				 * Get smallest value of a bucket.
+				 * @param bucket Index of the bucket.
+				 * @return Smallest value which is recorded into the bucket.
+				 */
+				static long long LowestValue(int bucket);
+
+				/**
+				 * Number of recorded values of each bucket.
+				 */
+				std::array<std::atomic<unsigned long long>, BUCKETS> buckets;
+
+				/**
+				 * Number of recorded values.
+				 */
+				std::atomic<unsigned long long> count;
+
+				/**
+				 * Sum of all recorded values.
+				 */
+				std::atomic<long long> sum;
+
+				/**
+				 * Largest recorded value.
+				 */
+				std::atomic<long long> max;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_HISTOGRAM_H
@@ -0,0 +1,154 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StreamMetrics.h"
+
+Companion::Model::Stream::StreamMetrics::StreamMetrics()
+{
+	this->Reset();
+}
+
+void Companion::Model::Stream::StreamMetrics::FrameProduced()
+{
+	this->producedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Companion::Model::Stream::StreamMetrics::FrameStored(int occupancy)
+{
+	this->storedFrames.fetch_add(1, std::memory_order_relaxed);
+	this->occupancy.store(occupancy, std::memory_order_relaxed);
+	this->occupancyHistogram.Record(occupancy);
+}
+
+void Companion::Model::Stream::StreamMetrics::FrameConsumed(int occupancy)
+{
+	this->consumedFrames.fetch_add(1, std::memory_order_relaxed);
+	this->occupancy.store(occupancy, std::memory_order_relaxed);
+	this->occupancyHistogram.Record(occupancy);
+}
+
+void Companion::Model::Stream::StreamMetrics::Latency(std::chrono::nanoseconds latency)
+{
+	this->latency.Record(latency.count());
+}
+
+void Companion::Model::Stream::StreamMetrics::FrameDropped()
+{
+	this->droppedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Companion::Model::Stream::StreamMetrics::FrameExpired()
+{
+	this->expiredFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Companion::Model::Stream::StreamMetrics::FramePartial()
+{
+	this->partialFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Companion::Model::Stream::StreamMetrics::Blocked(std::chrono::nanoseconds duration)
+{
+	this->blockedTime.fetch_add(duration.count(), std::memory_order_relaxed);
+}
+
+void Companion::Model::Stream::StreamMetrics::Idle(std::chrono::nanoseconds duration)
+{
+	this->idleTime.fetch_add(duration.count(), std::memory_order_relaxed);
+}
+
+void Companion::Model::Stream::StreamMetrics::SkipFrame(int skipFrame)
+{
+	this->skipFrame.store(skipFrame, std::memory_order_relaxed);
+}
+
+unsigned long Companion::Model::Stream::StreamMetrics::ProducedFrames() const
+{
+	return this->producedFrames.load(std::memory_order_relaxed);
+}
+
+unsigned long Companion::Model::Stream::StreamMetrics::StoredFrames() const
+{
+	return this->storedFrames.load(std::memory_order_relaxed);
+}
+
+unsigned long Companion::Model::Stream::StreamMetrics::ConsumedFrames() const
+{
+	return this->consumedFrames.load(std::memory_order_relaxed);
+}
+
+unsigned long Companion::Model::Stream::StreamMetrics::DroppedFrames() const
+{
+	return this->droppedFrames.load(std::memory_order_relaxed);
+}
+
+unsigned long Companion::Model::Stream::StreamMetrics::ExpiredFrames() const
+{
+	return this->expiredFrames.load(std::memory_order_relaxed);
+}
+
+unsigned long Companion::Model::Stream::StreamMetrics::PartialFrames() const
+{
+	return this->partialFrames.load(std::memory_order_relaxed);
+}
+
+double Companion::Model::Stream::StreamMetrics::BlockedTime() const
+{
+	return this->blockedTime.load(std::memory_order_relaxed) / 1e6;
+}
+
+double Companion::Model::Stream::StreamMetrics::IdleTime() const
+{
+	return this->idleTime.load(std::memory_order_relaxed) / 1e6;
+}
+
+int Companion::Model::Stream::StreamMetrics::Occupancy() const
+{
+	return this->occupancy.load(std::memory_order_relaxed);
+}
+
+const Companion::Model::Stream::Histogram& Companion::Model::Stream::StreamMetrics::OccupancyHistogram() const
+{
+	return this->occupancyHistogram;
+}
+
+const Companion::Model::Stream::Histogram& Companion::Model::Stream::StreamMetrics::Latency() const
+{
+	return this->latency;
+}
+
+int Companion::Model::Stream::StreamMetrics::SkipFrame() const
+{
+	return this->skipFrame.load(std::memory_order_relaxed);
+}
+
+void Companion::Model::Stream::StreamMetrics::Reset()
+{
+	this->producedFrames.store(0, std::memory_order_relaxed);
+	this->storedFrames.store(0, std::memory_order_relaxed);
+	this->consumedFrames.store(0, std::memory_order_relaxed);
+	this->droppedFrames.store(0, std::memory_order_relaxed);
+	this->expiredFrames.store(0, std::memory_order_relaxed);
+	this->partialFrames.store(0, std::memory_order_relaxed);
+	this->blockedTime.store(0, std::memory_order_relaxed);
+	this->idleTime.store(0, std::memory_order_relaxed);
+	this->skipFrame.store(0, std::memory_order_relaxed);
+	this->occupancy.store(0, std::memory_order_relaxed);
+	this->occupancyHistogram.Reset();
+	this->latency.Reset();
+}
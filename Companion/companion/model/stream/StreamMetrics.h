@@ -0,0 +1,245 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_STREAMMETRICS_H
+#define COMPANION_STREAMMETRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <companion/model/stream/Histogram.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Model {
+		namespace Stream
+		{
+			/**
+			 * Counters of a running stream worker, all counters can be read lock-free while the worker is running.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS StreamMetrics
+			{
+
+			public:
+
+				/**
+				 * Constructor.
+				 */
+				StreamMetrics();
+
+				/**
+				 * Count a frame which was obtained from a stream, including frames which are skipped or dropped later.
+				 */
+				void FrameProduced();
+
+				/**
+				 * Count a frame which was stored for processing.
+				 * @param occupancy Number of buffered frames after the frame was stored.
+				 */
+				void FrameStored(int occupancy);
+
+				/**
+				 * Count a frame which was taken from the buffer by a consumer.
+				 * @param occupancy Number of buffered frames after the frame was taken.
+				 */
+				void FrameConsumed(int occupancy);
+
+				/**
+				 * Record the end-to-end latency of a frame from obtaining its image to the callback of its results.
+				 * @param latency Latency of the frame.
+				 */
+				void Latency(std::chrono::nanoseconds latency);
+
+				/**
+				 * Count a frame which was dropped by the backpressure policy.
+				 */
+				void FrameDropped();
+
+				/**
+				 * Count a frame which was dropped because its deadline passed before processing started.
+				 */
+				void FrameExpired();
+
+				/**
+				 * Count a frame whose processing was cut short by its deadline and which delivered partial results.
+				 */
+				void FramePartial();
+
+				/**
+				 * Add time the producer was blocked because the frame buffer was full.
+				 * @param duration Blocked time.
+				 */
+				void Blocked(std::chrono::nanoseconds duration);
+
+				/**
+				 * Add time a consumer waited for a frame because the frame buffer was empty.
+				 * @param duration Idle time.
+				 */
+				void Idle(std::chrono::nanoseconds duration);
+
+				/**
+				 * Set current skip frame rate of the producers.
+				 * @param skipFrame Number of frames which are skipped after each stored frame.
+				 */
+				void SkipFrame(int skipFrame);
+
+				/**
+				 * Get number of frames which were obtained from the streams.
+				 * @return Number of produced frames.
+				 */
+				unsigned long ProducedFrames() const;
+
+				/**
+				 * Get number of frames which were stored for processing.
+				 * @return Number of stored frames.
+				 */
+				unsigned long StoredFrames() const;
+
+				/**
+				 * Get number of frames which were taken from the buffer by the consumers.
+				 * @return Number of consumed frames.
+				 */
+				unsigned long ConsumedFrames() const;
+
+				/**
+				 * Get number of frames which were dropped by the backpressure policy.
+				 * @return Number of dropped frames.
+				 */
+				unsigned long DroppedFrames() const;
+
+				/**
+				 * Get number of frames which were dropped because their deadline passed before processing started.
+				 * @return Number of expired frames.
+				 */
+				unsigned long ExpiredFrames() const;
+
+				/**
+				 * Get number of frames which delivered partial results because their deadline passed while processing.
+				 * @return Number of partial frames.
+				 */
+				unsigned long PartialFrames() const;
+
+				/**
+				 * Get time the producer was blocked because the frame buffer was full.
+				 * @return Blocked time in milliseconds.
+				 */
+				double BlockedTime() const;
+
+				/**
+				 * Get time all consumers together waited for frames because the frame buffer was empty.
+				 * @return Idle time in milliseconds.
+				 */
+				double IdleTime() const;
+
+				/**
+				 * Get number of currently buffered frames.
+				 * @return Number of buffered frames of the last stored or consumed frame.
+				 */
+				int Occupancy() const;
+
+				/**
+				 * Get histogram of the number of buffered frames, sampled whenever a frame is stored or consumed. A buffer
+				 * which is full most of the time shows that processing falls behind.
+				 * @return Histogram of buffered frames.
+				 */
+				const Histogram& OccupancyHistogram() const;
+
+				/**
+				 * Get histogram of the end-to-end latency of the frames from obtaining their image to the callback.
+				 * @return Histogram of latencies in nanoseconds.
+				 */
+				const Histogram& Latency() const;
+
+				/**
+				 * Get current skip frame rate of the producers, which changes continuously if adaptive skipping is used.
+				 * @return Number of frames which are skipped after each stored frame.
+				 */
+				int SkipFrame() const;
+
+				/**
+				 * Reset all counters.
+				 */
+				void Reset();
+
+			private:
+
+				/**
+				 * Number of produced frames.
+				 */
+				std::atomic<unsigned long> producedFrames;
+
+				/**
+				 * Number of stored frames.
+				 */
+				std::atomic<unsigned long> storedFrames;
+
+				/**
+				 * Number of consumed frames.
+				 */
+				std::atomic<unsigned long> consumedFrames;
+
+				/**
+				 * Number of dropped frames.
+				 */
+				std::atomic<unsigned long> droppedFrames;
+
+				/**
+				 * Number of expired frames.
+				 */
+				std::atomic<unsigned long> expiredFrames;
+
+				/**
+				 * Number of partial frames.
+				 */
+				std::atomic<unsigned long> partialFrames;
+
+				/**
+				 * Blocked time in nanoseconds.
+				 */
+				std::atomic<long long> blockedTime;
+
+				/**
+				 * Idle time in nanoseconds.
+				 */
+				std::atomic<long long> idleTime;
+
+				/**
+				 * Number of currently buffered frames.
+				 */
+				std::atomic<int> occupancy;
+
+				/**
+				 * Histogram of buffered frames.
+				 */
+				Histogram occupancyHistogram;
+
+				/**
+				 * Histogram of frame latencies in nanoseconds.
+				 */
+				Histogram latency;
+
+				/**
+				 * Current skip frame rate.
+				 */
+				std::atomic<int> skipFrame;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_STREAMMETRICS_H
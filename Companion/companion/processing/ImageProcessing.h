@@ -21,6 +21,9 @@
 
 #include <opencv2/core/core.hpp>
 #include <companion/model/result/Result.h>
+#include <companion/model/processing/FrameState.h>
+#include <companion/util/CompanionError.h>
+#include <companion/util/CompanionException.h>
 #include <companion/util/Definitions.h>
 
 namespace Companion {
@@ -41,6 +44,71 @@ namespace Companion {
 			 * @return A vector of results if there are any.
 			 */
 			virtual CALLBACK_RESULT Execute(cv::Mat frame) = 0;
+
+			/**
+			 * Execute the image processing for a batch of images, for example to process offline image sets without
+			 * a stream. Default implementation executes the images one after another.
+			 * @param frames Source images.
+			 * @return State of each image at the index of the image, which contains its results and errors.
+			 */
+			virtual std::vector<PTR_FRAME_STATE> ExecuteBatch(const std::vector<cv::Mat>& frames)
+			{
+				std::vector<PTR_FRAME_STATE> states;
+				CALLBACK_RESULT results;
+
+				for (size_t i = 0; i < frames.size(); i++)
+				{
+					PTR_FRAME_STATE state = std::make_shared<FRAME_STATE>(frames[i], i);
+					try
+					{
+						results = this->Execute(frames[i]);
+						for (size_t j = 0; j < results.size(); j++)
+						{
+							state->AddResult(results[j]);
+						}
+					}
+					catch (Error::Code errorCode)
+					{
+						state->AddError(errorCode);
+					}
+					catch (Error::CompanionException ex)
+					{
+						while (ex.HasNext())
+						{
+							state->AddError(ex.Next());
+						}
+					}
+					states.push_back(state);
+				}
+
+				return states;
+			}
+
+			/**
+			 * Get number of stages this image processing is split into. Stages can be executed by a pipeline where
+			 * different frames occupy different stages concurrently. Default is a single stage which executes the whole
+			 * image processing.
+			 * @return Number of stages.
+			 */
+			virtual int Stages() const
+			{
+				return 1;
+			}
+
+			/**
+			 * Execute a single stage for the given frame, stages are executed in order for each frame.
+			 * @param stage Stage to execute, between 0 and Stages() - 1.
+			 * @param state State of the frame which is passed from stage to stage, stores the results of the frame.
+			 * @throws Companion::Error::Code or Companion::Error::CompanionException if the stage fails.
+			 */
+			virtual void ExecuteStage(int stage, PTR_FRAME_STATE state)
+			{
+				CALLBACK_RESULT results = this->Execute(state->Frame());
+				for (size_t i = 0; i < results.size(); i++)
+				{
+					state->AddResult(results[i]);
+				}
+			}
 		};
 	}
 }
@@ -38,3 +38,33 @@ CALLBACK_RESULT Companion::Processing::Detection::ObjectDetection::Execute(cv::M
 
     return results;
 }
+
+std::vector<PTR_FRAME_STATE> Companion::Processing::Detection::ObjectDetection::ExecuteBatch(const std::vector<cv::Mat>& frames)
+{
+    PTR_TASK_POOL pool = Companion::Thread::TaskPool::Shared();
+    std::vector<PTR_FRAME_STATE> states(frames.size());
+    // Edge image buffer of each worker, reused for all images of the batch
+    std::vector<cv::Mat> buffers(pool->Concurrency());
+
+    pool->ParallelFor(static_cast<int>(frames.size()), [&](int i, int slot)
+    {
+        PTR_FRAME_STATE state = std::make_shared<FRAME_STATE>(frames[i], i);
+
+        try
+        {
+            std::vector<PTR_DRAW_FRAME> detected = this->detection->ExecuteAlgorithm(frames[i], buffers[slot]);
+            for (size_t j = 0; j < detected.size(); j++)
+            {
+                state->AddResult(std::make_shared<RESULT_DETECTION>(100, this->detection->Description(), detected[j]));
+            }
+        }
+        catch (Companion::Error::Code errorCode)
+        {
+            state->AddError(errorCode);
+        }
+
+        states[i] = state;
+    });
+
+    return states;
+}
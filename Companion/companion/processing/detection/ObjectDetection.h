@@ -22,6 +22,7 @@
 #include <companion/algo/detection/ShapeDetection.h>
 #include <companion/model/result/DetectionResult.h>
 #include <companion/processing/ImageProcessing.h>
+#include <companion/thread/TaskPool.h>
 
 namespace Companion {
 	namespace Processing {
@@ -53,6 +54,14 @@ namespace Companion {
 				 */
 				CALLBACK_RESULT Execute(cv::Mat frame);
 
+				/**
+				 * Execute the image processing for a batch of images. Images are processed concurrently by the task pool,
+				 * each worker reuses its image buffers for all its images.
+				 * @param frames Source images.
+				 * @return State of each image at the index of the image, which contains its results and errors.
+				 */
+				std::vector<PTR_FRAME_STATE> ExecuteBatch(const std::vector<cv::Mat>& frames);
+
 			private:
 
 				/**
@@ -0,0 +1,219 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CatalogRecognition.h"
+
+Companion::Processing::Recognition::CatalogRecognition::CatalogRecognition(PTR_FEATURE_MATCHING featureMatching,
+    Companion::SCALING scaling,
+    int maxCandidates,
+    int minVotes)
+{
+    this->featureMatching = featureMatching;
+    this->scaling = scaling;
+    this->maxCandidates = maxCandidates;
+    this->minVotes = minVotes;
+    this->catalog = std::make_shared<CATALOG_INDEX>();
+    this->catalogChanged = false;
+    this->streamModels = std::make_shared<STREAM_MODELS>();
+}
+
+CALLBACK_RESULT Companion::Processing::Recognition::CatalogRecognition::Execute(cv::Mat frame)
+{
+    PTR_FRAME_STATE state = std::make_shared<FRAME_STATE>(frame);
+
+    // Run all stages one after another, a pipeline runs them concurrently for different frames
+    for (int stage = 0; stage < this->Stages(); stage++)
+    {
+        this->ExecuteStage(stage, state);
+    }
+
+    return state->Results();
+}
+
+int Companion::Processing::Recognition::CatalogRecognition::Stages() const
+{
+    return STAGES;
+}
+
+void Companion::Processing::Recognition::CatalogRecognition::ExecuteStage(int stage, PTR_FRAME_STATE state)
+{
+    if (state->Frame().empty() || this->featureMatching->IsCuda())
+    {
+        // Catalog index works only with cpu feature matching
+        return;
+    }
+
+    switch (stage)
+    {
+    case STAGE_SCENE:
+        this->SceneStage(state);
+        break;
+    case STAGE_VERIFICATION:
+        this->VerificationStage(state);
+        break;
+    }
+}
+
+void Companion::Processing::Recognition::CatalogRecognition::SceneStage(PTR_FRAME_STATE state)
+{
+    PTR_MODEL_FEATURE_MATCHING sceneModel = std::make_shared<MODEL_FEATURE_MATCHING>();
+    cv::Mat frame = state->Frame();
+
+    std::unique_lock<std::mutex> lock(this->catalogMutex);
+    if (this->catalogChanged)
+    {
+        // Build a new index only if models have changed, frames in verification keep voting on the old one
+        PTR_CATALOG_INDEX catalog = std::make_shared<CATALOG_INDEX>();
+        catalog->Build(this->models);
+        this->catalog = catalog;
+        this->catalogModels = this->models;
+        this->catalogChanged = false;
+    }
+    // Index and models of this frame belong together, also if models change before the frame is verified
+    state->Catalog(this->catalog);
+    state->Models(this->catalogModels);
+    lock.unlock();
+
+    Util::ResizeImage(frame, this->scaling);
+    sceneModel->Image(frame);
+
+    // Calculate scene features once, they are matched once against the whole catalog
+    this->featureMatching->CalculateSceneFeatures(sceneModel);
+
+    state->Frame(frame);
+    state->Scene(sceneModel);
+}
+
+void Companion::Processing::Recognition::CatalogRecognition::VerificationStage(PTR_FRAME_STATE state)
+{
+    PTR_MODEL_FEATURE_MATCHING sceneModel = state->Scene();
+    const cv::Mat& frame = state->Frame();
+    std::vector<std::vector<cv::DMatch>> modelMatches;
+    std::vector<std::pair<size_t, size_t>> candidates;
+    std::vector<PTR_RESULT> candidateResults;
+    std::vector<std::vector<Companion::Error::Code>> parallelizedErrors;
+    std::vector<Companion::Error::Code> errors;
+    // Each stream verifies with its own models, they keep the cached homography between frames
+    std::vector<PTR_MODEL_FEATURE_MATCHING> models = this->streamModels->Models(state->Stream(), state->Models());
+    PTR_CATALOG_INDEX catalog = state->Catalog();
+    PTR_TASK_POOL pool = Companion::Thread::TaskPool::Shared();
+
+    if (catalog == nullptr)
+    {
+        return;
+    }
+
+    catalog->Vote(sceneModel->Features()->Descriptors(), DEFAULT_RATIO_VALUE, modelMatches);
+
+    // Rank models by their votes
+    for (size_t i = 0; i < modelMatches.size(); i++)
+    {
+        if (modelMatches[i].size() >= static_cast<size_t>(this->minVotes))
+        {
+            candidates.push_back(std::make_pair(modelMatches[i].size(), i));
+        }
+    }
+
+    if (candidates.size() > static_cast<size_t>(this->maxCandidates))
+    {
+        std::partial_sort(candidates.begin(),
+            candidates.begin() + this->maxCandidates,
+            candidates.end(),
+            std::greater<std::pair<size_t, size_t>>());
+        candidates.resize(this->maxCandidates);
+    }
+
+    // Verify only the top voted models by a homography
+    candidateResults = std::vector<PTR_RESULT>(candidates.size());
+    parallelizedErrors = std::vector<std::vector<Companion::Error::Code>>(pool->Concurrency());
+    pool->ParallelFor(static_cast<int>(candidates.size()), [&](int i, int slot)
+    {
+        try
+        {
+            PTR_MODEL_FEATURE_MATCHING objectModel = models.at(candidates[i].second);
+            std::lock_guard<std::mutex> lock(objectModel->Mutex());
+            candidateResults[i] = this->featureMatching->VerifyCandidate(sceneModel,
+                objectModel,
+                modelMatches[candidates[i].second]);
+        }
+        catch (Companion::Error::Code errorCode)
+        {
+            parallelizedErrors[slot].push_back(errorCode);
+        }
+    });
+
+    for (size_t i = 0; i < parallelizedErrors.size(); i++)
+    {
+        errors.insert(errors.end(), parallelizedErrors[i].begin(), parallelizedErrors[i].end());
+    }
+
+    if (!errors.empty())
+    {
+        throw Companion::Error::CompanionException(errors);
+    }
+
+    for (size_t i = 0; i < candidateResults.size(); i++)
+    {
+        if (candidateResults[i] != nullptr)
+        {
+            // Create old image size
+            candidateResults[i]->Drawable()->Ratio(frame.cols, frame.rows, state->OriginalWidth(), state->OriginalHeight());
+            state->AddResult(candidateResults[i]);
+        }
+    }
+}
+
+bool Companion::Processing::Recognition::CatalogRecognition::AddModel(PTR_MODEL_FEATURE_MATCHING model)
+{
+    if (!model->Image().empty())
+    {
+        // Prepare model features only once
+        this->featureMatching->TrainModel(model);
+        std::lock_guard<std::mutex> lock(this->catalogMutex);
+        this->models.push_back(model);
+        this->catalogChanged = true;
+        return true;
+    }
+
+    return false;
+}
+
+bool Companion::Processing::Recognition::CatalogRecognition::RemoveModel(int modelID)
+{
+    std::lock_guard<std::mutex> lock(this->catalogMutex);
+    for (size_t index = 0; index < this->models.size(); index++)
+    {
+        if (this->models.at(index)->ID() == modelID) {
+            this->models.erase(this->models.begin() + index);
+            this->streamModels->Clear();
+            this->catalogChanged = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Companion::Processing::Recognition::CatalogRecognition::ClearModels()
+{
+    std::lock_guard<std::mutex> lock(this->catalogMutex);
+    this->models.clear();
+    this->catalogModels.clear();
+    this->streamModels->Clear();
+    this->catalog = std::make_shared<CATALOG_INDEX>();
+    this->catalogChanged = false;
+}
@@ -0,0 +1,199 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_CATALOGRECOGNITION_H
+#define COMPANION_CATALOGRECOGNITION_H
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <mutex>
+#include <opencv2/core/core.hpp>
+#include <companion/processing/ImageProcessing.h>
+#include <companion/model/processing/FeatureMatchingModel.h>
+#include <companion/model/processing/StreamModels.h>
+#include <companion/draw/Drawable.h>
+#include <companion/util/CompanionException.h>
+#include <companion/algo/recognition/matching/FeatureMatching.h>
+#include <companion/algo/recognition/matching/util/CatalogIndex.h>
+#include <companion/Configuration.h>
+#include <companion/thread/TaskPool.h>
+
+namespace Companion {
+	namespace Processing {
+		namespace Recognition
+		{
+			/**
+			 * Catalog recognition implementation to recognize objects from large model catalogs. Instead of matching the scene
+			 * against every model, the scene descriptors are matched once against a catalog-wide index, each good match votes
+			 * for its model and only the top voted models are verified by a homography.
+			 * @author Andreas Sekulski, Dimitri Kotlovsky
+			 */
+			class COMP_EXPORTS CatalogRecognition : public ImageProcessing
+			{
+
+			public:
+
+				/**
+				 * Catalog recognition constructor.
+				 * @param featureMatching Feature matching algorithm which is used to calculate features and to verify candidates.
+				 * @param scaling Scaling to resize an image. Default is 1920x1080.
+				 * @param maxCandidates Maximum number of top voted models which are verified per frame. Default is by 5.
+				 * @param minVotes Minimum number of votes a model needs to be verified. Default is by 10.
+				 */
+				CatalogRecognition(PTR_FEATURE_MATCHING featureMatching,
+					Companion::SCALING scaling = Companion::SCALING::SCALE_1920x1080,
+					int maxCandidates = 5,
+					int minVotes = 10);
+
+				/**
+				 * Destructor.
+				 */
+				virtual ~CatalogRecognition() = default;
+
+				/**
+				 * Add search model type to search for. The catalog index is rebuilt on the next frame.
+				 * @param model Model to search for.
+				 * @return <code>True</code> if model is added, <code>false</code> otherwise.
+				 */
+				bool AddModel(PTR_MODEL_FEATURE_MATCHING model);
+
+				/**
+				 * Remove given model if it exists. This method can only be used safely if the searching process is not running.
+				 * @param modelID ID of the model to remove.
+				 * @return <code>True</code> if the model was deleted, otherwise <code>false</code>.
+				 */
+				bool RemoveModel(int modelID);
+
+				/**
+				 * Clear all models which are searched for.
+				 */
+				void ClearModels();
+
+				/**
+				 * Try to recognize all objects in the given frame.
+				 * @param frame Frame to check for an object location.
+				 * @return A vector of results for the given frame or an empty vector if no objects are recognized.
+				 */
+				CALLBACK_RESULT Execute(cv::Mat frame);
+
+				/**
+				 * Get number of stages, catalog recognition is split into scene feature extraction and verification.
+				 * @return Number of stages.
+				 */
+				int Stages() const;
+
+				/**
+				 * Execute a single stage of the recognition for the given frame.
+				 * @param stage Stage to execute.
+				 * @param state State of the frame which is passed from stage to stage.
+				 * @throws Companion::Error::CompanionException if the verification of a candidate fails.
+				 */
+				void ExecuteStage(int stage, PTR_FRAME_STATE state);
+
+			private:
+
+				/**
+				 * Stage to rebuild the catalog if needed, resize the frame and calculate its scene features.
+				 */
+				static constexpr int STAGE_SCENE = 0;
+
+				/**
+				 * Stage to vote for candidates in the catalog and verify them.
+				 */
+				static constexpr int STAGE_VERIFICATION = 1;
+
+				/**
+				 * Number of stages.
+				 */
+				static constexpr int STAGES = 2;
+
+				/**
+				 * Scaling value to resize image.
+				 */
+				Companion::SCALING scaling;
+
+				/**
+				 * Feature matching algorithm.
+				 */
+				PTR_FEATURE_MATCHING featureMatching;
+
+				/**
+				 * Maximum number of top voted models which are verified per frame.
+				 */
+				int maxCandidates;
+
+				/**
+				 * Minimum number of votes a model needs to be verified.
+				 */
+				int minVotes;
+
+				/**
+				 * Feature matching models.
+				 */
+				std::vector<PTR_MODEL_FEATURE_MATCHING> models;
+
+				/**
+				 * Shared models of each stream, so every stream keeps its own state between frames.
+				 */
+				PTR_STREAM_MODELS streamModels;
+
+				/**
+				 * Catalog-wide descriptor index over the catalog models. A built index is never changed, changed models
+				 * replace it with a new index, so frames which still vote on the old index keep it alive.
+				 */
+				PTR_CATALOG_INDEX catalog;
+
+				/**
+				 * Models of the catalog index in the order of its votes.
+				 */
+				std::vector<PTR_MODEL_FEATURE_MATCHING> catalogModels;
+
+				/**
+				 * Indicator if the catalog index must be rebuilt because models have changed.
+				 */
+				bool catalogChanged;
+
+				/**
+				 * Mutex to guard the models and to rebuild the catalog index only once if frames are processed concurrently.
+				 */
+				std::mutex catalogMutex;
+
+				/**
+				 * Resize the frame and calculate its scene features.
+				 * @param state State of the frame.
+				 */
+				void SceneStage(PTR_FRAME_STATE state);
+
+				/**
+				 * Vote for candidates in the catalog and verify the top voted candidates.
+				 * @param state State of the frame.
+				 * @throws Companion::Error::CompanionException if the verification of a candidate fails.
+				 */
+				void VerificationStage(PTR_FRAME_STATE state);
+
+				/**
+				 * Default ratio test value to obtain only good catalog matches.
+				 */
+				static constexpr float DEFAULT_RATIO_VALUE = 0.8f;
+			};
+		}
+	}
+}
+
+#endif //COMPANION_CATALOGRECOGNITION_H
@@ -54,18 +54,63 @@ bool Companion::Processing::Recognition::HashRecognition::AddModel(int id, cv::M
 
 CALLBACK_RESULT Companion::Processing::Recognition::HashRecognition::Execute(cv::Mat frame)
 {
+    cv::Mat edges;
+    cv::Mat resized;
     cv::Mat query;
+
+    return Recognize(frame, edges, resized, query);
+}
+
+std::vector<PTR_FRAME_STATE> Companion::Processing::Recognition::HashRecognition::ExecuteBatch(const std::vector<cv::Mat>& frames)
+{
+    PTR_TASK_POOL pool = Companion::Thread::TaskPool::Shared();
+    std::vector<PTR_FRAME_STATE> states(frames.size());
+    // Image buffers of each worker, reused for all images of the batch
+    std::vector<cv::Mat> edges(pool->Concurrency());
+    std::vector<cv::Mat> resized(pool->Concurrency());
+    std::vector<cv::Mat> queries(pool->Concurrency());
+
+    // Generate the hash dataset of new models before the workers start, they only read it
+    this->model->GenerateDataset();
+
+    pool->ParallelFor(static_cast<int>(frames.size()), [&](int i, int slot)
+    {
+        PTR_FRAME_STATE state = std::make_shared<FRAME_STATE>(frames[i], i);
+
+        try
+        {
+            CALLBACK_RESULT results = Recognize(frames[i], edges[slot], resized[slot], queries[slot]);
+            for (size_t j = 0; j < results.size(); j++)
+            {
+                state->AddResult(results[j]);
+            }
+        }
+        catch (Companion::Error::Code errorCode)
+        {
+            state->AddError(errorCode);
+        }
+
+        states[i] = state;
+    });
+
+    return states;
+}
+
+CALLBACK_RESULT Companion::Processing::Recognition::HashRecognition::Recognize(cv::Mat frame,
+    cv::Mat& edges,
+    cv::Mat& resized,
+    cv::Mat& query)
+{
     CALLBACK_RESULT results;
-	PTR_RESULT_RECOGNITION result;
+    PTR_RESULT_RECOGNITION result;
     std::map<int, PTR_RESULT_RECOGNITION> scorings;
 
     // Obtain all shapes from the image to recognize
-    std::vector<PTR_DRAW_FRAME> frames = this->shapeDetection->ExecuteAlgorithm(frame);
+    std::vector<PTR_DRAW_FRAME> frames = this->shapeDetection->ExecuteAlgorithm(frame, edges);
     for (size_t i = 0; i < frames.size(); i++)
     {
-        query = Util::CutImage(frame, frames.at(i)->CutArea());
-        Companion::Util::ResizeImage(query, this->modelSize);
-        Companion::Util::ConvertColor(query, query, Companion::ColorFormat::GRAY);
+        cv::resize(Util::CutImage(frame, frames.at(i)->CutArea()), resized, this->modelSize);
+        Companion::Util::ConvertColor(resized, query, Companion::ColorFormat::GRAY);
         result = this->hashing->ExecuteAlgorithm(this->model, query, frames.at(i));
         if (result != nullptr)
         {
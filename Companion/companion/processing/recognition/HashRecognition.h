@@ -24,6 +24,7 @@
 #include <companion/model/processing/ImageHashModel.h>
 #include <companion/algo/recognition/hashing/Hashing.h>
 #include <companion/util/Util.h>
+#include <companion/thread/TaskPool.h>
 
 namespace Companion {
 	namespace Processing {
@@ -68,6 +69,14 @@ namespace Companion {
 				 */
 				CALLBACK_RESULT Execute(cv::Mat frame);
 
+				/**
+				 * Execute the image processing for a batch of images. Images are processed concurrently by the task pool,
+				 * each worker reuses its image buffers for all its images.
+				 * @param frames Source images.
+				 * @return State of each image at the index of the image, which contains its results and errors.
+				 */
+				std::vector<PTR_FRAME_STATE> ExecuteBatch(const std::vector<cv::Mat>& frames);
+
 			private:
 
 				/**
@@ -89,6 +98,16 @@ namespace Companion {
 				 * Stores hashing algorithm to recognize objects.
 				 */
 				PTR_HASHING hashing;
+
+				/**
+				 * Recognize all objects in the given frame with the given image buffers.
+				 * @param frame Frame to check for an object location.
+				 * @param edges Buffer for the edge image of the shape detection.
+				 * @param resized Buffer for a region of interest resized to the model size.
+				 * @param query Buffer for the gray scale query of a region of interest.
+				 * @return A vector of results for the given frame or an empty vector if no objects are recognized.
+				 */
+				CALLBACK_RESULT Recognize(cv::Mat frame, cv::Mat& edges, cv::Mat& resized, cv::Mat& query);
 			};
 		}
 	}
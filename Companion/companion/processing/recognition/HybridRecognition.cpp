@@ -25,6 +25,7 @@ Companion::Processing::Recognition::HybridRecognition::HybridRecognition(PTR_HAS
 	this->featureMatching = featureMatching;
 	this->featureMatching->UseIRA(false);
 	this->resize = resize;
+	this->streamModels = std::make_shared<STREAM_MODELS>();
 }
 
 void Companion::Processing::Recognition::HybridRecognition::AddModel(cv::Mat image, int id)
@@ -32,55 +33,107 @@ void Companion::Processing::Recognition::HybridRecognition::AddModel(cv::Mat ima
 	PTR_MODEL_FEATURE_MATCHING model = std::make_shared<MODEL_FEATURE_MATCHING>();
 	model->ID(id);
 	model->Image(image);
-	this->models[id] = model;
+	this->featureMatching->TrainModel(model); // Prepare model features and its matcher index only once
+	{
+		std::lock_guard<std::mutex> lock(this->modelsMutex);
+		this->models[id] = model;
+	}
 	this->hashRecognition->AddModel(id, image);
 }
 
 void Companion::Processing::Recognition::HybridRecognition::RemoveModel(int modelID)
 {
+	std::lock_guard<std::mutex> lock(this->modelsMutex);
 	this->models.erase(modelID);
+	this->streamModels->Clear();
 	// ToDo delete method for hashRecognition...
 }
 
 void Companion::Processing::Recognition::HybridRecognition::ClearModels()
 {
+	std::lock_guard<std::mutex> lock(this->modelsMutex);
 	this->models.clear();
+	this->streamModels->Clear();
 	// ToDo delete method for hashRecognition...
 }
 
 CALLBACK_RESULT Companion::Processing::Recognition::HybridRecognition::Execute(cv::Mat frame)
+{
+	return this->Recognize(frame, 0);
+}
+
+void Companion::Processing::Recognition::HybridRecognition::ExecuteStage(int stage, PTR_FRAME_STATE state)
+{
+	CALLBACK_RESULT results = this->Recognize(state->Frame(), state->Stream());
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		state->AddResult(results[i]);
+	}
+}
+
+CALLBACK_RESULT Companion::Processing::Recognition::HybridRecognition::Recognize(cv::Mat frame, int stream)
 {
 	CALLBACK_RESULT results;
+	std::vector<int> ids;
+	std::vector<PTR_MODEL_FEATURE_MATCHING> models;
+	std::map<int, PTR_MODEL_FEATURE_MATCHING> objectModels;
 	std::vector<CALLBACK_RESULT> parallelizedResults;
-	cv::Mat roiFrame;
+	std::vector<std::vector<Companion::Error::Code>> parallelizedErrors;
 	std::vector<Companion::Error::Code> errors;
-	PTR_RESULT hashResult;
 	std::vector<PTR_RESULT> hashResults;
-	int threads;
+	PTR_TASK_POOL pool = Companion::Thread::TaskPool::Shared();
 
-	threads = omp_get_max_threads();
-	parallelizedResults = std::vector<CALLBACK_RESULT>(threads);
+	parallelizedResults = std::vector<CALLBACK_RESULT>(pool->Concurrency());
+	parallelizedErrors = std::vector<std::vector<Companion::Error::Code>>(pool->Concurrency());
 	hashResults = this->hashRecognition->Execute(frame);
 
+	{
+		// Models can be changed while frames are processed, this frame uses a copy of the current models
+		std::lock_guard<std::mutex> lock(this->modelsMutex);
+		for (std::map<int, PTR_MODEL_FEATURE_MATCHING>::iterator it = this->models.begin(); it != this->models.end(); ++it)
+		{
+			ids.push_back(it->first);
+			models.push_back(it->second);
+		}
+	}
+
+	// Each stream verifies with its own models, they keep state between frames
+	models = this->streamModels->Models(stream, models);
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		objectModels[ids[i]] = models[i];
+	}
+
 	if (!hashResults.empty())
 	{
-		errors.clear();
-#pragma omp parallel for
-		for (int i = 0; i < hashResults.size(); i++)
+		// Each hash result is verified by an individual task, every worker writes to its own buffers
+		pool->ParallelFor(static_cast<int>(hashResults.size()), [&](int i, int slot)
 		{
 			try
 			{
-				hashResult = hashResults.at(i);
-				if (hashResult != nullptr)
+				PTR_RESULT hashResult = hashResults.at(i);
+				if (hashResult == nullptr)
 				{
-					Processing(hashResult, frame, parallelizedResults[omp_get_thread_num()]);
+					return;
+				}
+
+				std::shared_ptr<RESULT_RECOGNITION> resultReco = std::dynamic_pointer_cast<RESULT_RECOGNITION>(hashResult);
+				std::map<int, PTR_MODEL_FEATURE_MATCHING>::const_iterator objectModel = objectModels.find(resultReco->Id());
+				if (objectModel != objectModels.end())
+				{
+					Processing(hashResult, objectModel->second, frame, parallelizedResults[slot]);
 				}
 			}
 			catch (Companion::Error::Code errorCode)
 			{
-#pragma omp critical
-				errors.push_back(errorCode);
+				parallelizedErrors[slot].push_back(errorCode);
 			}
+		});
+
+		for (size_t i = 0; i < parallelizedErrors.size(); i++)
+		{
+			errors.insert(errors.end(), parallelizedErrors[i].begin(), parallelizedErrors[i].end());
 		}
 
 		if (!errors.empty())
@@ -89,10 +142,9 @@ CALLBACK_RESULT Companion::Processing::Recognition::HybridRecognition::Execute(c
 		}
 	}
 
-#pragma omp critical
-	for (int i = 0; i < threads; i++)
+	for (size_t i = 0; i < parallelizedResults.size(); i++)
 	{
-		for (int j = 0; j < parallelizedResults[i].size(); j++)
+		for (size_t j = 0; j < parallelizedResults[i].size(); j++)
 		{
 			results.push_back(std::shared_ptr<RESULT>(parallelizedResults[i].at(j)));
 		}
@@ -103,6 +155,7 @@ CALLBACK_RESULT Companion::Processing::Recognition::HybridRecognition::Execute(c
 
 void Companion::Processing::Recognition::HybridRecognition::Processing(
 	PTR_RESULT hashResult,
+	PTR_MODEL_FEATURE_MATCHING objectModel,
 	cv::Mat frame,
 	CALLBACK_RESULT& results)
 {
@@ -126,8 +179,11 @@ void Companion::Processing::Recognition::HybridRecognition::Processing(
 	}
 
 	sceneModel->Image(cutImage);
-	std::shared_ptr<RESULT_RECOGNITION> resultReco = std::dynamic_pointer_cast<RESULT_RECOGNITION>(hashResult);
-	fmResult = this->featureMatching->ExecuteAlgorithm(sceneModel, this->models[resultReco->Id()], nullptr);
+	{
+		// Hash results of a frame can share a model, serialize the state updates of this model
+		std::lock_guard<std::mutex> lock(objectModel->Mutex());
+		fmResult = this->featureMatching->ExecuteAlgorithm(sceneModel, objectModel, nullptr);
+	}
 
 	if (fmResult != nullptr)
 	{
@@ -19,13 +19,17 @@
 #ifndef COMPANION_HYBRIDRECOGNITION_H
 #define COMPANION_HYBRIDRECOGNITION_H
 
+#include <map>
+#include <mutex>
 #include <companion/processing/ImageProcessing.h>
 #include <companion/processing/recognition/HashRecognition.h>
 #include <companion/algo/detection/ShapeDetection.h>
 #include <companion/algo/recognition/matching/FeatureMatching.h>
 #include <companion/model/processing/FeatureMatchingModel.h>
+#include <companion/model/processing/FrameState.h>
+#include <companion/model/processing/StreamModels.h>
 #include <companion/util/CompanionException.h>
-#include <omp.h>
+#include <companion/thread/TaskPool.h>
 
 namespace Companion {
 	namespace Processing {
@@ -80,6 +84,14 @@ namespace Companion {
 				 */
 				CALLBACK_RESULT Execute(cv::Mat frame);
 
+				/**
+				 * Try to recognize all objects in the frame of the given state with the models of its stream.
+				 * @param stage Stage to execute, hybrid recognition has a single stage.
+				 * @param state State of the frame, stores the results of the frame.
+				 * @throws Companion::Error::CompanionException if the verification of a hash result fails.
+				 */
+				void ExecuteStage(int stage, PTR_FRAME_STATE state);
+
 			private:
 
 				/**
@@ -102,13 +114,33 @@ namespace Companion {
 				 */
 				std::map<int, PTR_MODEL_FEATURE_MATCHING> models;
 
+				/**
+				 * Models of each stream, verification updates the model state which belongs to a single stream.
+				 */
+				PTR_STREAM_MODELS streamModels;
+
+				/**
+				 * Mutex to guard the models, frames obtain a copy of the models and never read them directly.
+				 */
+				std::mutex modelsMutex;
+
+				/**
+				 * Recognize all objects in the given frame with the models of the given stream.
+				 * @param frame Frame to check for an object location.
+				 * @param stream Stream ID of the frame.
+				 * @return A vector of results for the given frame or an empty vector if no objects are recognized.
+				 */
+				CALLBACK_RESULT Recognize(cv::Mat frame, int stream);
+
 				/**
 				 * Processing method to recognize objects.
 				 * @param hashResult Result from hash recognition.
+				 * @param objectModel Model of the stream to verify the hash result with.
 				 * @param frame Scene frame.
 				 * @param results List of all recognized objects.
 				 */
 				void Processing(PTR_RESULT hashResult,
+					PTR_MODEL_FEATURE_MATCHING objectModel,
 					cv::Mat frame,
 					CALLBACK_RESULT& results);
 
@@ -25,171 +25,485 @@ Companion::Processing::Recognition::MatchRecognition::MatchRecognition(PTR_MATCH
     this->matchingAlgo = matchingAlgo;
     this->scaling = scaling;
     this->shapeDetection = shapeDetection;
+    this->tracking = nullptr;
+    this->streamModels = std::make_shared<STREAM_MODELS>();
 }
 
 CALLBACK_RESULT Companion::Processing::Recognition::MatchRecognition::Execute(cv::Mat frame)
 {
-    CALLBACK_RESULT results;
-    std::vector<CALLBACK_RESULT> parallelizedResults;
-	PTR_FEATURE_MATCHING featureMatching;
-	PTR_MODEL_FEATURE_MATCHING sceneModel = std::make_shared<MODEL_FEATURE_MATCHING>();;
-    std::vector<PTR_DRAW_FRAME> rois;
-    std::vector<Companion::Error::Code> errors;
-    int oldX, oldY, threads;
+    PTR_FRAME_STATE state = std::make_shared<FRAME_STATE>(frame);
 
-    // Create vector result list to parallelize
-    if (this->matchingAlgo->IsCuda())
+    // Run all stages one after another, a pipeline runs them concurrently for different frames
+    for (int stage = 0; stage < this->Stages(); stage++)
     {
-        threads = 1;
-        parallelizedResults = std::vector<CALLBACK_RESULT>(threads);
+        this->ExecuteStage(stage, state);
     }
-    else
+
+    return state->Results();
+}
+
+int Companion::Processing::Recognition::MatchRecognition::Stages() const
+{
+    return STAGES;
+}
+
+void Companion::Processing::Recognition::MatchRecognition::ExecuteStage(int stage, PTR_FRAME_STATE state)
+{
+    if (state->Frame().empty())
     {
-        threads = omp_get_max_threads();
-        parallelizedResults = std::vector<CALLBACK_RESULT>(threads);
+        // Nothing to recognize
+        return;
     }
 
-    if (!frame.empty())
+    switch (stage)
     {
-        oldX = frame.cols;
-        oldY = frame.rows;
+    case STAGE_RESIZE:
+        this->ResizeStage(state);
+        break;
+    case STAGE_TRACKING:
+        this->TrackingStage(state);
+        break;
+    case STAGE_SCENE:
+        this->SceneStage(state);
+        break;
+    case STAGE_MATCHING:
+        this->MatchingStage(state);
+        break;
+    }
+}
 
-        // Shrink the image with a given scale factor or a given output width. Use this list for good 16:9 image sizes:
-        // https://antifreezedesign.wordpress.com/2011/05/13/permutations-of-1920x1080-for-perfect-scaling-at-1-77/
-        Util::ResizeImage(frame, this->scaling);
-        sceneModel->Image(frame);
+void Companion::Processing::Recognition::MatchRecognition::ResizeStage(PTR_FRAME_STATE state)
+{
+    PTR_MODEL_FEATURE_MATCHING sceneModel = std::make_shared<MODEL_FEATURE_MATCHING>();
+    cv::Mat frame = state->Frame();
+    cv::Mat gray;
 
-        featureMatching = std::dynamic_pointer_cast<FEATURE_MATCHING>(this->matchingAlgo);
-        if (featureMatching != nullptr)
+    // Shrink the image with a given scale factor or a given output width. Use this list for good 16:9 image sizes:
+    // https://antifreezedesign.wordpress.com/2011/05/13/permutations-of-1920x1080-for-perfect-scaling-at-1-77/
+    Util::ResizeImage(frame, this->scaling);
+    sceneModel->Image(frame);
+
+    state->Frame(frame);
+    state->Scene(sceneModel);
+    // Each stream matches with its own models, they keep state between frames
+    state->Models(this->streamModels->Models(state->Stream(), this->Models()));
+
+    if (this->IsTrackingUsed())
+    {
+        gray = frame;
+        if (gray.channels() > 1)
         {
-            // Matching algorithm is feature matching
-            // Pre calculate full image scene model keypoints
-            featureMatching->CalculateKeyPoints(sceneModel);
+            cv::cvtColor(gray, gray, CV_BGR2GRAY);
         }
+        state->Gray(gray);
+    }
+}
+
+void Companion::Processing::Recognition::MatchRecognition::TrackingStage(PTR_FRAME_STATE state)
+{
+    const std::vector<PTR_MODEL_FEATURE_MATCHING>& models = state->Models();
+    std::vector<PTR_MODEL_FEATURE_MATCHING> recognitionModels;
+    std::vector<PTR_RESULT> trackedResults;
+    const cv::Mat& frame = state->Frame();
+
+    if (!this->IsTrackingUsed() || state->Gray().empty())
+    {
+        return;
+    }
 
-        if (this->shapeDetection != nullptr)
+    // Track all objects which were recognized before, only objects which are not tracked are recognized
+    trackedResults = std::vector<PTR_RESULT>(models.size(), nullptr);
+    Companion::Thread::TaskPool::Shared()->ParallelFor(static_cast<int>(models.size()), [&](int x, int)
+    {
+        PTR_MODEL_FEATURE_MATCHING objectModel = models.at(x);
+        // Frames can be processed concurrently, serialize the state updates of this model
+        std::lock_guard<std::mutex> lock(objectModel->Mutex());
+        if (!this->tracking->IsKeyframe(objectModel))
         {
-            // If shape detection should be used obtain all possible ROIs from frame
-            rois = this->shapeDetection->ExecuteAlgorithm(sceneModel->Image());
+            Companion::Thread::StageTimer timer(TimingStage::TRACKING, objectModel->ID());
+            PTR_DRAW_FRAME trackedFrame = this->tracking->Track(state->Gray(), objectModel);
+            if (trackedFrame != nullptr)
+            {
+                PTR_IMAGE_REDUCTION_ALGORITHM ira = objectModel->Ira();
+                if (ira->IsObjectRecognized())
+                {
+                    // Advance the motion model by this frame, so the next keyframe predicts with the tracked motion
+                    cv::Point2f center = (cv::Point2f(trackedFrame->TopLeft()) + cv::Point2f(trackedFrame->BottomRight())) * 0.5f;
+                    ira->Predict(frame.size(), state->Scene());
+                    ira->Correct(center, state->Scene());
+                }
+                trackedFrame->Ratio(frame.cols, frame.rows, state->OriginalWidth(), state->OriginalHeight());
+                trackedResults[x] = std::make_shared<RESULT_RECOGNITION>(100, objectModel->ID(), trackedFrame);
+            }
         }
+    });
 
-        if (this->matchingAlgo->IsCuda())
+    for (size_t x = 0; x < models.size(); x++)
+    {
+        if (trackedResults[x] != nullptr)
+        {
+            state->AddResult(trackedResults[x]);
+        }
+        else
         {
-            for (size_t x = 0; x < models.size(); x++)
+            recognitionModels.push_back(models.at(x));
+        }
+    }
+
+    state->Models(recognitionModels);
+}
+
+void Companion::Processing::Recognition::MatchRecognition::SceneStage(PTR_FRAME_STATE state)
+{
+    PTR_FEATURE_MATCHING featureMatching;
+
+    if (state->Models().empty())
+    {
+        // All objects are tracked
+        return;
+    }
+
+    featureMatching = std::dynamic_pointer_cast<FEATURE_MATCHING>(this->matchingAlgo);
+    if (featureMatching != nullptr)
+    {
+        // Matching algorithm is feature matching
+        // Pre calculate full image scene features once, they are shared read-only by all models
+        featureMatching->CalculateSceneFeatures(state->Scene());
+    }
+
+    if (this->shapeDetection != nullptr)
+    {
+        // If shape detection should be used obtain all possible ROIs from frame
+        state->Rois(this->shapeDetection->ExecuteAlgorithm(state->Scene()->Image()));
+    }
+}
+
+void Companion::Processing::Recognition::MatchRecognition::MatchingStage(PTR_FRAME_STATE state)
+{
+    const std::vector<PTR_MODEL_FEATURE_MATCHING>& recognitionModels = state->Models();
+    const std::vector<PTR_DRAW_FRAME>& rois = state->Rois();
+    PTR_TASK_POOL pool = Companion::Thread::TaskPool::Shared();
+    std::vector<std::vector<Companion::Error::Code>> parallelizedErrors;
+    std::vector<PTR_RESULT> modelResults;
+    std::vector<char> failed;
+    std::vector<char> skipped;
+    std::vector<Companion::Error::Code> errors;
+    std::atomic<bool> expired(false);
+    bool useTracking = this->IsTrackingUsed();
+    size_t models = recognitionModels.size();
+    size_t regions = rois.empty() ? 1 : rois.size();
+
+    // Each model is an individual task, every worker writes to its own buffers or to the slots of its model
+    parallelizedErrors = std::vector<std::vector<Companion::Error::Code>>(pool->Concurrency());
+    modelResults = std::vector<PTR_RESULT>(models, nullptr);
+    failed = std::vector<char>(models, false);
+    skipped = std::vector<char>(models, false);
+
+    std::function<void(int, int)> match = [&](int x, int slot)
+    {
+        // Matching updates the model state, the ROIs of a model are evaluated in order so the model state and the
+        // kept recognition do not depend on scheduling
+        std::lock_guard<std::mutex> lock(recognitionModels.at(x)->Mutex());
+
+        for (size_t r = 0; r < regions; r++)
+        {
+            if (expired || state->Expired())
             {
-                Processing(sceneModel,
-                    models.at(x),
-                    rois,
-                    frame,
-                    oldX,
-                    oldY,
-                    parallelizedResults[omp_get_thread_num()]);
+                // Deadline has passed, remaining evaluations are abandoned and the frame returns partial results
+                expired = true;
+                skipped[x] = true;
+                return;
+            }
+
+            try
+            {
+                PTR_RESULT result = Processing(state->Scene(),
+                    recognitionModels.at(x),
+                    rois.empty() ? nullptr : rois.at(r),
+                    state->Frame(),
+                    state->OriginalWidth(),
+                    state->OriginalHeight());
+
+                if (result != nullptr)
+                {
+                    // Keep the recognition of the last ROI, it belongs to the state the model is left in
+                    modelResults[x] = result;
+                }
+            }
+            catch (Companion::Error::Code errorCode)
+            {
+                failed[x] = true;
+                parallelizedErrors[slot].push_back(errorCode);
             }
         }
-        else
+    };
+
+    if (this->matchingAlgo->IsCuda())
+    {
+        // Cuda matching is not parallelized, the last slot belongs to the calling thread
+        for (size_t x = 0; x < models; x++)
         {
-            errors.clear();
-            #pragma omp parallel for
-            for (int x = 0; x < models.size(); x++)
+            match(static_cast<int>(x), pool->Concurrency() - 1);
+        }
+    }
+    else
+    {
+        pool->ParallelFor(static_cast<int>(models), match);
+    }
+
+    if (useTracking)
+    {
+        pool->ParallelFor(static_cast<int>(models), [&](int x, int slot)
+        {
+            if (failed[x] || skipped[x])
+            {
+                // Tracking state of models with errors or without a complete evaluation is left unchanged
+                return;
+            }
+
+            try
             {
-                try
+                std::lock_guard<std::mutex> lock(recognitionModels.at(x)->Mutex());
+                Companion::Thread::StageTimer timer(TimingStage::TRACKING, recognitionModels.at(x)->ID());
+                if (modelResults[x] != nullptr)
                 {
-                    Processing(sceneModel,
-                        models.at(x),
-                        rois,
-                        frame,
-                        oldX,
-                        oldY,
-                        parallelizedResults[omp_get_thread_num()]);
+                    // Keyframe, track the recognition inliers from now on
+                    this->tracking->Start(state->Gray(), recognitionModels.at(x));
                 }
-                catch (Companion::Error::Code errorCode)
+                else
                 {
-                    #pragma omp critical
-                    errors.push_back(errorCode);
+                    this->tracking->Stop(recognitionModels.at(x));
                 }
             }
-
-            if (!errors.empty())
+            catch (Companion::Error::Code errorCode)
             {
-                throw Companion::Error::CompanionException(errors);
+                parallelizedErrors[slot].push_back(errorCode);
             }
-        }
+        });
+    }
+
+    for (size_t i = 0; i < parallelizedErrors.size(); i++)
+    {
+        errors.insert(errors.end(), parallelizedErrors[i].begin(), parallelizedErrors[i].end());
+    }
+
+    if (!errors.empty())
+    {
+        throw Companion::Error::CompanionException(errors);
+    }
 
-        frame.release();
+    if (expired)
+    {
+        // Marks tracked results and the following recognition results
+        state->Partial(true);
     }
 
-    #pragma omp critical
-    for (int i = 0; i < threads; i++) 
+    for (size_t x = 0; x < models; x++)
     {
-        for (int j = 0; j < parallelizedResults[i].size(); j++) 
+        if (modelResults[x] != nullptr)
         {
-            results.push_back(parallelizedResults[i].at(j));
+            state->AddResult(modelResults[x]);
         }
     }
-
-    return results;
 }
 
-void Companion::Processing::Recognition::MatchRecognition::Processing(PTR_MODEL_FEATURE_MATCHING sceneModel,
-	PTR_MODEL_FEATURE_MATCHING objectModel,
-    std::vector<PTR_DRAW_FRAME> rois,
-    cv::Mat frame,
-    int originalX,
-    int originalY,
-    CALLBACK_RESULT &results)
+std::vector<PTR_FRAME_STATE> Companion::Processing::Recognition::MatchRecognition::ExecuteBatch(const std::vector<cv::Mat>& frames)
 {
-	PTR_RESULT result = nullptr;
+    PTR_TASK_POOL pool = Companion::Thread::TaskPool::Shared();
+    PTR_FEATURE_MATCHING featureMatching = std::dynamic_pointer_cast<FEATURE_MATCHING>(this->matchingAlgo);
+    std::vector<PTR_FRAME_STATE> states(frames.size());
+    // Models can be changed while the batch runs, all images use the models of the batch start
+    std::vector<PTR_MODEL_FEATURE_MATCHING> recognitionModels = this->Models();
+    size_t models = recognitionModels.size();
+    size_t chunk = static_cast<size_t>(pool->Concurrency()) * BATCH_IMAGES_PER_WORKER;
+    // Shared models of each worker, reused for all images of the batch
+    std::vector<std::vector<PTR_MODEL_FEATURE_MATCHING>> views;
+    // Image buffers of each chunk position and each worker, reused for all chunks
+    std::vector<cv::Mat> resized(chunk);
+    std::vector<cv::Mat> edges(pool->Concurrency());
+    std::vector<PTR_RESULT> results;
+    std::vector<std::vector<std::pair<size_t, Companion::Error::Code>>> errors;
 
-    if (!objectModel)
+    if (this->matchingAlgo->IsCuda())
     {
-        // If wrong model types are used
-        throw Companion::Error::Code::wrong_model_type;
+        // Cuda matching is not parallelized
+        return ImageProcessing::ExecuteBatch(frames);
     }
 
-    if (rois.size() == 0)
+    views = std::vector<std::vector<PTR_MODEL_FEATURE_MATCHING>>(pool->Concurrency(),
+        std::vector<PTR_MODEL_FEATURE_MATCHING>(models, nullptr));
+    errors = std::vector<std::vector<std::pair<size_t, Companion::Error::Code>>>(pool->Concurrency());
+
+    for (size_t begin = 0; begin < frames.size(); begin += chunk)
     {
-        try 
-        {
-            // If ROIs not found or used
-            result = std::shared_ptr<RESULT>(this->matchingAlgo->ExecuteAlgorithm(sceneModel, objectModel, nullptr));
-        }
-        catch (Companion::Error::Code errorCode)
+        size_t count = std::min(chunk, frames.size() - begin);
+
+        // Prepare the scene of each image once, it is shared read-only by all models
+        pool->ParallelFor(static_cast<int>(count), [&](int i, int slot)
         {
-            throw errorCode;
-        }
-    }
-    else
-    {
-        size_t index = 0;
-        // If ROIs found
-        while (index < rois.size())
+            size_t index = begin + i;
+            PTR_FRAME_STATE state = std::make_shared<FRAME_STATE>(frames[index], index);
+            states[index] = state;
+
+            if (frames[index].empty())
+            {
+                // Nothing to recognize
+                return;
+            }
+
+            try
+            {
+                PTR_MODEL_FEATURE_MATCHING sceneModel = std::make_shared<MODEL_FEATURE_MATCHING>();
+                Util::ResizeImage(frames[index], resized[i], this->scaling);
+                sceneModel->Image(resized[i]);
+                state->Frame(resized[i]);
+                state->Scene(sceneModel);
+
+                if (featureMatching != nullptr)
+                {
+                    featureMatching->CalculateSceneFeatures(sceneModel);
+                }
+
+                if (this->shapeDetection != nullptr)
+                {
+                    state->Rois(this->shapeDetection->ExecuteAlgorithm(resized[i], edges[slot]));
+                }
+            }
+            catch (Companion::Error::Code errorCode)
+            {
+                state->AddError(errorCode);
+            }
+        });
+
+        // Each image and model pair is an individual task, every task writes only its own result
+        results = std::vector<PTR_RESULT>(count * models, nullptr);
+        pool->ParallelFor(static_cast<int>(count * models), [&](int task, int slot)
         {
-            try 
+            PTR_FRAME_STATE state = states[begin + task / models];
+            size_t x = task % models;
+            PTR_MODEL_FEATURE_MATCHING& view = views[slot][x];
+            const std::vector<PTR_DRAW_FRAME>& rois = state->Rois();
+
+            if (state->Scene() == nullptr || !state->Errors().empty())
+            {
+                return;
+            }
+
+            if (view == nullptr)
+            {
+                view = recognitionModels.at(x)->Share();
+            }
+            else
             {
-                result = std::shared_ptr<RESULT>(this->matchingAlgo->ExecuteAlgorithm(sceneModel, objectModel, rois.at(index)));
+                // Images of a batch are independent, forget the state of the last image
+                view->Ira()->Clear();
+                view->Homography(cv::Mat());
+                view->Tracking()->Clear();
+            }
+
+            try
+            {
+                if (rois.empty())
+                {
+                    results[task] = Processing(state->Scene(), view, nullptr, state->Frame(), state->OriginalWidth(), state->OriginalHeight());
+                }
+
+                for (size_t roi = 0; roi < rois.size(); roi++)
+                {
+                    PTR_RESULT result = Processing(state->Scene(), view, rois.at(roi), state->Frame(), state->OriginalWidth(), state->OriginalHeight());
+                    if (result != nullptr)
+                    {
+                        results[task] = result;
+                    }
+                }
             }
             catch (Companion::Error::Code errorCode)
             {
-                throw errorCode;
+                errors[slot].push_back(std::make_pair(begin + task / models, errorCode));
+            }
+        });
+
+        for (size_t i = 0; i < errors.size(); i++)
+        {
+            for (size_t j = 0; j < errors[i].size(); j++)
+            {
+                states[errors[i].at(j).first]->AddError(errors[i].at(j).second);
             }
-            index++;
+            errors[i].clear();
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            PTR_FRAME_STATE state = states[begin + i];
+            for (size_t x = 0; x < models; x++)
+            {
+                if (results[i * models + x] != nullptr)
+                {
+                    state->AddResult(results[i * models + x]);
+                }
+            }
+
+            // Release the scene of this chunk, so its image buffer is reused by the next chunk
+            state->Frame(frames[begin + i]);
+            state->Scene(nullptr);
+            state->Rois(std::vector<PTR_DRAW_FRAME>());
         }
     }
 
+    return states;
+}
+
+bool Companion::Processing::Recognition::MatchRecognition::IsTrackingUsed() const
+{
+    return this->tracking != nullptr && !this->matchingAlgo->IsCuda();
+}
+
+void Companion::Processing::Recognition::MatchRecognition::Tracking(PTR_KLT_TRACKING tracking)
+{
+    this->tracking = tracking;
+}
+
+PTR_RESULT Companion::Processing::Recognition::MatchRecognition::Processing(PTR_MODEL_FEATURE_MATCHING sceneModel,
+	PTR_MODEL_FEATURE_MATCHING objectModel,
+    PTR_DRAW_FRAME roi,
+    cv::Mat frame,
+    int originalX,
+    int originalY)
+{
+	PTR_RESULT result = nullptr;
+
+    if (!objectModel)
+    {
+        // If wrong model types are used
+        throw Companion::Error::Code::wrong_model_type;
+    }
+
+    // Search in the ROI or the full scene if no ROI is used
+    result = std::shared_ptr<RESULT>(this->matchingAlgo->ExecuteAlgorithm(sceneModel, objectModel, roi));
+
     if (result != nullptr)
     {
         // Create old image size
         result->Drawable()->Ratio(frame.cols, frame.rows, originalX, originalY);
-        // Store recognized object and its ID to vector.
-        results.push_back(result);
     }
+
+    return result;
 }
 
 bool Companion::Processing::Recognition::MatchRecognition::AddModel(PTR_MODEL_FEATURE_MATCHING model)
 {
+    PTR_FEATURE_MATCHING featureMatching;
 
     if (!model->Image().empty())
     {
+        featureMatching = std::dynamic_pointer_cast<FEATURE_MATCHING>(this->matchingAlgo);
+        if (featureMatching != nullptr)
+        {
+            // Prepare model features and its matcher index only once
+            featureMatching->TrainModel(model);
+        }
+
+        std::lock_guard<std::mutex> lock(this->modelsMutex);
         this->models.push_back(model);
         return true;
     }
@@ -199,10 +513,12 @@ bool Companion::Processing::Recognition::MatchRecognition::AddModel(PTR_MODEL_FE
 
 bool Companion::Processing::Recognition::MatchRecognition::RemoveModel(int modelID)
 {
+    std::lock_guard<std::mutex> lock(this->modelsMutex);
     for (size_t index = 0; index < this->models.size(); index++)
     {
         if (this->models.at(index)->ID() == modelID) {
             this->models.erase(this->models.begin() + index);
+            this->streamModels->Clear();
             return true;
         }
     }
@@ -211,5 +527,13 @@ bool Companion::Processing::Recognition::MatchRecognition::RemoveModel(int model
 
 void Companion::Processing::Recognition::MatchRecognition::ClearModels()
 {
+    std::lock_guard<std::mutex> lock(this->modelsMutex);
     this->models.clear();
+    this->streamModels->Clear();
+}
+
+std::vector<PTR_MODEL_FEATURE_MATCHING> Companion::Processing::Recognition::MatchRecognition::Models()
+{
+    std::lock_guard<std::mutex> lock(this->modelsMutex);
+    return this->models;
 }
@@ -19,15 +19,19 @@
 #ifndef COMPANION_MATCHRECOGNITION_H
 #define COMPANION_MATCHRECOGNITION_H
 
+#include <atomic>
+#include <mutex>
 #include <opencv2/core/core.hpp>
 #include <companion/processing/ImageProcessing.h>
 #include <companion/model/processing/FeatureMatchingModel.h>
+#include <companion/model/processing/StreamModels.h>
 #include <companion/draw/Drawable.h>
 #include <companion/util/CompanionException.h>
 #include <companion/algo/recognition/matching/FeatureMatching.h>
 #include <companion/algo/detection/ShapeDetection.h>
+#include <companion/algo/tracking/KLTTracking.h>
 #include <companion/Configuration.h>
-#include <omp.h>
+#include <companion/thread/TaskPool.h>
 
 namespace Companion {
 	namespace Processing {
@@ -76,6 +80,13 @@ namespace Companion {
 				 */
 				void ClearModels();
 
+				/**
+				 * Set the tracking algorithm to track recognized objects between keyframes instead of recognizing them in
+				 * every frame. Tracking is only used with cpu based matching algorithms.
+				 * @param tracking Tracking algorithm to use, nullptr disables tracking.
+				 */
+				void Tracking(PTR_KLT_TRACKING tracking);
+
 				/**
 				 * Try to recognize all objects in the given frame.
 				 * @param frame Frame to check for an object location.
@@ -83,8 +94,63 @@ namespace Companion {
 				 */
 				CALLBACK_RESULT Execute(cv::Mat frame);
 
+				/**
+				 * Get number of stages, match recognition is split into resizing, tracking, scene feature extraction and
+				 * per model matching.
+				 * @return Number of stages.
+				 */
+				int Stages() const;
+
+				/**
+				 * Execute a single stage of the recognition for the given frame.
+				 * @param stage Stage to execute.
+				 * @param state State of the frame which is passed from stage to stage.
+				 * @throws Companion::Error::CompanionException if matching of a model fails.
+				 */
+				void ExecuteStage(int stage, PTR_FRAME_STATE state);
+
+				/**
+				 * Execute the recognition for a batch of independent images. Images and models are matched concurrently
+				 * by the task pool, each worker matches with its own shared models and reuses its image buffers for all
+				 * images of the batch. Images do not influence each other, tracking and IRA are not used.
+				 * @param frames Source images.
+				 * @return State of each image at the index of the image, which contains its results and errors.
+				 */
+				std::vector<PTR_FRAME_STATE> ExecuteBatch(const std::vector<cv::Mat>& frames);
+
 			private:
 
+				/**
+				 * Stage to resize the frame and prepare the scene model.
+				 */
+				static constexpr int STAGE_RESIZE = 0;
+
+				/**
+				 * Stage to track objects which were recognized before.
+				 */
+				static constexpr int STAGE_TRACKING = 1;
+
+				/**
+				 * Stage to calculate scene features and regions of interest.
+				 */
+				static constexpr int STAGE_SCENE = 2;
+
+				/**
+				 * Stage to match all objects which are not tracked.
+				 */
+				static constexpr int STAGE_MATCHING = 3;
+
+				/**
+				 * Number of stages.
+				 */
+				static constexpr int STAGES = 4;
+
+				/**
+				 * Number of images per worker whose scenes are prepared at once by a batch, bounds the memory of the
+				 * cached scene features.
+				 */
+				static constexpr int BATCH_IMAGES_PER_WORKER = 4;
+
 				/**
 				 * Scaling value to resize image.
 				 */
@@ -100,28 +166,80 @@ namespace Companion {
 				 */
 				PTR_SHAPE_DETECTION shapeDetection;
 
+				/**
+				 * Tracking algorithm, not used if nullptr.
+				 */
+				PTR_KLT_TRACKING tracking;
+
 				/**
 				 * Feature matching models.
 				 */
 				std::vector<PTR_MODEL_FEATURE_MATCHING> models;
 
 				/**
-				 * Processing method to recognize objects.
+				 * Shared models of each stream, so every stream keeps its own state between frames.
+				 */
+				PTR_STREAM_MODELS streamModels;
+
+				/**
+				 * Mutex to guard the models, frames obtain a copy of the models and never read them directly.
+				 */
+				std::mutex modelsMutex;
+
+				/**
+				 * Resize the frame and create its scene model and gray scale image.
+				 * @param state State of the frame.
+				 */
+				void ResizeStage(PTR_FRAME_STATE state);
+
+				/**
+				 * Track all objects which are not due for a keyframe, only untracked objects remain to be recognized.
+				 * @param state State of the frame.
+				 */
+				void TrackingStage(PTR_FRAME_STATE state);
+
+				/**
+				 * Calculate the scene features and regions of interest if objects remain to be recognized.
+				 * @param state State of the frame.
+				 */
+				void SceneStage(PTR_FRAME_STATE state);
+
+				/**
+				 * Match all remaining objects against the scene. Once the deadline of the frame has passed the remaining
+				 * objects are not evaluated and the frame is marked as partial.
+				 * @param state State of the frame.
+				 * @throws Companion::Error::CompanionException if matching of a model fails.
+				 */
+				void MatchingStage(PTR_FRAME_STATE state);
+
+				/**
+				 * Check if tracking is used.
+				 * @return <code>True</code> if a tracking algorithm is set and a cpu based matching algorithm is used.
+				 */
+				bool IsTrackingUsed() const;
+
+				/**
+				 * Processing method to recognize an object in a single region of interest.
 				 * @param sceneModel Scene model to check.
 				 * @param objectModel Object model to search in scene.
-				 * @param rois List of ROIs if existent.
+				 * @param roi ROI to search in or nullptr to search the full scene.
 				 * @param frame Scene frame.
 				 * @param originalX Original width of the scene frame.
 				 * @param originalY Original height of the scene frame.
-				 * @param results List of all recognized objects.
+				 * @return Recognized object or nullptr if the object is not found.
 				 */
-				void Processing(PTR_MODEL_FEATURE_MATCHING sceneModel,
+				PTR_RESULT Processing(PTR_MODEL_FEATURE_MATCHING sceneModel,
 					PTR_MODEL_FEATURE_MATCHING objectModel,
-					std::vector<PTR_DRAW_FRAME> rois,
+					PTR_DRAW_FRAME roi,
 					cv::Mat frame,
 					int originalX,
-					int originalY,
-					CALLBACK_RESULT& results);
+					int originalY);
+
+				/**
+				 * Get a copy of the current models, which is not affected by later model changes.
+				 * @return Feature matching models.
+				 */
+				std::vector<PTR_MODEL_FEATURE_MATCHING> Models();
 			};
 		}
 	}
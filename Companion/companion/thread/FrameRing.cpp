@@ -0,0 +1,136 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FrameRing.h"
+
+Companion::Thread::FrameRing::FrameRing(int capacity)
+{
+	// A single slot could not distinguish a written slot from a free slot of the next round
+	this->capacity = capacity < 2 ? 2 : static_cast<size_t>(capacity);
+	this->slots = std::unique_ptr<Slot[]>(new Slot[this->capacity]);
+	for (size_t i = 0; i < this->capacity; i++)
+	{
+		this->slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	this->writePosition.store(0, std::memory_order_relaxed);
+	this->readPosition.store(0, std::memory_order_relaxed);
+}
+
+bool Companion::Thread::FrameRing::TryPush(cv::Mat& frame, std::chrono::steady_clock::time_point captured)
+{
+	Slot* slot;
+	size_t position = this->writePosition.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		slot = &this->slots[position % this->capacity];
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+		if (difference == 0)
+		{
+			// Slot is free for this position, claim it
+			if (this->writePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Slot still holds an unread frame of the previous round, ring is full
+			return false;
+		}
+		else
+		{
+			// Another producer claimed this position
+			position = this->writePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	std::swap(slot->frame, frame);
+	slot->captured = captured;
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+bool Companion::Thread::FrameRing::TryPop(cv::Mat& frame, unsigned long& sequence)
+{
+	std::chrono::steady_clock::time_point captured;
+	return this->TryPop(frame, sequence, captured);
+}
+
+bool Companion::Thread::FrameRing::TryPop(cv::Mat& frame, unsigned long& sequence, std::chrono::steady_clock::time_point& captured)
+{
+	Slot* slot;
+	size_t position = this->readPosition.load(std::memory_order_relaxed);
+
+	while (true)
+	{
+		slot = &this->slots[position % this->capacity];
+		size_t slotSequence = slot->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(slotSequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+		if (difference == 0)
+		{
+			// Slot holds the frame for this position, claim it
+			if (this->readPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Frame for this position is not written yet, ring is empty
+			return false;
+		}
+		else
+		{
+			// Another consumer claimed this position
+			position = this->readPosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (!IsUnique(frame))
+	{
+		// Buffer is still referenced, for example by a result callback, do not recycle it
+		frame.release();
+	}
+	std::swap(slot->frame, frame);
+	sequence = static_cast<unsigned long>(position);
+	captured = slot->captured;
+	slot->sequence.store(position + this->capacity, std::memory_order_release);
+	return true;
+}
+
+size_t Companion::Thread::FrameRing::Size() const
+{
+	size_t write = this->writePosition.load(std::memory_order_relaxed);
+	size_t read = this->readPosition.load(std::memory_order_relaxed);
+	return write > read ? write - read : 0;
+}
+
+size_t Companion::Thread::FrameRing::Capacity() const
+{
+	return this->capacity;
+}
+
+bool Companion::Thread::FrameRing::IsUnique(const cv::Mat& frame)
+{
+	// Frames without allocation data wrap external memory which must not be overwritten
+	return frame.data == nullptr || (frame.u != nullptr && frame.u->refcount == 1);
+}
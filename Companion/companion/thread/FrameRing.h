@@ -0,0 +1,142 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_FRAMERING_H
+#define COMPANION_FRAMERING_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <opencv2/core/core.hpp>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Thread
+	{
+		/**
+		 * Bounded lock-free multi producer multi consumer ring of preallocated frame slots.
+		 *
+		 * Frames are exchanged with the slots instead of copied, a producer receives the buffer of an already consumed
+		 * frame back and can decode the next image directly into it. In steady state no image memory is allocated and
+		 * the hand-off costs two atomic operations. Buffers which are still referenced elsewhere are never recycled.
+		 * @author Andreas Sekulski, Dimitri Kotlovsky
+		 */
+		class COMP_EXPORTS FrameRing
+		{
+
+		public:
+
+			/**
+			 * Create a ring with a fixed number of frame slots.
+			 * @param capacity Number of frames which can be stored, at least two slots are used.
+			 */
+			FrameRing(int capacity);
+
+			/**
+			 * Try to store a frame. On success the frame is exchanged with the buffer of the slot, so the given frame
+			 * contains a recycled buffer (or is empty) afterwards.
+			 * @param frame Frame to store, receives a recycled buffer to decode the next frame into.
+			 * @param captured Capture time of the frame.
+			 * @return <code>True</code> if the frame was stored, <code>false</code> if the ring is full.
+			 */
+			bool TryPush(cv::Mat& frame, std::chrono::steady_clock::time_point captured = std::chrono::steady_clock::time_point());
+
+			/**
+			 * Try to obtain the oldest frame. On success the given frame is exchanged with the buffer of the slot, its
+			 * old buffer is recycled for the producer if it is not referenced anywhere else.
+			 * @param frame Frame to store the obtained frame to.
+			 * @param sequence Sequence number of the obtained frame, frames are numbered in the order they were stored.
+			 * @return <code>True</code> if a frame was obtained, <code>false</code> if the ring is empty.
+			 */
+			bool TryPop(cv::Mat& frame, unsigned long& sequence);
+
+			/**
+			 * Try to obtain the oldest frame together with its capture time.
+			 * @param frame Frame to store the obtained frame to.
+			 * @param sequence Sequence number of the obtained frame, frames are numbered in the order they were stored.
+			 * @param captured Capture time of the obtained frame.
+			 * @return <code>True</code> if a frame was obtained, <code>false</code> if the ring is empty.
+			 */
+			bool TryPop(cv::Mat& frame, unsigned long& sequence, std::chrono::steady_clock::time_point& captured);
+
+			/**
+			 * Get approximate number of stored frames.
+			 * @return Number of stored frames, may be outdated if other threads use the ring concurrently.
+			 */
+			size_t Size() const;
+
+			/**
+			 * Get number of frame slots.
+			 * @return Number of frame slots.
+			 */
+			size_t Capacity() const;
+
+		private:
+
+			/**
+			 * Frame slot with its sequence number, which determines if the slot can be written or read for a position.
+			 */
+			struct Slot
+			{
+				/**
+				 * Position for which this slot can be written, or position + 1 if it can be read.
+				 */
+				std::atomic<size_t> sequence;
+
+				/**
+				 * Frame buffer of this slot.
+				 */
+				cv::Mat frame;
+
+				/**
+				 * Capture time of the frame of this slot.
+				 */
+				std::chrono::steady_clock::time_point captured;
+			};
+
+			/**
+			 * Number of frame slots.
+			 */
+			size_t capacity;
+
+			/**
+			 * Preallocated frame slots.
+			 */
+			std::unique_ptr<Slot[]> slots;
+
+			/**
+			 * Next position to write, on its own cache line to avoid false sharing with consumers.
+			 */
+			alignas(64) std::atomic<size_t> writePosition;
+
+			/**
+			 * Next position to read, on its own cache line to avoid false sharing with the producer.
+			 */
+			alignas(64) std::atomic<size_t> readPosition;
+
+			/**
+			 * Check if the buffer of a frame is referenced only by the frame itself and can be overwritten.
+			 * @param frame Frame to check.
+			 * @return <code>True</code> if the buffer can be reused.
+			 */
+			static bool IsUnique(const cv::Mat& frame);
+		};
+	}
+}
+
+#endif //COMPANION_FRAMERING_H
@@ -0,0 +1,141 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SkipController.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr int Companion::Thread::SkipController::MAX_SKIP;
+constexpr double Companion::Thread::SkipController::SMOOTHING;
+constexpr int Companion::Thread::SkipController::CORRECTION_INTERVAL;
+
+Companion::Thread::SkipController::SkipController(int stages,
+	int consumers,
+	int capacity,
+	double targetRate,
+	int targetDepth,
+	int minSkip)
+{
+	this->consumers = std::max(consumers, 1);
+	this->capacity = std::max(capacity, 1);
+	this->targetRate = std::max(targetRate, 0.0);
+	this->targetDepth = std::min(std::max(targetDepth, 0), this->capacity);
+	this->minSkip = std::min(std::max(minSkip, 0), MAX_SKIP);
+	this->skip = this->minSkip;
+	this->correction = 0;
+	this->processed = 0;
+	this->inputInterval = 0;
+	this->depth = 0;
+	this->stageTimes = std::vector<double>(std::max(stages, 1), 0);
+}
+
+void Companion::Thread::SkipController::Obtained()
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lk(this->mx);
+
+	if (this->lastObtained != std::chrono::steady_clock::time_point())
+	{
+		Smooth(this->inputInterval, std::chrono::duration<double>(now - this->lastObtained).count());
+	}
+	this->lastObtained = now;
+}
+
+void Companion::Thread::SkipController::Buffered(size_t depth)
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+	Smooth(this->depth, static_cast<double>(depth));
+}
+
+void Companion::Thread::SkipController::Processed(int stage, std::chrono::nanoseconds duration)
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+
+	if (stage < 0 || stage >= static_cast<int>(this->stageTimes.size()))
+	{
+		return;
+	}
+
+	Smooth(this->stageTimes[stage], std::chrono::duration<double>(duration).count());
+
+	// The integral correction reacts slowly, otherwise it oscillates around the buffer which lags behind the skip rate
+	if (++this->processed >= CORRECTION_INTERVAL)
+	{
+		this->processed = 0;
+		if (this->depth > this->targetDepth + 0.5)
+		{
+			this->correction = std::min(this->correction + 1, MAX_SKIP);
+		}
+		else if (this->depth < this->targetDepth - 0.5)
+		{
+			this->correction = std::max(this->correction - 1, -MAX_SKIP);
+		}
+	}
+
+	this->Adjust();
+}
+
+int Companion::Thread::SkipController::Skip() const
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+	return this->skip;
+}
+
+double Companion::Thread::SkipController::InputRate() const
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+	return this->inputInterval > 0 ? 1.0 / this->inputInterval : 0;
+}
+
+double Companion::Thread::SkipController::ProcessingRate() const
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+	double slowest = *std::max_element(this->stageTimes.begin(), this->stageTimes.end());
+	return slowest > 0 ? this->consumers / slowest : 0;
+}
+
+void Companion::Thread::SkipController::Smooth(double& average, double value)
+{
+	average = average == 0 ? value : average + SMOOTHING * (value - average);
+}
+
+void Companion::Thread::SkipController::Adjust()
+{
+	int rateSkip = 0;
+	double slowest = *std::max_element(this->stageTimes.begin(), this->stageTimes.end());
+	double inputRate = this->inputInterval > 0 ? 1.0 / this->inputInterval : 0;
+	double outputRate = slowest > 0 ? this->consumers / slowest : 0;
+
+	if (this->targetRate > 0 && (outputRate == 0 || this->targetRate < outputRate))
+	{
+		outputRate = this->targetRate;
+	}
+
+	if (inputRate > 0 && outputRate > 0)
+	{
+		// Every (skip + 1)-th frame is stored, so skip + 1 frames arrive in the time one frame is processed
+		rateSkip = static_cast<int>(std::ceil(inputRate / outputRate - 1e-3)) - 1;
+	}
+
+	// Limit the correction to the reachable skip rates, it must not wind up while the skip rate is at a bound. A
+	// target rate is never exceeded by the correction.
+	this->correction = std::max(this->correction, this->targetRate > 0 ? 0 : this->minSkip - rateSkip);
+	this->correction = std::min(this->correction, MAX_SKIP - rateSkip);
+	this->skip = std::min(std::max(rateSkip + this->correction, this->minSkip), MAX_SKIP);
+}
@@ -0,0 +1,194 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_SKIPCONTROLLER_H
+#define COMPANION_SKIPCONTROLLER_H
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Thread
+	{
+		/**
+		 * Controller which adapts the skip frame rate of a stream worker to the current processing load.
+		 *
+		 * The skip rate is derived from the measured input rate of the streams and the rate the consumers can process,
+		 * limited to a target output rate if set. An integral correction holds the number of buffered frames at a target
+		 * depth, so estimation errors and load changes which the rates do not show yet are compensated. All methods
+		 * can be called concurrently by producers and consumers.
+		 * @author Andreas Sekulski, Dimitri Kotlovsky
+		 */
+		class COMP_EXPORTS SkipController
+		{
+
+		public:
+
+			/**
+			 * Create a skip controller.
+			 * @param stages Number of stages which report their processing time, the slowest stage limits the rate.
+			 * @param consumers Number of consumers which process frames of a stage concurrently.
+			 * @param capacity Number of frames which can be buffered.
+			 * @param targetRate Target output rate in frames per second, if targetRate <= 0 the output rate is only
+			 * limited by the processing time.
+			 * @param targetDepth Target number of buffered frames.
+			 * @param minSkip Minimum skip frame rate.
+			 */
+			SkipController(int stages,
+				int consumers,
+				int capacity,
+				double targetRate = 0,
+				int targetDepth = 1,
+				int minSkip = 0);
+
+			/**
+			 * Report a frame obtained from a stream, before it is skipped or stored.
+			 */
+			void Obtained();
+
+			/**
+			 * Report the number of buffered frames when a consumer obtains a frame.
+			 * @param depth Number of buffered frames.
+			 */
+			void Buffered(size_t depth);
+
+			/**
+			 * Report the processing time of a frame and adjust the skip frame rate.
+			 * @param stage Stage which has processed the frame, 0 if the image processing is not pipelined.
+			 * @param duration Processing time of the frame.
+			 */
+			void Processed(int stage, std::chrono::nanoseconds duration);
+
+			/**
+			 * Get current skip frame rate.
+			 * @return Number of frames which are skipped after each stored frame.
+			 */
+			int Skip() const;
+
+			/**
+			 * Get estimated input rate of all streams.
+			 * @return Obtained frames per second.
+			 */
+			double InputRate() const;
+
+			/**
+			 * Get estimated rate the consumers can process.
+			 * @return Processed frames per second, 0 if no frame was processed yet.
+			 */
+			double ProcessingRate() const;
+
+		private:
+
+			/**
+			 * Maximum skip frame rate.
+			 */
+			static constexpr int MAX_SKIP = 30;
+
+			/**
+			 * Weight of a new measurement in the moving averages.
+			 */
+			static constexpr double SMOOTHING = 0.1;
+
+			/**
+			 * Number of processed frames between two corrections of the buffered frames.
+			 */
+			static constexpr int CORRECTION_INTERVAL = 8;
+
+			/**
+			 * Mutex to update the estimates.
+			 */
+			mutable std::mutex mx;
+
+			/**
+			 * Number of consumers which process frames of a stage concurrently.
+			 */
+			int consumers;
+
+			/**
+			 * Number of frames which can be buffered.
+			 */
+			int capacity;
+
+			/**
+			 * Target output rate in frames per second, 0 if not set.
+			 */
+			double targetRate;
+
+			/**
+			 * Target number of buffered frames.
+			 */
+			double targetDepth;
+
+			/**
+			 * Minimum skip frame rate.
+			 */
+			int minSkip;
+
+			/**
+			 * Current skip frame rate.
+			 */
+			int skip;
+
+			/**
+			 * Integral correction of the skip frame rate to hold the target depth.
+			 */
+			int correction;
+
+			/**
+			 * Number of processed frames since the last correction.
+			 */
+			int processed;
+
+			/**
+			 * Moving average of the time between two obtained frames in seconds.
+			 */
+			double inputInterval;
+
+			/**
+			 * Time the last frame was obtained.
+			 */
+			std::chrono::steady_clock::time_point lastObtained;
+
+			/**
+			 * Moving average of the number of buffered frames.
+			 */
+			double depth;
+
+			/**
+			 * Moving average of the processing time of each stage in seconds.
+			 */
+			std::vector<double> stageTimes;
+
+			/**
+			 * Update a moving average with a new measurement.
+			 * @param average Moving average, 0 if no measurement was made yet.
+			 * @param value New measurement.
+			 */
+			static void Smooth(double& average, double value);
+
+			/**
+			 * Calculate the skip frame rate from the current estimates, must be called with the mutex held.
+			 */
+			void Adjust();
+		};
+	}
+}
+
+#endif //COMPANION_SKIPCONTROLLER_H
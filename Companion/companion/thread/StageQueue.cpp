@@ -0,0 +1,56 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StageQueue.h"
+
+Companion::Thread::StageQueue::StageQueue(int capacity)
+{
+	this->capacity = capacity <= 0 ? 1 : static_cast<size_t>(capacity);
+	this->closed = false;
+}
+
+void Companion::Thread::StageQueue::Push(PTR_FRAME_STATE state)
+{
+	std::unique_lock<std::mutex> lk(this->mx);
+	this->cv.wait(lk, [this] { return this->queue.size() < this->capacity; });
+	this->queue.push(state);
+	this->cv.notify_all();
+}
+
+bool Companion::Thread::StageQueue::Pop(PTR_FRAME_STATE& state)
+{
+	std::unique_lock<std::mutex> lk(this->mx);
+	this->cv.wait(lk, [this] { return this->closed || !this->queue.empty(); });
+
+	if (this->queue.empty())
+	{
+		return false;
+	}
+
+	state = this->queue.front();
+	this->queue.pop();
+	this->cv.notify_all();
+	return true;
+}
+
+void Companion::Thread::StageQueue::Close()
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+	this->closed = true;
+	this->cv.notify_all();
+}
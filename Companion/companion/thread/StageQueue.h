@@ -0,0 +1,95 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_STAGEQUEUE_H
+#define COMPANION_STAGEQUEUE_H
+
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <companion/model/processing/FrameState.h>
+#include <companion/util/Definitions.h>
+
+namespace Companion {
+	namespace Thread
+	{
+		/**
+		 * Bounded blocking queue to pass frames from one image processing stage to the next. A full queue blocks the
+		 * previous stage, so no stage can run ahead of a slower stage by more than the queue size.
+		 * @author Andreas Sekulski, Dimitri Kotlovsky
+		 */
+		class COMP_EXPORTS StageQueue
+		{
+
+		public:
+
+			/**
+			 * Create a bounded stage queue.
+			 * @param capacity Maximum number of frames in the queue, if capacity <= 0 one frame is used.
+			 */
+			StageQueue(int capacity = 1);
+
+			/**
+			 * Store a frame, waits while the queue is full.
+			 * @param state Frame to store.
+			 */
+			void Push(PTR_FRAME_STATE state);
+
+			/**
+			 * Obtain the oldest frame, waits while the queue is empty and not closed.
+			 * @param state Obtained frame.
+			 * @return <code>False</code> if the queue is closed and empty, <code>true</code> otherwise.
+			 */
+			bool Pop(PTR_FRAME_STATE& state);
+
+			/**
+			 * Close the queue, the next stage finishes after all stored frames are obtained.
+			 */
+			void Close();
+
+		private:
+
+			/**
+			 * Maximum number of frames in the queue.
+			 */
+			size_t capacity;
+
+			/**
+			 * Indicator if no more frames are stored.
+			 */
+			bool closed;
+
+			/**
+			 * Mutex to guard the queue.
+			 */
+			std::mutex mx;
+
+			/**
+			 * Condition to wait for a free place or a stored frame.
+			 */
+			std::condition_variable cv;
+
+			/**
+			 * Stored frames.
+			 */
+			std::queue<PTR_FRAME_STATE> queue;
+		};
+	}
+}
+
+#endif //COMPANION_STAGEQUEUE_H
@@ -0,0 +1,90 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StageTimer.h"
+
+namespace
+{
+	/**
+	 * Frame stats bound to the current thread, kept out of the exported classes because thread local data cannot be
+	 * exported from a shared library on all platforms.
+	 */
+	thread_local FRAME_STATS* currentStats = nullptr;
+}
+
+Companion::Thread::StageTimer::StageTimer(TimingStage stage, int model)
+{
+	this->stage = stage;
+	this->model = model;
+	this->stats = currentStats;
+	this->tracer = Tracer::Active();
+	if (this->stats != nullptr || this->tracer != nullptr)
+	{
+		this->start = std::chrono::steady_clock::now();
+	}
+}
+
+Companion::Thread::StageTimer::~StageTimer()
+{
+	this->Stop();
+}
+
+void Companion::Thread::StageTimer::Stop()
+{
+	if (this->stats == nullptr && this->tracer == nullptr)
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	if (this->stats != nullptr)
+	{
+		this->stats->Add(this->stage, end - this->start, this->model);
+	}
+	if (this->tracer != nullptr)
+	{
+		// Whole frame steps and model steps are separate categories, so they can be filtered in the timeline
+		const char* category = this->stage == TimingStage::PROCESSING ? "frame"
+			: (this->model != FRAME_STATS::NO_MODEL ? "model" : "stage");
+		this->tracer->Record(FRAME_STATS::Name(this->stage),
+			category,
+			this->start,
+			end,
+			this->stats != nullptr ? this->stats->Stream() : Tracer::NONE,
+			this->stats != nullptr ? static_cast<long long>(this->stats->Sequence()) : Tracer::NONE,
+			this->model != FRAME_STATS::NO_MODEL ? this->model : Tracer::NONE);
+	}
+	this->stats = nullptr;
+	this->tracer = nullptr;
+}
+
+FRAME_STATS* Companion::Thread::StageTimer::Stats()
+{
+	return currentStats;
+}
+
+Companion::Thread::StatsScope::StatsScope(FRAME_STATS* stats)
+{
+	this->previous = currentStats;
+	currentStats = stats;
+}
+
+Companion::Thread::StatsScope::~StatsScope()
+{
+	currentStats = this->previous;
+}
@@ -0,0 +1,132 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_STAGETIMER_H
+#define COMPANION_STAGETIMER_H
+
+#include <chrono>
+#include <companion/model/stream/FrameStats.h>
+#include <companion/thread/Tracer.h>
+#include <companion/util/Definitions.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Thread
+	{
+		/**
+		 * Scoped timer which adds the duration of a timed step to the frame stats bound to the current thread and records
+		 * it as span of the shared tracer if tracing is enabled.
+		 *
+		 * If no frame stats are bound and tracing is disabled the timer neither reads the clock nor records anything, so
+		 * instrumented code costs one thread local and one atomic load when stats are disabled.
+		 * @author Andreas Sekulski, Dimitri Kotlovsky
+		 */
+		class COMP_EXPORTS StageTimer
+		{
+
+		public:
+
+			/**
+			 * Start timing a step.
+			 * @param stage Timed step.
+			 * @param model ID of the model the step belongs to, FrameStats::NO_MODEL if it belongs to the whole frame.
+			 */
+			explicit StageTimer(TimingStage stage, int model = FRAME_STATS::NO_MODEL);
+
+			/**
+			 * Destructor, records the step if it was not stopped before.
+			 */
+			~StageTimer();
+
+			/**
+			 * Stop timing and record the step, later calls have no effect.
+			 */
+			void Stop();
+
+			/**
+			 * Get frame stats bound to the current thread.
+			 * @return Frame stats or nullptr if stats are disabled for the current thread.
+			 */
+			static FRAME_STATS* Stats();
+
+		private:
+
+			/**
+			 * Timed step.
+			 */
+			TimingStage stage;
+
+			/**
+			 * Model ID of the step.
+			 */
+			int model;
+
+			/**
+			 * Frame stats to record the step to, nullptr if disabled or stopped.
+			 */
+			FRAME_STATS* stats;
+
+			/**
+			 * Tracer to record the step to, nullptr if disabled or stopped.
+			 */
+			TRACER* tracer;
+
+			/**
+			 * Start time of the step.
+			 */
+			std::chrono::steady_clock::time_point start;
+
+			StageTimer(const StageTimer&) = delete;
+			StageTimer& operator=(const StageTimer&) = delete;
+		};
+
+		/**
+		 * Scope which binds frame stats to the current thread, the previously bound stats are restored at the end of
+		 * the scope. The task pool binds the stats of the calling thread to all tasks of a parallel loop.
+		 * @author Andreas Sekulski, Dimitri Kotlovsky
+		 */
+		class COMP_EXPORTS StatsScope
+		{
+
+		public:
+
+			/**
+			 * Bind frame stats to the current thread.
+			 * @param stats Frame stats to bind, nullptr disables stats inside this scope.
+			 */
+			explicit StatsScope(FRAME_STATS* stats);
+
+			/**
+			 * Destructor, restores the previously bound stats.
+			 */
+			~StatsScope();
+
+		private:
+
+			/**
+			 * Previously bound stats.
+			 */
+			FRAME_STATS* previous;
+
+			StatsScope(const StatsScope&) = delete;
+			StatsScope& operator=(const StatsScope&) = delete;
+		};
+	}
+}
+
+#endif //COMPANION_STAGETIMER_H
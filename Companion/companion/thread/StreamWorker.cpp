@@ -18,127 +18,678 @@
 
 #include "StreamWorker.h"
 
-Companion::Thread::StreamWorker::StreamWorker(int buffer, ColorFormat colorFormat)
+constexpr int Companion::Thread::StreamWorker::STAGE_QUEUE_SIZE;
+
+Companion::Thread::StreamWorker::StreamWorker(int buffer,
+	ColorFormat colorFormat,
+	BackpressurePolicy policy,
+	PTR_STREAM_METRICS metrics,
+	const std::vector<int>& weights)
 {
-	this->finished = false;
+	this->aborted = false;
+	this->waiting = 0;
+	this->deadline = std::chrono::milliseconds(0);
+	this->skipController = nullptr;
+	this->policy = policy;
+	this->metrics = metrics;
+	if (this->metrics == nullptr)
+	{
+		this->metrics = std::make_shared<STREAM_METRICS>();
+	}
 	this->colorFormat = colorFormat;
 	this->buffer = buffer;
 	if (this->buffer <= 0)
 	{
 		this->buffer = 1;
 	}
+
+	for (size_t i = 0; i < std::max(weights.size(), static_cast<size_t>(1)); i++)
+	{
+		std::unique_ptr<Channel> channel(new Channel());
+		channel->ring = std::make_shared<FRAME_RING>(this->buffer);
+		channel->weight = i < weights.size() && weights[i] > 0 ? weights[i] : 1;
+		channel->credit = 0;
+		channel->finished = false;
+		channel->producerWaiting = false;
+		channel->delivering = false;
+		channel->nextDelivery = 0;
+		this->channels.push_back(std::move(channel));
+	}
 }
 
-void Companion::Thread::StreamWorker::Produce(PTR_STREAM stream, int skipFrame, std::function<ERROR_CALLBACK> errorCallback)
+void Companion::Thread::StreamWorker::Produce(PTR_STREAM stream, int skipFrame, std::function<ERROR_CALLBACK> errorCallback, int streamID)
 {
 
 	int skipFrameNr = 0;
 	cv::Mat frame;
+	std::chrono::steady_clock::time_point captured;
+	Channel& channel = *this->channels.at(streamID);
+
+	Tracer::Shared()->ThreadName("producer " + std::to_string(streamID));
 
 	try
 	{
-		frame = stream->ObtainImage();
+		{
+			TraceSpan span("obtain", "stream", streamID);
+			stream->ObtainImage(frame, captured);
+		}
 
-		while (!stream->IsFinished())
+		while (!stream->IsFinished() && !this->aborted)
 		{
 
 			if (!frame.empty())
 			{
-				// If skip frame is not used...
-				if (skipFrame <= 0 && StoreFrame(frame))
+				this->metrics->FrameProduced();
+				if (this->skipController != nullptr)
+				{
+					// Skip frame rate follows the processing load
+					this->skipController->Obtained();
+					skipFrame = this->skipController->Skip();
+				}
+
+				// Store frame if skip frame is not used or the skip frame number is reached
+				if (skipFrameNr >= skipFrame)
 				{
-					// Obtain next frame to store
-					frame = stream->ObtainImage();
+					// The backpressure policy decides if the frame is stored, dropped or waits for a free slot
+					TraceSpan span("store", "stream", streamID);
+					StoreFrame(frame, captured, channel);
+					skipFrameNr = 0;
 				}
-				else if (skipFrame > 0)
+				else
 				{
-					// ... check if skip frame number is reached and If frame was stored
-					if (skipFrameNr == skipFrame && StoreFrame(frame))
-					{
-						// Obtain next frame to store
-						frame = stream->ObtainImage();
-						skipFrameNr = 0;
-					}
-					else if (skipFrameNr != skipFrame)
-					{
-						frame.release();
-						frame = stream->ObtainImage();
-						skipFrameNr++;
-					}
+					skipFrameNr++;
 				}
 			}
-			else
+
+			// Obtain next frame, decoded into the recycled or skipped buffer
+			TraceSpan span("obtain", "stream", streamID);
+			stream->ObtainImage(frame, captured);
+		}
+	}
+	catch (Error::Code error)
+	{
+		errorCallback(error);
+	}
+
+	// Consumers obtain the remaining frames and stop afterwards, also if the stream failed
+	std::lock_guard<std::mutex> lk(this->mx);
+	channel.finished = true;
+	this->cv.notify_all();
+}
+
+void Companion::Thread::StreamWorker::Consume(PTR_IMAGE_PROCESSING processing, std::function<ERROR_CALLBACK> errorCallback, std::function<STREAM_SUCCESS_CALLBACK> successCallback)
+{
+
+	unsigned long sequence;
+	int streamID;
+	cv::Mat frame;
+	cv::Mat resultBGR;
+	PTR_FRAME_STATE state;
+	std::chrono::steady_clock::time_point captured;
+
+	Tracer::Shared()->ThreadName("consumer");
+
+	while (this->ObtainFrame(frame, sequence, streamID, captured))
+	{
+		state = this->CreateState(frame, sequence, streamID, captured);
+		if (state == nullptr)
+		{
+			// Deadline has passed while the frame was buffered
+			continue;
+		}
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		try
+		{
+			// Consumers of all configurations share the task pool, only a bounded number processes frames at once
+			PoolAdmission admission(TaskPool::Shared());
+			// All steps of this frame are timed for its stats, also steps which run in the task pool
+			StatsScope scope(state->Stats().get());
+			StageTimer timer(TimingStage::PROCESSING);
+			StageTimer convertTimer(TimingStage::CONVERT);
+			Util::ConvertColor(frame, resultBGR, this->colorFormat);
+			convertTimer.Stop();
+			state->Source(resultBGR);
+			// Run the stages with the frame state, so the processing uses the state of this stream and its deadline
+			for (int stage = 0; stage < processing->Stages(); stage++)
+			{
+				processing->ExecuteStage(stage, state);
+			}
+		}
+		catch (Error::Code errorCode)
+		{
+			// Single error messages from processing
+			state->AddError(errorCode);
+		}
+		catch (Error::CompanionException ex)
+		{
+			// Multiple error messages only called by parallelized methods
+			while (ex.HasNext())
 			{
-				// If frames are empty loop
-				frame = stream->ObtainImage();
+				state->AddError(ex.Next());
 			}
 		}
 
-		std::lock_guard<std::mutex> lk(this->mx);
-		this->finished = true;
-		this->cv.notify_all();
+		this->Processed(0, std::chrono::steady_clock::now() - start);
+		this->DeliverState(state, errorCallback, successCallback);
 
+		// Frame buffer is kept and recycled by the ring with the next frame
+		state = nullptr;
+		resultBGR.release();
 	}
-	catch (Error::Code error)
+}
+
+void Companion::Thread::StreamWorker::Pipeline(int stages)
+{
+	this->stageQueues.clear();
+	for (int i = 0; i + 1 < stages; i++)
 	{
-		errorCallback(error);
+		this->stageQueues.push_back(std::make_shared<STAGE_QUEUE>(STAGE_QUEUE_SIZE));
 	}
 }
 
-void Companion::Thread::StreamWorker::Consume(PTR_IMAGE_PROCESSING processing, std::function<ERROR_CALLBACK> errorCallback, std::function<SUCCESS_CALLBACK> successCallback)
+void Companion::Thread::StreamWorker::ConsumeStage(int stage,
+	PTR_IMAGE_PROCESSING processing,
+	std::function<ERROR_CALLBACK> errorCallback,
+	std::function<STREAM_SUCCESS_CALLBACK> successCallback)
 {
 
+	unsigned long sequence;
+	int streamID;
 	cv::Mat frame;
 	cv::Mat resultBGR;
+	PTR_FRAME_STATE state;
+	std::chrono::steady_clock::time_point captured;
+	bool isLastStage = stage >= static_cast<int>(this->stageQueues.size());
 
-	while (!this->finished)
+	Tracer::Shared()->ThreadName("consumer stage " + std::to_string(stage));
+
+	while (true)
 	{
 
-		std::unique_lock<std::mutex> lk(this->mx);
-		this->cv.wait(lk, [this] {return this->finished || !this->queue.empty(); });
+		if (stage == 0)
+		{
+			// First stage obtains the frames from the streams and converts the callback image
+			if (!this->ObtainFrame(frame, sequence, streamID, captured))
+			{
+				break;
+			}
+
+			state = this->CreateState(frame, sequence, streamID, captured);
+			if (state == nullptr)
+			{
+				// Deadline has passed while the frame was buffered
+				continue;
+			}
+
+			StatsScope scope(state->Stats().get());
+			StageTimer convertTimer(TimingStage::CONVERT);
+			Util::ConvertColor(frame, resultBGR, this->colorFormat);
+			convertTimer.Stop();
+			state->Source(resultBGR);
+
+			// The frame stays in use by the following stages, its buffer cannot be recycled
+			frame.release();
+			resultBGR.release();
+		}
+		else if (!this->stageQueues.at(stage - 1)->Pop(state))
+		{
+			// Previous stage has finished and all its frames are processed
+			break;
+		}
+
+		if (this->aborted)
+		{
+			// Discard frames of previous stages until they are closed
+			state = nullptr;
+			continue;
+		}
 
-		if (!this->queue.empty())
+		if (state->Errors().empty())
 		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 			try
 			{
-				frame = this->queue.front();
-				this->queue.pop();
-				Util::ConvertColor(frame, resultBGR, this->colorFormat);
-				successCallback(processing->Execute(frame), resultBGR);
+				// Admitted only while processing, a stage blocked by the next stage holds no admission
+				PoolAdmission admission(TaskPool::Shared());
+				StatsScope scope(state->Stats().get());
+				StageTimer timer(TimingStage::PROCESSING);
+				processing->ExecuteStage(stage, state);
 			}
 			catch (Error::Code errorCode)
 			{
-				// Single error messages from processing
-				errorCallback(errorCode);
+				state->AddError(errorCode);
 			}
 			catch (Error::CompanionException ex)
 			{
-				// Multiple error messages only called by parallelized methods
 				while (ex.HasNext())
 				{
-					errorCallback(ex.Next());
+					state->AddError(ex.Next());
 				}
 			}
+			this->Processed(stage, std::chrono::steady_clock::now() - start);
+		}
 
-			frame.release();
-			resultBGR.release();
+		if (isLastStage)
+		{
+			this->DeliverState(state, errorCallback, successCallback);
 		}
+		else
+		{
+			// Blocks if the next stage is slower, bounded queues keep the memory of frames in flight low
+			this->stageQueues.at(stage)->Push(state);
+		}
+
+		state = nullptr;
+	}
+
+	if (!isLastStage)
+	{
+		this->stageQueues.at(stage)->Close();
 	}
 }
 
-bool Companion::Thread::StreamWorker::StoreFrame(cv::Mat frame)
+void Companion::Thread::StreamWorker::Deadline(std::chrono::milliseconds deadline)
 {
-	std::lock_guard<std::mutex> lk(this->mx);
-	if (this->queue.size() >= this->buffer)
+	this->deadline = deadline;
+}
+
+void Companion::Thread::StreamWorker::AdaptiveSkip(PTR_SKIP_CONTROLLER controller)
+{
+	this->skipController = controller;
+}
+
+void Companion::Thread::StreamWorker::Stats(std::function<STATS_CALLBACK> statsCallback)
+{
+	this->statsCallback = statsCallback;
+}
+
+bool Companion::Thread::StreamWorker::ObtainFrame(cv::Mat& frame, unsigned long& sequence, int& streamID, std::chrono::steady_clock::time_point& captured)
+{
+	while (!this->aborted)
+	{
+
+		if (!this->TryObtainFrame(frame, sequence, streamID, captured))
+		{
+			if (this->IsFinished())
+			{
+				// All frames stored by the producers are obtained
+				return false;
+			}
+
+			// Sleep only if all rings are empty, producers wake waiting consumers after storing a frame
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			TraceSpan span("idle", "stream");
+			std::unique_lock<std::mutex> lk(this->mx);
+			this->waiting++;
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			this->cv.wait(lk, [this] {return this->aborted || this->HasFrame() || this->IsFinished(); });
+			this->waiting--;
+			lk.unlock();
+			this->metrics->Idle(std::chrono::steady_clock::now() - start);
+			continue;
+		}
+
+		// A slot was freed, wake the producer if it waits for one
+		Channel& channel = *this->channels.at(streamID);
+		this->metrics->FrameConsumed(this->Buffered());
+		if (this->skipController != nullptr)
+		{
+			this->skipController->Buffered(channel.ring->Size());
+		}
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (channel.producerWaiting.load(std::memory_order_relaxed))
+		{
+			std::lock_guard<std::mutex> lk(this->mx);
+			channel.space.notify_one();
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+bool Companion::Thread::StreamWorker::TryObtainFrame(cv::Mat& frame, unsigned long& sequence, int& streamID, std::chrono::steady_clock::time_point& captured)
+{
+	int total = 0;
+	int next = -1;
+
+	if (this->channels.size() == 1)
+	{
+		// A single stream needs no scheduling, the hand-off stays lock-free
+		streamID = 0;
+		return this->channels.front()->ring->TryPop(frame, sequence, captured);
+	}
+
+	// Smooth weighted round-robin over all streams with stored frames, heavier streams are chosen more often but
+	// never in long bursts
+	std::lock_guard<std::mutex> lk(this->scheduleMx);
+	for (size_t i = 0; i < this->channels.size(); i++)
+	{
+		Channel& channel = *this->channels.at(i);
+		if (channel.ring->Size() > 0)
+		{
+			channel.credit += channel.weight;
+			total += channel.weight;
+			if (next < 0 || channel.credit > this->channels.at(next)->credit)
+			{
+				next = static_cast<int>(i);
+			}
+		}
+	}
+
+	if (next < 0)
 	{
-		// If buffer full try to notify producer and wait current frame and do nothing
-		this->cv.notify_one();
 		return false;
 	}
+
+	this->channels.at(next)->credit -= total;
+	streamID = next;
+	return this->channels.at(next)->ring->TryPop(frame, sequence, captured);
+}
+
+PTR_FRAME_STATE Companion::Thread::StreamWorker::CreateState(const cv::Mat& frame,
+	unsigned long sequence,
+	int streamID,
+	std::chrono::steady_clock::time_point captured)
+{
+	PTR_FRAME_STATE state = std::make_shared<FRAME_STATE>(frame, sequence);
+
+	state->Stream(streamID);
+	state->Captured(captured);
+	state->Deadline(this->deadline);
+	if (this->statsCallback || Tracer::Active() != nullptr)
+	{
+		// Spans of the tracer are assigned to their frame by the stats
+		state->Stats(std::make_shared<FRAME_STATS>(streamID, sequence));
+	}
+
+	if (state->Expired())
+	{
+		// A late result is useless, skip the frame in the reorder buffer without processing it
+		this->Deliver(*this->channels.at(streamID), sequence, nullptr);
+		this->metrics->FrameExpired();
+		return nullptr;
+	}
+
+	return state;
+}
+
+bool Companion::Thread::StreamWorker::IsFinished() const
+{
+	for (size_t i = 0; i < this->channels.size(); i++)
+	{
+		if (!this->channels.at(i)->finished || this->channels.at(i)->ring->Size() > 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Companion::Thread::StreamWorker::HasFrame() const
+{
+	for (size_t i = 0; i < this->channels.size(); i++)
+	{
+		if (this->channels.at(i)->ring->Size() > 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int Companion::Thread::StreamWorker::Buffered() const
+{
+	int buffered = 0;
+
+	for (size_t i = 0; i < this->channels.size(); i++)
+	{
+		buffered += static_cast<int>(this->channels.at(i)->ring->Size());
+	}
+
+	return buffered;
+}
+
+void Companion::Thread::StreamWorker::DeliverState(PTR_FRAME_STATE state,
+	std::function<ERROR_CALLBACK> errorCallback,
+	std::function<STREAM_SUCCESS_CALLBACK> successCallback)
+{
+	std::vector<Error::Code> errors = state->Errors();
+	Channel& channel = *this->channels.at(state->Stream());
+
+	if (state->Partial())
+	{
+		this->metrics->FramePartial();
+	}
+
+	std::function<void()> delivery;
+	if (errors.empty())
+	{
+		delivery = std::bind(successCallback, state->Stream(), state->Results(), state->Source());
+	}
 	else
 	{
-		this->queue.push(frame);
+		delivery = [errorCallback, errors]
+		{
+			for (size_t i = 0; i < errors.size(); i++)
+			{
+				errorCallback(errors[i]);
+			}
+		};
+	}
+
+	if (state->Stats() != nullptr && this->statsCallback)
+	{
+		// Stats are delivered right before the results of their frame
+		std::function<STATS_CALLBACK> statsCallback = this->statsCallback;
+		PTR_FRAME_STATS stats = state->Stats();
+		std::function<void()> results = delivery;
+		delivery = [statsCallback, stats, results]
+		{
+			statsCallback(stats);
+			results();
+		};
+	}
+
+	// Latency ends once the callbacks of the frame have returned
+	PTR_STREAM_METRICS metrics = this->metrics;
+	std::chrono::steady_clock::time_point captured = state->Captured();
+	int streamID = state->Stream();
+	long long sequence = static_cast<long long>(state->Sequence());
+	std::function<void()> callbacks = delivery;
+	delivery = [metrics, captured, streamID, sequence, callbacks]
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		callbacks();
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+		metrics->Latency(end - captured);
+
+		TRACER* tracer = Tracer::Active();
+		if (tracer != nullptr)
+		{
+			tracer->Record("callback", "frame", start, end, streamID, sequence);
+		}
+	};
+
+	this->Deliver(channel, state->Sequence(), delivery);
+}
+
+void Companion::Thread::StreamWorker::Processed(int stage, std::chrono::nanoseconds duration)
+{
+	if (this->skipController != nullptr)
+	{
+		this->skipController->Processed(stage, duration);
+		this->metrics->SkipFrame(this->skipController->Skip());
+	}
+}
+
+PTR_STREAM_METRICS Companion::Thread::StreamWorker::Metrics() const
+{
+	return this->metrics;
+}
+
+void Companion::Thread::StreamWorker::Abort()
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+	this->aborted = true;
+	// Wake sleeping consumers and producers which wait for a free slot
+	this->cv.notify_all();
+	for (size_t i = 0; i < this->channels.size(); i++)
+	{
+		this->channels.at(i)->space.notify_all();
+	}
+}
+
+bool Companion::Thread::StreamWorker::IsAborted() const
+{
+	return this->aborted;
+}
+
+bool Companion::Thread::StreamWorker::StoreFrame(cv::Mat& frame, std::chrono::steady_clock::time_point captured, Channel& channel)
+{
+	switch (this->policy)
+	{
+	case BackpressurePolicy::BLOCK:
+		this->StoreFrameBlocking(frame, captured, channel);
+		if (this->aborted)
+		{
+			// Woken without a free slot, the frame is discarded
+			return false;
+		}
+		break;
+	case BackpressurePolicy::DROP_NEWEST:
+		if (!channel.ring->TryPush(frame, captured))
+		{
+			// Buffer full, keep buffered frames
+			this->metrics->FrameDropped();
+			return false;
+		}
+		break;
+	case BackpressurePolicy::DROP_OLDEST:
+		while (!channel.ring->TryPush(frame, captured))
+		{
+			this->DropOldestFrame(channel);
+		}
+		break;
+	case BackpressurePolicy::KEEP_LATEST:
+		// Only the newest frame is worth processing, drop all buffered frames
+		while (channel.ring->Size() > 0)
+		{
+			this->DropOldestFrame(channel);
+		}
+		while (!channel.ring->TryPush(frame, captured))
+		{
+			this->DropOldestFrame(channel);
+		}
+		break;
+	}
+
+	this->metrics->FrameStored(this->Buffered());
+
+	// Take the lock only if a consumer sleeps, otherwise the hand-off is lock-free
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (this->waiting.load(std::memory_order_relaxed) > 0)
+	{
+		std::lock_guard<std::mutex> lk(this->mx);
 		this->cv.notify_one();
-		return true;
 	}
+
+	return true;
+}
+
+void Companion::Thread::StreamWorker::StoreFrameBlocking(cv::Mat& frame, std::chrono::steady_clock::time_point captured, Channel& channel)
+{
+	if (channel.ring->TryPush(frame, captured))
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	do
+	{
+		// Sleep until a consumer frees a slot instead of retrying in a busy loop
+		std::unique_lock<std::mutex> lk(this->mx);
+		channel.producerWaiting = true;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		channel.space.wait(lk, [this, &channel] { return this->aborted || channel.ring->Size() < channel.ring->Capacity(); });
+		channel.producerWaiting = false;
+	} while (!this->aborted && !channel.ring->TryPush(frame, captured));
+
+	this->metrics->Blocked(std::chrono::steady_clock::now() - start);
+}
+
+bool Companion::Thread::StreamWorker::DropOldestFrame(Channel& channel)
+{
+	unsigned long sequence;
+
+	if (!channel.ring->TryPop(channel.droppedFrame, sequence))
+	{
+		return false;
+	}
+
+	{
+		// Dropped frames are only marked as skipped in the reorder buffer, the stored frame which replaces it is
+		// delivered by a consumer which also drains the skipped frames, so no callback runs on the producer thread
+		std::lock_guard<std::mutex> lk(channel.deliveryMx);
+		if (!this->aborted)
+		{
+			channel.reorder[sequence] = nullptr;
+		}
+	}
+	this->metrics->FrameDropped();
+	return true;
+}
+
+void Companion::Thread::StreamWorker::Deliver(Channel& channel, unsigned long sequence, std::function<void()> delivery)
+{
+	std::vector<std::function<void()>> ready;
+	std::unique_lock<std::mutex> lk(channel.deliveryMx);
+
+	if (this->aborted)
+	{
+		// No results are delivered after an abort
+		return;
+	}
+	channel.reorder[sequence] = delivery;
+
+	if (channel.delivering)
+	{
+		// Another consumer runs callbacks of this stream and delivers this frame once it is next in order
+		return;
+	}
+	channel.delivering = true;
+
+	while (!this->aborted)
+	{
+		// Take all buffered frames which are next in order
+		while (!channel.reorder.empty() && channel.reorder.begin()->first == channel.nextDelivery)
+		{
+			if (channel.reorder.begin()->second)
+			{
+				ready.push_back(std::move(channel.reorder.begin()->second));
+			}
+			channel.reorder.erase(channel.reorder.begin());
+			channel.nextDelivery++;
+		}
+
+		if (ready.empty())
+		{
+			break;
+		}
+
+		// Callbacks run without the lock, other consumers only buffer their frames meanwhile
+		lk.unlock();
+		for (size_t i = 0; i < ready.size(); i++)
+		{
+			ready[i]();
+		}
+		ready.clear();
+		lk.lock();
+	}
+
+	channel.delivering = false;
 }
@@ -19,13 +19,26 @@
 #ifndef COMPANION_STREAMWORKER_H
 #define COMPANION_STREAMWORKER_H
 
-#include <queue>
+#include <map>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <mutex>
 #include <condition_variable>
 #include <opencv2/core/core.hpp>
 #include <companion/processing/ImageProcessing.h>
 #include <companion/draw/Drawable.h>
 #include <companion/input/Stream.h>
+#include <companion/thread/FrameRing.h>
+#include <companion/thread/StageQueue.h>
+#include <companion/thread/SkipController.h>
+#include <companion/thread/StageTimer.h>
+#include <companion/thread/TaskPool.h>
+#include <companion/thread/Tracer.h>
+#include <companion/model/processing/FrameState.h>
+#include <companion/model/stream/StreamMetrics.h>
 #include <companion/util/CompanionError.h>
 #include <companion/util/Util.h>
 #include <companion/util/Definitions.h>
@@ -35,7 +48,7 @@ namespace Companion {
 	namespace Thread
 	{
 		/**
-		 * Stream worker class to produce and consume images from a streaming source.
+		 * Stream worker class to produce and consume images from one or several streaming sources.
 		 * @author Andreas Sekulski, Dimitri Kotlovsky
 		 */
 		class COMP_EXPORTS StreamWorker
@@ -44,37 +57,173 @@ namespace Companion {
 		public:
 
 			/**
-			 * Create a stream worker to obtain images from a stream and store to a queue.
-			 * @param buffer Buffer size to store images. Default is one image.
+			 * Create a stream worker to obtain images from streams and store to a queue for each stream.
+			 * @param buffer Buffer size to store images of each stream. Default is one image, the frame ring buffers at
+			 * least two images.
 			 * @param colorFormat Color format of the returned image.
+			 * @param policy Backpressure policy if the buffer of a stream is full.
+			 * @param metrics Metrics to count stored and dropped frames, if nullptr the worker creates its own metrics.
+			 * @param weights Scheduling weight of each stream, the number of weights is the number of streams. Consumers
+			 * obtain frames from streams with buffered frames in proportion to their weights. Default is a single stream.
 			 */
-			StreamWorker(int buffer = 1, ColorFormat colorFormat = ColorFormat::BGR);
+			StreamWorker(int buffer = 1,
+				ColorFormat colorFormat = ColorFormat::BGR,
+				BackpressurePolicy policy = BackpressurePolicy::BLOCK,
+				PTR_STREAM_METRICS metrics = nullptr,
+				const std::vector<int>& weights = std::vector<int>(1, 1));
 
 			/**
-			 * Produce stream data and store to the queue.
+			 * Produce stream data and store to the queue of the stream. One producer runs for each stream.
 			 * @param stream Stream source to obtain images from.
 			 * @param skipFrame Skipping frame rate if set.
 			 * @param errorCallback Error callback handler.
+			 * @param streamID ID of the stream, between 0 and the number of streams - 1.
 			 */
-			void Produce(PTR_STREAM stream, int skipFrame, std::function<ERROR_CALLBACK> errorCallback);
+			void Produce(PTR_STREAM stream, int skipFrame, std::function<ERROR_CALLBACK> errorCallback, int streamID = 0);
 
 			/**
-			 * Consume stream data from stored queue and process it.
+			 * Consume stream data from stored queues and process it. Several consumers can run concurrently on the same
+			 * worker, results of each stream are delivered to the callbacks one at a time in the order the frames were
+			 * obtained.
 			 * @param processing Processing algorithm.
 			 * @param errorCallback Error callback handler.
-			 * @param successCallback Callback handler to return results.
+			 * @param successCallback Callback handler to return results with the ID of their stream.
+			 */
+			void Consume(PTR_IMAGE_PROCESSING processing, std::function<ERROR_CALLBACK> errorCallback, std::function<STREAM_SUCCESS_CALLBACK> successCallback);
+
+			/**
+			 * Prepare the bounded queues between the stages of a pipelined image processing. Must be called before
+			 * the stage consumers are started.
+			 * @param stages Number of stages of the image processing.
+			 */
+			void Pipeline(int stages);
+
+			/**
+			 * Set latency deadline of each frame. Frames whose deadline has passed before processing starts are dropped,
+			 * image processings which check the deadline return partial results. Must be called before the consumers
+			 * are started.
+			 * @param deadline Latency deadline relative to the capture time, zero disables the deadline.
+			 */
+			void Deadline(std::chrono::milliseconds deadline);
+
+			/**
+			 * Adapt the skip frame rate continuously to the processing load. Producers obtain the skip frame rate from
+			 * the controller instead of their fixed skip frame rate, consumers report their processing time and the
+			 * number of buffered frames. Must be called before the producers and consumers are started.
+			 * @param controller Skip controller, nullptr to use the fixed skip frame rate.
+			 */
+			void AdaptiveSkip(PTR_SKIP_CONTROLLER controller);
+
+			/**
+			 * Record the processing times of each frame and deliver them in frame order right before the results of
+			 * the frame. Must be called before the consumers are started.
+			 * @param statsCallback Callback handler for the stats of each frame, nullptr to record no stats.
+			 */
+			void Stats(std::function<STATS_CALLBACK> statsCallback);
+
+			/**
+			 * Consume stream data stage by stage. One consumer runs for each stage, different frames occupy different
+			 * stages concurrently and frames are passed to the next stage over a bounded queue. The first stage obtains
+			 * the frames from the stored queues, the last stage delivers the results in frame order of each stream.
+			 * @param stage Stage of the image processing to execute.
+			 * @param processing Processing algorithm.
+			 * @param errorCallback Error callback handler.
+			 * @param successCallback Callback handler to return results with the ID of their stream.
+			 */
+			void ConsumeStage(int stage,
+				PTR_IMAGE_PROCESSING processing,
+				std::function<ERROR_CALLBACK> errorCallback,
+				std::function<STREAM_SUCCESS_CALLBACK> successCallback);
+
+			/**
+			 * Get metrics of this worker.
+			 * @return Metrics which count stored and dropped frames and the time the producer was blocked.
+			 */
+			PTR_STREAM_METRICS Metrics() const;
+
+			/**
+			 * Abort this worker. Buffered frames are discarded, frames which are processed right now are finished but
+			 * no more results are delivered. Producers and consumers return as soon as possible.
+			 */
+			void Abort();
+
+			/**
+			 * Check if this worker was aborted.
+			 * @return <code>True</code> if the worker was aborted.
 			 */
-			void Consume(PTR_IMAGE_PROCESSING processing, std::function<ERROR_CALLBACK> errorCallback, std::function<SUCCESS_CALLBACK> successCallback);
+			bool IsAborted() const;
 
 		private:
 
 			/**
-			 * Indicator to cancel threads.
+			 * Frames of a single stream.
+			 */
+			struct Channel
+			{
+				/**
+				 * Lock-free ring of preallocated frame slots to store images from the stream, frames are numbered in order.
+				 */
+				PTR_FRAME_RING ring;
+
+				/**
+				 * Scheduling weight of this stream.
+				 */
+				int weight;
+
+				/**
+				 * Current weight of the smooth weighted round-robin scheduling.
+				 */
+				int credit;
+
+				/**
+				 * Indicator that the producer has stored its last frame, consumers stop once all stored frames are obtained.
+				 */
+				std::atomic<bool> finished;
+
+				/**
+				 * Condition for the producer to wait until a frame slot is free.
+				 */
+				std::condition_variable space;
+
+				/**
+				 * Indicator if the producer sleeps until a frame slot is free.
+				 */
+				std::atomic<bool> producerWaiting;
+
+				/**
+				 * Buffer of the last dropped frame, recycled by the ring with the next dropped frame.
+				 */
+				cv::Mat droppedFrame;
+
+				/**
+				 * Mutex of the reorder buffer and its delivery state.
+				 */
+				std::mutex deliveryMx;
+
+				/**
+				 * Indicator that a consumer runs the callbacks of this stream, keeps the callbacks in frame order while
+				 * they run without the lock.
+				 */
+				bool delivering;
+
+				/**
+				 * Reorder buffer of processed frames which wait until all previous frames are delivered.
+				 */
+				std::map<unsigned long, std::function<void()>> reorder;
+
+				/**
+				 * Sequence number of the next frame whose results are delivered.
+				 */
+				unsigned long nextDelivery;
+			};
+
+			/**
+			 * Indicator to cancel threads without processing the stored frames.
 			 */
-			bool finished;
+			std::atomic<bool> aborted;
 
 			/**
-			 * Buffer size for storing images.
+			 * Buffer size for storing images of each stream.
 			 */
 			int buffer;
 
@@ -84,7 +233,17 @@ namespace Companion {
 			ColorFormat colorFormat;
 
 			/**
-			 * Mutex to lock the thread.
+			 * Backpressure policy if the buffer is full.
+			 */
+			BackpressurePolicy policy;
+
+			/**
+			 * Metrics of this worker.
+			 */
+			PTR_STREAM_METRICS metrics;
+
+			/**
+			 * Mutex to let consumers and producers sleep.
 			 */
 			std::mutex mx;
 
@@ -94,16 +253,145 @@ namespace Companion {
 			std::condition_variable cv;
 
 			/**
-			 * Queue to store images from stream.
+			 * Number of consumers which sleep until a frame is stored.
+			 */
+			std::atomic<int> waiting;
+
+			/**
+			 * Frames of each stream.
+			 */
+			std::vector<std::unique_ptr<Channel>> channels;
+
+			/**
+			 * Mutex to schedule frames of several streams.
 			 */
-			std::queue<cv::Mat> queue;
+			std::mutex scheduleMx;
 
 			/**
-			 * Store a frame to queue.
+			 * Bounded queues between the stages of a pipelined image processing, queue i connects stage i and i + 1.
+			 */
+			std::vector<PTR_STAGE_QUEUE> stageQueues;
+
+			/**
+			 * Latency deadline of each frame relative to its capture time, zero if no deadline is set.
+			 */
+			std::chrono::milliseconds deadline;
+
+			/**
+			 * Controller of the skip frame rate, nullptr if the fixed skip frame rate is used.
+			 */
+			PTR_SKIP_CONTROLLER skipController;
+
+			/**
+			 * Callback handler for the stats of each frame, stats are only recorded if set.
+			 */
+			std::function<STATS_CALLBACK> statsCallback;
+
+			/**
+			 * Number of frames which can wait between two stages.
+			 */
+			static constexpr int STAGE_QUEUE_SIZE = 2;
+
+			/**
+			 * Obtain the next frame from the stored queues, waits while all queues are empty.
+			 * @param frame Obtained frame, its former buffer is recycled.
+			 * @param sequence Sequence number of the obtained frame within its stream.
+			 * @param streamID ID of the stream of the obtained frame.
+			 * @param captured Capture time of the obtained frame.
+			 * @return <code>False</code> if all streams have finished, <code>true</code> otherwise.
+			 */
+			bool ObtainFrame(cv::Mat& frame, unsigned long& sequence, int& streamID, std::chrono::steady_clock::time_point& captured);
+
+			/**
+			 * Take a frame from the queue of the next scheduled stream without waiting.
+			 * @param frame Obtained frame, its former buffer is recycled.
+			 * @param sequence Sequence number of the obtained frame within its stream.
+			 * @param streamID ID of the stream of the obtained frame.
+			 * @param captured Capture time of the obtained frame.
+			 * @return <code>True</code> if a frame was obtained.
+			 */
+			bool TryObtainFrame(cv::Mat& frame, unsigned long& sequence, int& streamID, std::chrono::steady_clock::time_point& captured);
+
+			/**
+			 * Create the state of an obtained frame or drop the frame if its deadline has passed already.
+			 * @param frame Obtained frame.
+			 * @param sequence Sequence number of the obtained frame within its stream.
+			 * @param streamID ID of the stream of the obtained frame.
+			 * @param captured Capture time of the obtained frame.
+			 * @return State of the frame or nullptr if the frame was dropped.
+			 */
+			PTR_FRAME_STATE CreateState(const cv::Mat& frame, unsigned long sequence, int streamID, std::chrono::steady_clock::time_point captured);
+
+			/**
+			 * Check if all producers have finished and all stored frames are obtained.
+			 * @return <code>True</code> if no more frames are obtained.
+			 */
+			bool IsFinished() const;
+
+			/**
+			 * Check if a frame is stored in any queue.
+			 * @return <code>True</code> if a frame can be obtained.
+			 */
+			bool HasFrame() const;
+
+			/**
+			 * Get number of frames stored in all queues.
+			 * @return Number of buffered frames.
+			 */
+			int Buffered() const;
+
+			/**
+			 * Report the processing time of a frame to the skip controller if adaptive skipping is used.
+			 * @param stage Stage which has processed the frame, 0 if the image processing is not pipelined.
+			 * @param duration Processing time of the frame.
+			 */
+			void Processed(int stage, std::chrono::nanoseconds duration);
+
+			/**
+			 * Deliver the results or errors of a processed frame in frame order of its stream.
+			 * @param state Processed frame.
+			 * @param errorCallback Error callback handler.
+			 * @param successCallback Callback handler to return results.
+			 */
+			void DeliverState(PTR_FRAME_STATE state,
+				std::function<ERROR_CALLBACK> errorCallback,
+				std::function<STREAM_SUCCESS_CALLBACK> successCallback);
+
+			/**
+			 * Store a frame to the queue of a stream and apply the backpressure policy if the queue is full. On success
+			 * the frame receives a recycled buffer to obtain the next image into.
+			 * @param frame Frame to store to queue.
+			 * @param captured Capture time of the frame.
+			 * @param channel Frames of the stream.
+			 * @return <code>True</code> if the frame was stored, <code>false</code> if it was dropped.
+			 */
+			bool StoreFrame(cv::Mat& frame, std::chrono::steady_clock::time_point captured, Channel& channel);
+
+			/**
+			 * Wait until the given frame is stored to the queue of a stream.
 			 * @param frame Frame to store to queue.
-			 * @return <code>True</code> if the frame was stored, <code>flase</code> otherwise.
+			 * @param captured Capture time of the frame.
+			 * @param channel Frames of the stream.
+			 */
+			void StoreFrameBlocking(cv::Mat& frame, std::chrono::steady_clock::time_point captured, Channel& channel);
+
+			/**
+			 * Drop the oldest frame from the queue of a stream. Its results are skipped by the reorder buffer.
+			 * @param channel Frames of the stream.
+			 * @return <code>True</code> if a frame was dropped, <code>false</code> if the queue is empty.
+			 */
+			bool DropOldestFrame(Channel& channel);
+
+			/**
+			 * Deliver the results of a processed frame in frame order of its stream. If previous frames are still
+			 * processed or another consumer runs callbacks of the stream the delivery is buffered and executed by the
+			 * consumer which completes the gap. Callbacks run without holding the lock of the reorder buffer. Only
+			 * called by consumers, producers mark dropped frames without delivering.
+			 * @param channel Frames of the stream.
+			 * @param sequence Sequence number of the processed frame.
+			 * @param delivery Callback invocations for the processed frame, an empty function skips the frame.
 			 */
-			bool StoreFrame(cv::Mat frame);
+			void Deliver(Channel& channel, unsigned long sequence, std::function<void()> delivery);
 		};
 	}
 }
@@ -0,0 +1,270 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TaskPool.h"
+
+#include <algorithm>
+
+/**
+ * Pool and index of the worker which runs on the current thread.
+ */
+static thread_local std::pair<const Companion::Thread::TaskPool*, int> currentWorker(nullptr, -1);
+
+Companion::Thread::TaskPool::TaskPool(int workers)
+{
+	if (workers < 0)
+	{
+		workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency())) - 1;
+	}
+
+	this->pending = 0;
+	this->nextQueue = 0;
+	this->stopped = false;
+	this->admitted = 0;
+
+	for (int i = 0; i < workers; i++)
+	{
+		this->queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+	}
+
+	for (int i = 0; i < workers; i++)
+	{
+		this->workers.push_back(std::thread(&TaskPool::Work, this, i));
+	}
+}
+
+Companion::Thread::TaskPool::~TaskPool()
+{
+	{
+		std::lock_guard<std::mutex> lk(this->mx);
+		this->stopped = true;
+	}
+	this->cv.notify_all();
+
+	for (size_t i = 0; i < this->workers.size(); i++)
+	{
+		this->workers.at(i).join();
+	}
+}
+
+PTR_TASK_POOL Companion::Thread::TaskPool::Shared()
+{
+	static PTR_TASK_POOL pool = std::make_shared<TASK_POOL>();
+	return pool;
+}
+
+int Companion::Thread::TaskPool::Concurrency() const
+{
+	return static_cast<int>(this->workers.size()) + 1;
+}
+
+void Companion::Thread::TaskPool::ParallelFor(int count, std::function<void(int index, int slot)> task)
+{
+	Job job;
+	Task current;
+	int worker = this->CurrentWorker();
+	// Threads outside of the pool share the last slot, slots are distinct only within one loop
+	int slot = worker >= 0 ? worker : static_cast<int>(this->workers.size());
+
+	if (count <= 0)
+	{
+		return;
+	}
+
+	job.task = task;
+	job.remaining = count;
+	job.stats = StageTimer::Stats();
+
+	if (this->queues.empty() || count == 1)
+	{
+		// Nothing to share
+		for (int i = 0; i < count; i++)
+		{
+			this->Execute({ &job, i }, slot);
+		}
+	}
+	else
+	{
+		// Spread single tasks over all deques, idle workers steal from busy ones
+		for (int i = 0; i < count; i++)
+		{
+			WorkQueue& queue = *this->queues.at(this->nextQueue++ % this->queues.size());
+			std::lock_guard<std::mutex> lk(queue.mx);
+			queue.tasks.push_back({ &job, i });
+		}
+		this->pending += count;
+		{
+			std::lock_guard<std::mutex> lk(this->mx);
+		}
+		this->cv.notify_all();
+
+		// Help executing tasks of this loop instead of waiting. Tasks of other loops are never taken, so a nested loop
+		// of a worker cannot run a task of its outer loop with the same slot. Tasks are never queued again, once none
+		// of this loop is left the remaining ones are executed and the last one signals the completion.
+		while (this->StealFrom(&job, current))
+		{
+			this->Execute(current, slot);
+		}
+	}
+
+	// Wait under the lock, so no worker touches the job after it is destroyed
+	std::unique_lock<std::mutex> lk(job.mx);
+	job.done.wait(lk, [&job] { return job.remaining == 0; });
+
+	if (job.error)
+	{
+		std::rethrow_exception(job.error);
+	}
+}
+
+void Companion::Thread::TaskPool::Enter()
+{
+	std::unique_lock<std::mutex> lk(this->admissionMx);
+	this->admission.wait(lk, [this] { return this->admitted < this->Concurrency(); });
+	this->admitted++;
+}
+
+void Companion::Thread::TaskPool::Leave()
+{
+	{
+		std::lock_guard<std::mutex> lk(this->admissionMx);
+		this->admitted--;
+	}
+	this->admission.notify_one();
+}
+
+void Companion::Thread::TaskPool::Work(int worker)
+{
+	Task task;
+	currentWorker = std::make_pair(this, worker);
+	Tracer::Shared()->ThreadName("task worker " + std::to_string(worker));
+
+	while (true)
+	{
+		if (this->Take(worker, task))
+		{
+			this->Execute(task, worker);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lk(this->mx);
+		this->cv.wait(lk, [this] { return this->stopped || this->pending > 0; });
+		if (this->stopped && this->pending == 0)
+		{
+			return;
+		}
+	}
+}
+
+bool Companion::Thread::TaskPool::Take(int worker, Task& task)
+{
+	// Own tasks are taken from the back, they are most likely still in cache
+	{
+		WorkQueue& queue = *this->queues.at(worker);
+		std::lock_guard<std::mutex> lk(queue.mx);
+		if (!queue.tasks.empty())
+		{
+			task = queue.tasks.back();
+			queue.tasks.pop_back();
+			this->pending--;
+			return true;
+		}
+	}
+
+	// Steal the oldest task of another worker
+	for (size_t i = 1; i < this->queues.size(); i++)
+	{
+		WorkQueue& queue = *this->queues.at((worker + i) % this->queues.size());
+		std::lock_guard<std::mutex> lk(queue.mx);
+		if (!queue.tasks.empty())
+		{
+			task = queue.tasks.front();
+			queue.tasks.pop_front();
+			this->pending--;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool Companion::Thread::TaskPool::StealFrom(Job* job, Task& task)
+{
+	for (size_t i = 0; i < this->queues.size(); i++)
+	{
+		WorkQueue& queue = *this->queues.at(i);
+		std::lock_guard<std::mutex> lk(queue.mx);
+		// Tasks of other loops may be queued after the tasks of this loop, search the whole deque from the back
+		for (std::deque<Task>::iterator it = queue.tasks.end(); it != queue.tasks.begin();)
+		{
+			--it;
+			if (it->job == job)
+			{
+				task = *it;
+				queue.tasks.erase(it);
+				this->pending--;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void Companion::Thread::TaskPool::Execute(const Task& task, int slot)
+{
+	std::exception_ptr error;
+
+	try
+	{
+		// Steps of the task are timed for the frame of the calling thread
+		StatsScope scope(task.job->stats);
+		task.job->task(task.index, slot);
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+
+	std::lock_guard<std::mutex> lk(task.job->mx);
+	if (error && !task.job->error)
+	{
+		task.job->error = error;
+	}
+	task.job->remaining--;
+	if (task.job->remaining == 0)
+	{
+		task.job->done.notify_all();
+	}
+}
+
+int Companion::Thread::TaskPool::CurrentWorker() const
+{
+	return currentWorker.first == this ? currentWorker.second : -1;
+}
+
+Companion::Thread::PoolAdmission::PoolAdmission(PTR_TASK_POOL pool)
+{
+	this->pool = pool;
+	this->pool->Enter();
+}
+
+Companion::Thread::PoolAdmission::~PoolAdmission()
+{
+	this->pool->Leave();
+}
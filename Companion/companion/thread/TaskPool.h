@@ -0,0 +1,288 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_TASKPOOL_H
+#define COMPANION_TASKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <companion/thread/StageTimer.h>
+#include <companion/util/Definitions.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Thread
+	{
+		/**
+		 * Work-stealing task pool which is shared by all image processing classes.
+		 *
+		 * Each worker owns a task deque, it takes its own tasks from the back and steals from the front of the other
+		 * deques if its deque is empty, so uneven task costs do not leave workers idle. The thread which starts a
+		 * parallel loop executes tasks of its loop as well, but never tasks of another loop, also if it is a worker
+		 * which starts a nested loop. Every participating thread of a loop gets a distinct slot number, so results can
+		 * be gathered in per slot buffers of the loop without locks.
+		 * @author Andreas Sekulski, Dimitri Kotlovsky
+		 */
+		class COMP_EXPORTS TaskPool
+		{
+
+		public:
+
+			/**
+			 * Create a task pool.
+			 * @param workers Number of worker threads, if workers < 0 one worker less than hardware threads is used
+			 * because the calling thread participates in each loop.
+			 */
+			TaskPool(int workers = -1);
+
+			/**
+			 * Destructor, stops all workers after the remaining tasks are executed.
+			 */
+			virtual ~TaskPool();
+
+			/**
+			 * Get the task pool which is shared by all image processing classes of this process.
+			 * @return Shared task pool.
+			 */
+			static PTR_TASK_POOL Shared();
+
+			/**
+			 * Get number of distinct slots which are passed to tasks.
+			 * @return Number of workers plus one slot for the calling thread.
+			 */
+			int Concurrency() const;
+
+			/**
+			 * Execute a task for each index and wait until all tasks are executed. Each index is an individual task.
+			 * @param count Number of tasks.
+			 * @param task Task to execute with its index and the slot of the executing thread, between 0 and
+			 * Concurrency() - 1. Tasks with the same slot never run concurrently within one loop. All threads outside
+			 * of the pool use the last slot, so per slot buffers must belong to a single loop.
+			 * @throws The first exception which is thrown by a task after all tasks are executed.
+			 */
+			void ParallelFor(int count, std::function<void(int index, int slot)> task);
+
+			/**
+			 * Wait until a thread outside of the pool is admitted to process a frame. At most Concurrency() threads are
+			 * admitted at the same time, so the consumers of all configurations of the process do not oversubscribe the
+			 * CPU. Must not be held while waiting for another admitted thread.
+			 */
+			void Enter();
+
+			/**
+			 * Leave the admission of the current thread, wakes a waiting thread.
+			 */
+			void Leave();
+
+		private:
+
+			/**
+			 * Parallel loop which is executed by the pool.
+			 */
+			struct Job
+			{
+				/**
+				 * Task to execute for each index.
+				 */
+				std::function<void(int, int)> task;
+
+				/**
+				 * Number of tasks which are not executed yet.
+				 */
+				int remaining;
+
+				/**
+				 * First exception thrown by a task.
+				 */
+				std::exception_ptr error;
+
+				/**
+				 * Mutex to guard the remaining tasks and the exception.
+				 */
+				std::mutex mx;
+
+				/**
+				 * Condition to wait until all tasks are executed.
+				 */
+				std::condition_variable done;
+
+				/**
+				 * Frame stats of the calling thread, bound to every task of this loop.
+				 */
+				FRAME_STATS* stats;
+			};
+
+			/**
+			 * Single task of a parallel loop.
+			 */
+			struct Task
+			{
+				/**
+				 * Parallel loop of this task.
+				 */
+				Job* job;
+
+				/**
+				 * Index of this task.
+				 */
+				int index;
+			};
+
+			/**
+			 * Task deque of a worker.
+			 */
+			struct WorkQueue
+			{
+				/**
+				 * Mutex to guard the deque.
+				 */
+				std::mutex mx;
+
+				/**
+				 * Tasks of this worker.
+				 */
+				std::deque<Task> tasks;
+			};
+
+			/**
+			 * Worker threads.
+			 */
+			std::vector<std::thread> workers;
+
+			/**
+			 * Task deque of each worker.
+			 */
+			std::vector<std::unique_ptr<WorkQueue>> queues;
+
+			/**
+			 * Number of queued tasks.
+			 */
+			std::atomic<int> pending;
+
+			/**
+			 * Worker which receives the next task.
+			 */
+			std::atomic<unsigned int> nextQueue;
+
+			/**
+			 * Indicator to stop the workers.
+			 */
+			bool stopped;
+
+			/**
+			 * Mutex to let idle workers sleep.
+			 */
+			std::mutex mx;
+
+			/**
+			 * Condition to wake idle workers.
+			 */
+			std::condition_variable cv;
+
+			/**
+			 * Number of admitted threads outside of the pool.
+			 */
+			int admitted;
+
+			/**
+			 * Mutex to guard the admitted threads.
+			 */
+			std::mutex admissionMx;
+
+			/**
+			 * Condition to wake threads which wait for an admission.
+			 */
+			std::condition_variable admission;
+
+			/**
+			 * Worker thread loop.
+			 * @param worker Index of this worker.
+			 */
+			void Work(int worker);
+
+			/**
+			 * Take a task from the own deque or steal one from another deque.
+			 * @param worker Index of the worker which takes the task.
+			 * @param task Taken task.
+			 * @return <code>True</code> if a task was taken.
+			 */
+			bool Take(int worker, Task& task);
+
+			/**
+			 * Steal a task of the given loop from any deque, used by the thread which waits for the loop.
+			 * @param job Loop to steal a task from.
+			 * @param task Stolen task.
+			 * @return <code>True</code> if a task was stolen.
+			 */
+			bool StealFrom(Job* job, Task& task);
+
+			/**
+			 * Execute a task and signal its loop if it was the last task.
+			 * @param task Task to execute.
+			 * @param slot Slot of the executing thread.
+			 */
+			void Execute(const Task& task, int slot);
+
+			/**
+			 * Index of the worker of the current thread or -1 if the thread is not a worker of this pool.
+			 * @return Worker index or -1.
+			 */
+			int CurrentWorker() const;
+		};
+
+		/**
+		 * Scope in which the current thread is admitted by the task pool to process a frame.
+		 * @author Andreas Sekulski, Dimitri Kotlovsky
+		 */
+		class COMP_EXPORTS PoolAdmission
+		{
+
+		public:
+
+			/**
+			 * Wait until the current thread is admitted by the given task pool.
+			 * @param pool Task pool which admits the thread.
+			 */
+			explicit PoolAdmission(PTR_TASK_POOL pool);
+
+			/**
+			 * Destructor, leaves the admission.
+			 */
+			~PoolAdmission();
+
+		private:
+
+			/**
+			 * Task pool which admitted the thread.
+			 */
+			PTR_TASK_POOL pool;
+
+			PoolAdmission(const PoolAdmission&) = delete;
+			PoolAdmission& operator=(const PoolAdmission&) = delete;
+		};
+	}
+}
+
+#endif //COMPANION_TASKPOOL_H
@@ -0,0 +1,277 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Tracer.h"
+
+#include <algorithm>
+#include <fstream>
+
+constexpr size_t Companion::Thread::Tracer::DEFAULT_CAPACITY;
+constexpr int Companion::Thread::Tracer::NONE;
+
+namespace
+{
+	/**
+	 * Number of threads which have recorded spans or were named.
+	 */
+	std::atomic<int> threadCount(0);
+
+	/**
+	 * ID of the current thread in the timeline, kept out of the exported classes because thread local data cannot be
+	 * exported from a shared library on all platforms.
+	 */
+	thread_local int currentThread = -1;
+
+	/**
+	 * Write a string as JSON string.
+	 * @param out Stream to write to.
+	 * @param text String to write.
+	 */
+	void WriteString(std::ostream& out, const std::string& text)
+	{
+		out << '"';
+		for (size_t i = 0; i < text.size(); i++)
+		{
+			char c = text[i];
+			if (c == '"' || c == '\\')
+			{
+				out << '\\' << c;
+			}
+			else if (static_cast<unsigned char>(c) < 0x20)
+			{
+				out << ' ';
+			}
+			else
+			{
+				out << c;
+			}
+		}
+		out << '"';
+	}
+}
+
+Companion::Thread::Tracer::Tracer(size_t capacity)
+{
+	this->capacity = capacity > 0 ? capacity : 1;
+	this->next = 0;
+	this->first = 0;
+	this->enabled = false;
+	this->epoch = std::chrono::steady_clock::now();
+}
+
+PTR_TRACER Companion::Thread::Tracer::Shared()
+{
+	static PTR_TRACER tracer = std::make_shared<TRACER>();
+	return tracer;
+}
+
+Companion::Thread::Tracer* Companion::Thread::Tracer::Active()
+{
+	// Keep the pointer, so checking the shared tracer does not copy its shared pointer
+	static Tracer* tracer = Shared().get();
+	return tracer->IsEnabled() ? tracer : nullptr;
+}
+
+void Companion::Thread::Tracer::Enable()
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+	if (this->spans == nullptr)
+	{
+		this->spans.reset(new Span[this->capacity]);
+		for (size_t i = 0; i < this->capacity; i++)
+		{
+			this->spans[i].version.store(0, std::memory_order_relaxed);
+		}
+	}
+	// Publishes the ring buffer to the recording threads
+	this->enabled.store(true, std::memory_order_release);
+}
+
+void Companion::Thread::Tracer::Disable()
+{
+	this->enabled.store(false, std::memory_order_release);
+}
+
+bool Companion::Thread::Tracer::IsEnabled() const
+{
+	return this->enabled.load(std::memory_order_relaxed);
+}
+
+void Companion::Thread::Tracer::Record(const char* name,
+	const char* category,
+	std::chrono::steady_clock::time_point start,
+	std::chrono::steady_clock::time_point end,
+	int stream,
+	long long frame,
+	int model)
+{
+	if (!this->enabled.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	unsigned long long number = this->next.fetch_add(1, std::memory_order_relaxed);
+	Span& span = this->spans[number % this->capacity];
+
+	// Odd version marks the span as being written, a concurrent dump skips it
+	span.version.store(2 * number + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	span.name.store(name, std::memory_order_relaxed);
+	span.category.store(category, std::memory_order_relaxed);
+	span.start.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start - this->epoch).count(), std::memory_order_relaxed);
+	span.duration.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(), std::memory_order_relaxed);
+	span.thread.store(CurrentThread(), std::memory_order_relaxed);
+	span.stream.store(stream, std::memory_order_relaxed);
+	span.frame.store(frame, std::memory_order_relaxed);
+	span.model.store(model, std::memory_order_relaxed);
+	span.version.store(2 * number + 2, std::memory_order_release);
+}
+
+void Companion::Thread::Tracer::ThreadName(const std::string& name)
+{
+	std::lock_guard<std::mutex> lk(this->mx);
+	this->threadNames[CurrentThread()] = name;
+}
+
+void Companion::Thread::Tracer::Dump(std::ostream& out) const
+{
+	bool separator = false;
+	unsigned long long end = this->next.load(std::memory_order_acquire);
+	unsigned long long begin = std::max(end > this->capacity ? end - this->capacity : 0, this->first.load(std::memory_order_relaxed));
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	{
+		std::lock_guard<std::mutex> lk(this->mx);
+		for (std::map<int, std::string>::const_iterator it = this->threadNames.begin(); it != this->threadNames.end(); ++it)
+		{
+			out << (separator ? ",\n" : "\n")
+				<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << it->first << ",\"args\":{\"name\":";
+			WriteString(out, it->second);
+			out << "}}";
+			separator = true;
+		}
+
+		if (this->spans == nullptr)
+		{
+			out << "\n]}" << std::endl;
+			return;
+		}
+	}
+
+	for (unsigned long long number = begin; number < end; number++)
+	{
+		const Span& span = this->spans[number % this->capacity];
+		unsigned long long version = span.version.load(std::memory_order_acquire);
+		if (version != 2 * number + 2)
+		{
+			// Span is still written or already overwritten
+			continue;
+		}
+
+		const char* name = span.name.load(std::memory_order_relaxed);
+		const char* category = span.category.load(std::memory_order_relaxed);
+		long long start = span.start.load(std::memory_order_relaxed);
+		long long duration = span.duration.load(std::memory_order_relaxed);
+		int thread = span.thread.load(std::memory_order_relaxed);
+		int stream = span.stream.load(std::memory_order_relaxed);
+		long long frame = span.frame.load(std::memory_order_relaxed);
+		int model = span.model.load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (span.version.load(std::memory_order_relaxed) != version)
+		{
+			continue;
+		}
+
+		// Complete events carry begin and end of a span in one event, times are in microseconds
+		out << (separator ? ",\n" : "\n") << "{\"name\":";
+		WriteString(out, name);
+		out << ",\"cat\":";
+		WriteString(out, category);
+		out << ",\"ph\":\"X\",\"ts\":" << start / 1000.0
+			<< ",\"dur\":" << duration / 1000.0
+			<< ",\"pid\":1,\"tid\":" << thread
+			<< ",\"args\":{";
+		bool argument = false;
+		if (stream != NONE)
+		{
+			out << "\"stream\":" << stream;
+			argument = true;
+		}
+		if (frame != NONE)
+		{
+			out << (argument ? "," : "") << "\"frame\":" << frame;
+			argument = true;
+		}
+		if (model != NONE)
+		{
+			out << (argument ? "," : "") << "\"model\":" << model;
+		}
+		out << "}}";
+		separator = true;
+	}
+
+	out << "\n]}" << std::endl;
+}
+
+bool Companion::Thread::Tracer::Dump(const std::string& path) const
+{
+	std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	this->Dump(file);
+	return file.good();
+}
+
+void Companion::Thread::Tracer::Clear()
+{
+	this->first.store(this->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+int Companion::Thread::Tracer::CurrentThread()
+{
+	if (currentThread < 0)
+	{
+		currentThread = threadCount.fetch_add(1, std::memory_order_relaxed) + 1;
+	}
+	return currentThread;
+}
+
+Companion::Thread::TraceSpan::TraceSpan(const char* name, const char* category, int stream)
+{
+	this->name = name;
+	this->category = category;
+	this->stream = stream;
+	this->tracer = Tracer::Active();
+	if (this->tracer != nullptr)
+	{
+		this->start = std::chrono::steady_clock::now();
+	}
+}
+
+Companion::Thread::TraceSpan::~TraceSpan()
+{
+	if (this->tracer != nullptr)
+	{
+		this->tracer->Record(this->name, this->category, this->start, std::chrono::steady_clock::now(), this->stream);
+	}
+}
@@ -0,0 +1,296 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_TRACER_H
+#define COMPANION_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <companion/util/Definitions.h>
+#include <companion/util/exportapi/ExportAPIDefinitions.h>
+
+namespace Companion {
+	namespace Thread
+	{
+		/**
+		 * Recorder of execution spans which exports them as Chrome trace event JSON, which can be opened in
+		 * chrome://tracing or Perfetto to see how producers, consumers and task pool workers interleave.
+		 *
+		 * Spans are written lock-free into a fixed ring buffer which overwrites the oldest spans, so the tracer can stay
+		 * enabled in production and the latest timeline can be dumped on demand. Stage timers record a span for each
+		 * timed step with its frame and model while the shared tracer is enabled, a disabled tracer costs one atomic
+		 * load per step.
+		 * @author Andreas Sekulski, Dimitri Kotlovsky
+		 */
+		class COMP_EXPORTS Tracer
+		{
+
+		public:
+
+			/**
+			 * Default number of spans which are kept.
+			 */
+			static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+			/**
+			 * Value of a span argument which is not set.
+			 */
+			static constexpr int NONE = -1;
+
+			/**
+			 * Create a disabled tracer, the ring buffer is allocated when the tracer is enabled the first time.
+			 * @param capacity Number of spans which are kept, older spans are overwritten.
+			 */
+			explicit Tracer(size_t capacity = DEFAULT_CAPACITY);
+
+			/**
+			 * Get the tracer which is used by the stage timers and stream workers of this process.
+			 * @return Shared tracer.
+			 */
+			static PTR_TRACER Shared();
+
+			/**
+			 * Get the shared tracer if it records spans.
+			 * @return Shared tracer or nullptr if it is disabled.
+			 */
+			static Tracer* Active();
+
+			/**
+			 * Start recording spans.
+			 */
+			void Enable();
+
+			/**
+			 * Stop recording spans, recorded spans are kept until they are cleared.
+			 */
+			void Disable();
+
+			/**
+			 * Check if spans are recorded.
+			 * @return <code>True</code> if spans are recorded.
+			 */
+			bool IsEnabled() const;
+
+			/**
+			 * Record a span of the current thread if the tracer is enabled.
+			 * @param name Name of the span, must be a string literal or live as long as the tracer.
+			 * @param category Category of the span, must be a string literal or live as long as the tracer.
+			 * @param start Start time of the span.
+			 * @param end End time of the span.
+			 * @param stream ID of the stream of the frame or NONE.
+			 * @param frame Sequence number of the frame or NONE.
+			 * @param model ID of the model or NONE.
+			 */
+			void Record(const char* name,
+				const char* category,
+				std::chrono::steady_clock::time_point start,
+				std::chrono::steady_clock::time_point end,
+				int stream = NONE,
+				long long frame = NONE,
+				int model = NONE);
+
+			/**
+			 * Name the current thread in the exported timeline, names are kept also if spans are overwritten.
+			 * @param name Name of the thread.
+			 */
+			void ThreadName(const std::string& name);
+
+			/**
+			 * Write all kept spans as trace event JSON.
+			 * @param out Stream to write to.
+			 */
+			void Dump(std::ostream& out) const;
+
+			/**
+			 * Write all kept spans as trace event JSON to a file.
+			 * @param path Path of the file, an existing file is overwritten.
+			 * @return <code>True</code> if the file was written.
+			 */
+			bool Dump(const std::string& path) const;
+
+			/**
+			 * Remove all kept spans.
+			 */
+			void Clear();
+
+		private:
+
+			/**
+			 * Span in the ring buffer. All fields are atomic, so a dump can read spans while they are overwritten and
+			 * skips spans which changed meanwhile.
+			 */
+			struct Span
+			{
+				/**
+				 * Odd while the span is written, otherwise twice the number of the recorded span plus two.
+				 */
+				std::atomic<unsigned long long> version;
+
+				/**
+				 * Name of the span.
+				 */
+				std::atomic<const char*> name;
+
+				/**
+				 * Category of the span.
+				 */
+				std::atomic<const char*> category;
+
+				/**
+				 * Start time in nanoseconds since the creation of the tracer.
+				 */
+				std::atomic<long long> start;
+
+				/**
+				 * Duration in nanoseconds.
+				 */
+				std::atomic<long long> duration;
+
+				/**
+				 * Thread which recorded the span.
+				 */
+				std::atomic<int> thread;
+
+				/**
+				 * Stream ID of the frame.
+				 */
+				std::atomic<int> stream;
+
+				/**
+				 * Sequence number of the frame.
+				 */
+				std::atomic<long long> frame;
+
+				/**
+				 * Model ID.
+				 */
+				std::atomic<int> model;
+			};
+
+			/**
+			 * Get the ID of the current thread in the timeline.
+			 * @return Small number which is unique for each thread of the process.
+			 */
+			static int CurrentThread();
+
+			/**
+			 * Number of spans which are kept.
+			 */
+			size_t capacity;
+
+			/**
+			 * Ring buffer of spans, allocated once and never released while the tracer exists.
+			 */
+			std::unique_ptr<Span[]> spans;
+
+			/**
+			 * Number of recorded spans, the next span is written to this number modulo the capacity.
+			 */
+			std::atomic<unsigned long long> next;
+
+			/**
+			 * Number of the first span which is kept after the spans were cleared.
+			 */
+			std::atomic<unsigned long long> first;
+
+			/**
+			 * Indicator if spans are recorded.
+			 */
+			std::atomic<bool> enabled;
+
+			/**
+			 * Creation time of the tracer, span times are relative to it.
+			 */
+			std::chrono::steady_clock::time_point epoch;
+
+			/**
+			 * Names of the threads by their ID.
+			 */
+			std::map<int, std::string> threadNames;
+
+			/**
+			 * Mutex to allocate the ring buffer and to access the thread names.
+			 */
+			mutable std::mutex mx;
+
+			Tracer(const Tracer&) = delete;
+			Tracer& operator=(const Tracer&) = delete;
+		};
+
+		/**
+		 * Scoped span which is recorded by the shared tracer, the span is skipped if the tracer is disabled when the
+		 * scope starts.
+		 * @author Andreas Sekulski, Dimitri Kotlovsky
+		 */
+		class COMP_EXPORTS TraceSpan
+		{
+
+		public:
+
+			/**
+			 * Start a span of the current thread.
+			 * @param name Name of the span, must be a string literal.
+			 * @param category Category of the span, must be a string literal.
+			 * @param stream ID of the stream or Tracer::NONE.
+			 */
+			explicit TraceSpan(const char* name, const char* category = "stream", int stream = Tracer::NONE);
+
+			/**
+			 * Destructor, records the span.
+			 */
+			~TraceSpan();
+
+		private:
+
+			/**
+			 * Name of the span.
+			 */
+			const char* name;
+
+			/**
+			 * Category of the span.
+			 */
+			const char* category;
+
+			/**
+			 * Stream ID of the span.
+			 */
+			int stream;
+
+			/**
+			 * Tracer to record to, nullptr if the tracer was disabled.
+			 */
+			Tracer* tracer;
+
+			/**
+			 * Start time of the span.
+			 */
+			std::chrono::steady_clock::time_point start;
+
+			TraceSpan(const TraceSpan&) = delete;
+			TraceSpan& operator=(const TraceSpan&) = delete;
+		};
+	}
+}
+
+#endif //COMPANION_TRACER_H
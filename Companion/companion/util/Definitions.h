@@ -38,6 +38,16 @@ namespace Companion
 	// Thread worker definitions
 	#define STREAM_WORKER Companion::Thread::StreamWorker
 	#define PTR_STREAM_WORKER std::shared_ptr<STREAM_WORKER>
+	#define FRAME_RING Companion::Thread::FrameRing
+	#define PTR_FRAME_RING std::shared_ptr<FRAME_RING>
+	#define STAGE_QUEUE Companion::Thread::StageQueue
+	#define PTR_STAGE_QUEUE std::shared_ptr<STAGE_QUEUE>
+	#define TASK_POOL Companion::Thread::TaskPool
+	#define PTR_TASK_POOL std::shared_ptr<TASK_POOL>
+	#define SKIP_CONTROLLER Companion::Thread::SkipController
+	#define PTR_SKIP_CONTROLLER std::shared_ptr<SKIP_CONTROLLER>
+	#define TRACER Companion::Thread::Tracer
+	#define PTR_TRACER std::shared_ptr<TRACER>
 
 	// Stream module definitions
 	#define STREAM Companion::Input::Stream
@@ -62,6 +72,9 @@ namespace Companion
 	#define HASH_RECOGNITION Companion::Processing::Recognition::HashRecognition
 	#define PTR_HASH_RECOGNITION std::shared_ptr<HASH_RECOGNITION>
 
+	#define CATALOG_RECOGNITION Companion::Processing::Recognition::CatalogRecognition
+	#define PTR_CATALOG_RECOGNITION std::shared_ptr<CATALOG_RECOGNITION>
+
 	// Algorithm definitions
 	#define MATCHING_RECOGNITION Companion::Algorithm::Recognition::Matching::Matching
 	#define PTR_MATCHING_RECOGNITION std::shared_ptr<MATCHING_RECOGNITION>
@@ -69,6 +82,14 @@ namespace Companion
 	#define IMAGE_REDUCTION_ALGORITHM Companion::Algorithm::Recognition::Matching::IRA
 	#define PTR_IMAGE_REDUCTION_ALGORITHM std::shared_ptr<IMAGE_REDUCTION_ALGORITHM>
 
+	#define CATALOG_INDEX Companion::Algorithm::Recognition::Matching::CatalogIndex
+	#define PTR_CATALOG_INDEX std::shared_ptr<CATALOG_INDEX>
+
+	#define HAMMING_MATCHER Companion::Algorithm::Recognition::Matching::HammingMatcher
+
+	#define KLT_TRACKING Companion::Algorithm::Tracking::KLTTracking
+	#define PTR_KLT_TRACKING std::shared_ptr<KLT_TRACKING>
+
 	#define FEATURE_MATCHING Companion::Algorithm::Recognition::Matching::FeatureMatching
 	#define PTR_FEATURE_MATCHING std::shared_ptr<FEATURE_MATCHING>
 
@@ -82,8 +103,28 @@ namespace Companion
 	#define MODEL_FEATURE_MATCHING Companion::Model::Processing::FeatureMatchingModel
 	#define PTR_MODEL_FEATURE_MATCHING std::shared_ptr<MODEL_FEATURE_MATCHING>
 
+	#define SCENE_FEATURES Companion::Model::Processing::SceneFeatures
+	#define PTR_SCENE_FEATURES std::shared_ptr<const SCENE_FEATURES>
+
+	#define MODEL_TRACKING Companion::Model::Processing::TrackingModel
+	#define PTR_MODEL_TRACKING std::shared_ptr<MODEL_TRACKING>
+
+	#define FRAME_STATE Companion::Model::Processing::FrameState
+	#define PTR_FRAME_STATE std::shared_ptr<FRAME_STATE>
+
+	#define STREAM_MODELS Companion::Model::Processing::StreamModels
+	#define PTR_STREAM_MODELS std::shared_ptr<STREAM_MODELS>
+
 	#define MODEL_IMAGE_HASHING Companion::Model::Processing::ImageHashModel
 	#define PTR_MODEL_IMAGE_HASHING std::shared_ptr<MODEL_IMAGE_HASHING>
+	#define IMAGE_HASH_DATASET Companion::Model::Processing::ImageHashModel::Dataset
+	#define PTR_IMAGE_HASH_DATASET std::shared_ptr<const IMAGE_HASH_DATASET>
+
+	#define STREAM_METRICS Companion::Model::Stream::StreamMetrics
+	#define PTR_STREAM_METRICS std::shared_ptr<STREAM_METRICS>
+
+	#define FRAME_STATS Companion::Model::Stream::FrameStats
+	#define PTR_FRAME_STATS std::shared_ptr<FRAME_STATS>
 
 	// Draw model definitions
 	#define DRAW Companion::Draw::Drawable
@@ -115,6 +156,16 @@ namespace Companion
       */
     #define SUCCESS_CALLBACK void(CALLBACK_RESULT, cv::Mat)
 
+     /**
+      * Success callback function declaration to obtain results together with the ID of the stream they belong to.
+      */
+    #define STREAM_SUCCESS_CALLBACK void(int, CALLBACK_RESULT, cv::Mat)
+
+     /**
+      * Stats callback function declaration to obtain the processing times of each frame.
+      */
+    #define STATS_CALLBACK void(PTR_FRAME_STATS)
+
       /**
        * Default error callback function declaration to obtain error results from companion.
        */
@@ -34,6 +34,12 @@ void Companion::Util::ResizeImage(cv::Mat& img, SCALING scaling)
 	cv::resize(img, img, cv::Size(size.x, size.y), cv::INTER_AREA);
 }
 
+void Companion::Util::ResizeImage(const cv::Mat& img, cv::Mat& dst, SCALING scaling)
+{
+	cv::Point size = Scaling(scaling);
+	cv::resize(img, dst, cv::Size(size.x, size.y), cv::INTER_AREA);
+}
+
 void Companion::Util::ResizeImage(cv::Mat& img, cv::Size size)
 {
 	cv::resize(img, img, size);
@@ -40,6 +40,26 @@ namespace Companion
 		GRAY ///< GRAY color format.
 	};
 
+	/**
+	 * Backpressure policies if the frame buffer of a stream is full.
+	 */
+	enum class BackpressurePolicy
+	{
+		BLOCK, ///< Wait until a frame of the buffer is processed, no frame is lost.
+		DROP_NEWEST, ///< Drop the obtained frame and keep the buffered frames.
+		DROP_OLDEST, ///< Drop the oldest buffered frame to store the obtained frame.
+		KEEP_LATEST ///< Drop all buffered frames and keep only the obtained frame, for live cameras where freshness matters.
+	};
+
+	/**
+	 * Modes to stop a running configuration.
+	 */
+	enum class StopMode
+	{
+		DRAIN, ///< Stop obtaining frames and deliver the results of all buffered frames.
+		ABORT ///< Stop obtaining frames, discard buffered frames and deliver no more results.
+	};
+
 	/**
 	 * Scaling resolutions.
 	 */
@@ -92,6 +112,14 @@ namespace Companion
 		 */
 		static void ResizeImage(cv::Mat& img, SCALING scaling);
 
+		/**
+		 * Resize given image into a destination image.
+		 * @param img Image to resize.
+		 * @param dst Resized image, its memory is reused if it has the size and type of the resized image.
+		 * @param scaling Scaling factor to resize.
+		 */
+		static void ResizeImage(const cv::Mat& img, cv::Mat& dst, SCALING scaling);
+
 		/**
 		 * Resize given image.
 		 * @param img Image to resize.
@@ -0,0 +1,90 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <companion/algo/recognition/matching/util/HammingMatcher.h>
+#include <companion/processing/recognition/MatchRecognition.h>
+
+void Companion::Benchmark::AllocationBench(std::ostream& out)
+{
+	const int warmup = 10;
+	const int frames = 30;
+	const int modelCount = 4;
+	cv::RNG rng(4711);
+	std::vector<cv::Mat> objects;
+	std::vector<cv::Mat> scenes;
+
+	for (int i = 0; i < modelCount; i++)
+	{
+		objects.push_back(RandomTexture(cv::Size(200, 200), rng));
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		scenes.push_back(RandomScene(cv::Size(1280, 720), objects, rng));
+	}
+
+	// OpenCV matcher compared to the SIMD hamming matcher with a persistent index per model
+	for (int simd = 0; simd <= 1; simd++)
+	{
+		cv::Ptr<cv::ORB> orb = cv::ORB::create(2000);
+		PTR_FEATURE_MATCHING featureMatching = std::make_shared<FEATURE_MATCHING>(orb,
+			orb,
+			cv::DescriptorMatcher::create("BruteForce-Hamming"),
+			simd == 1 ? HAMMING_MATCHER::BRUTEFORCE_HAMMING_SIMD : cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
+		featureMatching->UseModelIndex(simd == 1);
+
+		PTR_MATCH_RECOGNITION recognition = std::make_shared<MATCH_RECOGNITION>(featureMatching, Companion::SCALING::SCALE_1280x720);
+		for (int i = 0; i < modelCount; i++)
+		{
+			PTR_MODEL_FEATURE_MATCHING model = std::make_shared<MODEL_FEATURE_MATCHING>();
+			model->ID(i);
+			model->Image(objects[i]);
+			recognition->AddModel(model);
+		}
+
+		// Buffers of all threads grow to their largest size during warm-up
+		for (int i = 0; i < warmup; i++)
+		{
+			recognition->Execute(scenes[i % scenes.size()].clone());
+		}
+
+		std::vector<cv::Mat> inputs;
+		for (int i = 0; i < frames; i++)
+		{
+			inputs.push_back(scenes[i % scenes.size()].clone());
+		}
+
+		CountAllocations(true);
+		unsigned long long heap = HeapAllocations();
+		unsigned long long mats = MatAllocations();
+		for (int i = 0; i < frames; i++)
+		{
+			recognition->Execute(inputs[i]);
+		}
+		heap = HeapAllocations() - heap;
+		mats = MatAllocations() - mats;
+		CountAllocations(false);
+
+		out << "allocations matcher=" << (simd == 1 ? "hamming_simd_index" : "bruteforce")
+			<< " models=" << modelCount
+			<< " frames=" << frames
+			<< " heap_per_frame=" << static_cast<double>(heap) / frames
+			<< " mat_per_frame=" << static_cast<double>(mats) / frames << std::endl;
+	}
+}
@@ -0,0 +1,143 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	/**
+	 * Indicator if allocations are counted.
+	 */
+	std::atomic<bool> counting(false);
+
+	/**
+	 * Number of global new allocations.
+	 */
+	std::atomic<unsigned long long> heapAllocations(0);
+
+	/**
+	 * Number of cv::Mat data allocations.
+	 */
+	std::atomic<unsigned long long> matAllocations(0);
+
+#if CV_VERSION_MAJOR >= 4
+	typedef cv::AccessFlag AccessFlags;
+#else
+	typedef int AccessFlags;
+#endif
+
+	/**
+	 * Default cv::Mat allocator which counts its allocations and forwards them to the standard allocator. Allocated
+	 * data keeps the standard allocator, so it is released by the standard allocator also after counting stopped.
+	 */
+	class CountingMatAllocator : public cv::MatAllocator
+	{
+
+	public:
+
+		cv::UMatData* allocate(int dims,
+			const int* sizes,
+			int type,
+			void* data,
+			size_t* step,
+			AccessFlags flags,
+			cv::UMatUsageFlags usageFlags) const
+		{
+			if (data == nullptr && counting.load(std::memory_order_relaxed))
+			{
+				matAllocations.fetch_add(1, std::memory_order_relaxed);
+			}
+			return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+		}
+
+		bool allocate(cv::UMatData* data, AccessFlags accessFlags, cv::UMatUsageFlags usageFlags) const
+		{
+			return cv::Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+		}
+
+		void deallocate(cv::UMatData* data) const
+		{
+			cv::Mat::getStdAllocator()->deallocate(data);
+		}
+	};
+
+	/**
+	 * Allocate memory for global new.
+	 * @param size Size in bytes.
+	 * @return Allocated memory.
+	 */
+	void* Allocate(std::size_t size)
+	{
+		if (counting.load(std::memory_order_relaxed))
+		{
+			heapAllocations.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void* memory = std::malloc(size > 0 ? size : 1);
+		if (memory == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	return Allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return Allocate(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void Companion::Benchmark::CountAllocations(bool count)
+{
+	static CountingMatAllocator allocator;
+
+	if (count)
+	{
+		cv::Mat::setDefaultAllocator(&allocator);
+	}
+	counting.store(count, std::memory_order_relaxed);
+}
+
+unsigned long long Companion::Benchmark::HeapAllocations()
+{
+	return heapAllocations.load(std::memory_order_relaxed);
+}
+
+unsigned long long Companion::Benchmark::MatAllocations()
+{
+	return matAllocations.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,79 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <companion/processing/recognition/MatchRecognition.h>
+
+void Companion::Benchmark::BatchBench(std::ostream& out)
+{
+	const int images = 64;
+	const int modelCount = 4;
+	cv::RNG rng(4711);
+	std::vector<cv::Mat> objects;
+	std::vector<cv::Mat> scenes;
+	int singleFound = 0;
+	int batchFound = 0;
+
+	for (int i = 0; i < modelCount; i++)
+	{
+		objects.push_back(RandomTexture(cv::Size(200, 200), rng));
+	}
+	for (int i = 0; i < images; i++)
+	{
+		scenes.push_back(RandomScene(cv::Size(1280, 720), objects, rng));
+	}
+
+	cv::Ptr<cv::ORB> orb = cv::ORB::create(2000);
+	PTR_FEATURE_MATCHING featureMatching = std::make_shared<FEATURE_MATCHING>(orb,
+		orb,
+		cv::DescriptorMatcher::create("BruteForce-Hamming"),
+		cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
+	PTR_MATCH_RECOGNITION recognition = std::make_shared<MATCH_RECOGNITION>(featureMatching, Companion::SCALING::SCALE_1280x720);
+	for (int i = 0; i < modelCount; i++)
+	{
+		PTR_MODEL_FEATURE_MATCHING model = std::make_shared<MODEL_FEATURE_MATCHING>();
+		model->ID(i);
+		model->Image(objects[i]);
+		recognition->AddModel(model);
+	}
+
+	// One image after another like the image stream does, models are matched concurrently
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < images; i++)
+	{
+		singleFound += static_cast<int>(recognition->Execute(scenes[i]).size());
+	}
+	double singleMs = ElapsedMs(start);
+
+	// Images and models are matched concurrently
+	start = Clock::now();
+	std::vector<PTR_FRAME_STATE> states = recognition->ExecuteBatch(scenes);
+	double batchMs = ElapsedMs(start);
+	for (size_t i = 0; i < states.size(); i++)
+	{
+		batchFound += static_cast<int>(states[i]->Results().size());
+	}
+
+	out << "batch images=" << images
+		<< " models=" << modelCount
+		<< " single_images_per_s=" << (images / (singleMs / 1000.0))
+		<< " batch_images_per_s=" << (images / (batchMs / 1000.0))
+		<< " single_found=" << singleFound
+		<< " batch_found=" << batchFound << std::endl;
+}
@@ -0,0 +1,200 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+cv::Mat Companion::Benchmark::RandomTexture(cv::Size size, cv::RNG& rng)
+{
+	cv::Mat image(size, CV_8UC3);
+	cv::Mat noise(size.height / 8 + 1, size.width / 8 + 1, CV_8UC3);
+
+	// Smooth background with low frequency noise
+	rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(255));
+	cv::resize(noise, image, size, 0, 0, cv::INTER_LINEAR);
+
+	// Random shapes provide corners and edges for the feature detectors
+	int shapes = (size.area() / 2500) + 8;
+	for (int i = 0; i < shapes; i++)
+	{
+		cv::Point a(rng.uniform(0, size.width), rng.uniform(0, size.height));
+		cv::Point b(rng.uniform(0, size.width), rng.uniform(0, size.height));
+		cv::Scalar color(rng.uniform(0, 255), rng.uniform(0, 255), rng.uniform(0, 255));
+		int thickness = (rng.uniform(0, 2) == 0) ? cv::FILLED : rng.uniform(1, 4);
+
+		switch (rng.uniform(0, 3))
+		{
+		case 0:
+			cv::rectangle(image, a, a + (b - a) / 4, color, thickness);
+			break;
+		case 1:
+			cv::circle(image, a, rng.uniform(2, std::max(3, size.width / 10)), color, thickness);
+			break;
+		default:
+			cv::line(image, a, b, color, std::max(thickness, 1));
+			break;
+		}
+	}
+
+	return image;
+}
+
+cv::Mat Companion::Benchmark::RandomScene(cv::Size size, const std::vector<cv::Mat>& models, cv::RNG& rng)
+{
+	cv::Mat scene = RandomTexture(size, rng);
+
+	for (const cv::Mat& model : models)
+	{
+		if (model.cols < size.width && model.rows < size.height)
+		{
+			cv::Rect area(rng.uniform(0, size.width - model.cols), rng.uniform(0, size.height - model.rows), model.cols, model.rows);
+			model.copyTo(scene(area));
+		}
+	}
+
+	return scene;
+}
+
+Companion::Benchmark::SyntheticScene Companion::Benchmark::WarpedScene(cv::Size size,
+	const std::vector<cv::Mat>& models,
+	int objects,
+	cv::RNG& rng)
+{
+	SyntheticScene scene;
+	std::vector<int> order;
+	cv::Mat warped;
+	cv::Mat mask;
+	cv::Mat noise(size, CV_16SC3);
+	// Placed objects cover about a quarter of the scene height
+	int side = std::max(32, size.height / 4);
+
+	scene.image = RandomTexture(size, rng);
+
+	for (size_t i = 0; i < models.size(); i++)
+	{
+		order.push_back(static_cast<int>(i));
+	}
+	for (size_t i = order.size(); i > 1; i--)
+	{
+		std::swap(order[i - 1], order[rng.uniform(0, static_cast<int>(i))]);
+	}
+
+	for (size_t i = 0; i < order.size() && static_cast<int>(scene.models.size()) < objects; i++)
+	{
+		const cv::Mat& model = models[order[i]];
+		std::vector<cv::Point2f> source = { cv::Point2f(0, 0),
+			cv::Point2f(static_cast<float>(model.cols), 0),
+			cv::Point2f(static_cast<float>(model.cols), static_cast<float>(model.rows)),
+			cv::Point2f(0, static_cast<float>(model.rows)) };
+		std::vector<cv::Point2f> target(4);
+		cv::Rect area;
+		bool free = false;
+
+		// Random position, scale and perspective, objects must not overlap
+		for (int attempt = 0; attempt < 20 && !free; attempt++)
+		{
+			float width = static_cast<float>(side * rng.uniform(0.8, 1.2));
+			float height = width * model.rows / model.cols;
+			float jitter = width * 0.15f;
+			cv::Point2f origin(rng.uniform(0.0f, std::max(1.0f, size.width - width - 2 * jitter)) + jitter,
+				rng.uniform(0.0f, std::max(1.0f, size.height - height - 2 * jitter)) + jitter);
+
+			target[0] = origin + cv::Point2f(rng.uniform(-jitter, jitter), rng.uniform(-jitter, jitter));
+			target[1] = origin + cv::Point2f(width + rng.uniform(-jitter, jitter), rng.uniform(-jitter, jitter));
+			target[2] = origin + cv::Point2f(width + rng.uniform(-jitter, jitter), height + rng.uniform(-jitter, jitter));
+			target[3] = origin + cv::Point2f(rng.uniform(-jitter, jitter), height + rng.uniform(-jitter, jitter));
+			area = cv::boundingRect(target) & cv::Rect(0, 0, size.width, size.height);
+
+			free = area.area() > 0;
+			for (size_t j = 0; j < scene.areas.size() && free; j++)
+			{
+				free = (area & scene.areas[j]).area() == 0;
+			}
+		}
+
+		if (!free)
+		{
+			continue;
+		}
+
+		cv::Mat homography = cv::getPerspectiveTransform(source, target);
+		cv::warpPerspective(model, warped, homography, size);
+		cv::warpPerspective(cv::Mat(model.size(), CV_8U, cv::Scalar(255)), mask, homography, size);
+		warped.copyTo(scene.image, mask);
+
+		scene.models.push_back(order[i]);
+		scene.areas.push_back(area);
+	}
+
+	// Sensor noise and a slightly defocused lens
+	rng.fill(noise, cv::RNG::NORMAL, cv::Scalar::all(0), cv::Scalar::all(rng.uniform(2.0, 8.0)));
+	cv::add(scene.image, noise, scene.image, cv::noArray(), CV_8UC3);
+	int kernel = rng.uniform(0, 2) == 0 ? 3 : 5;
+	cv::GaussianBlur(scene.image, scene.image, cv::Size(kernel, kernel), 0);
+
+	return scene;
+}
+
+Companion::Benchmark::SceneStream::SceneStream(const std::vector<cv::Mat>& scenes, int frames, const std::atomic<int>& delivered)
+	: scenes(scenes), frames(frames), obtained(0), delivered(delivered), obtainedTimes(frames)
+{
+}
+
+cv::Mat Companion::Benchmark::SceneStream::ObtainImage()
+{
+	if (this->obtained >= this->frames)
+	{
+		return cv::Mat();
+	}
+	this->obtainedTimes[this->obtained] = Clock::now();
+	return this->scenes[this->obtained++ % this->scenes.size()].clone();
+}
+
+bool Companion::Benchmark::SceneStream::IsFinished()
+{
+	return this->delivered >= this->frames;
+}
+
+void Companion::Benchmark::SceneStream::Finish()
+{
+	this->obtained = this->frames;
+}
+
+Companion::Benchmark::Clock::time_point Companion::Benchmark::SceneStream::Obtained(int frame) const
+{
+	return this->obtainedTimes.at(frame);
+}
+
+double Companion::Benchmark::ElapsedMs(const Clock::time_point& start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double Companion::Benchmark::Percentile(std::vector<double> values, double percentile)
+{
+	if (values.empty())
+	{
+		return 0.0;
+	}
+
+	size_t index = static_cast<size_t>((percentile / 100.0) * (values.size() - 1) + 0.5);
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
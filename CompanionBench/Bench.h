@@ -0,0 +1,259 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPANION_BENCH_H
+#define COMPANION_BENCH_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include <companion/input/Stream.h>
+
+namespace Companion {
+	namespace Benchmark
+	{
+		/**
+		 * Monotonic clock used by all benchmarks.
+		 */
+		typedef std::chrono::steady_clock Clock;
+
+		/**
+		 * Synthetic scene with the ground truth of the objects it contains.
+		 */
+		struct SyntheticScene
+		{
+			/**
+			 * Scene BGR image.
+			 */
+			cv::Mat image;
+
+			/**
+			 * Indices of the model images placed into the scene.
+			 */
+			std::vector<int> models;
+
+			/**
+			 * Bounding box of each placed model image.
+			 */
+			std::vector<cv::Rect> areas;
+		};
+
+		/**
+		 * Stream which repeats the given scenes until a number of frames is processed.
+		 */
+		class SceneStream : public Companion::Input::Stream
+		{
+
+		public:
+
+			/**
+			 * Create a stream over the given scenes.
+			 * @param scenes Scenes to repeat.
+			 * @param frames Number of frames to obtain.
+			 * @param delivered Number of delivered results, the stream finishes once all frames are delivered.
+			 */
+			SceneStream(const std::vector<cv::Mat>& scenes, int frames, const std::atomic<int>& delivered);
+
+			using Companion::Input::Stream::ObtainImage;
+
+			cv::Mat ObtainImage();
+
+			bool IsFinished();
+
+			void Finish();
+
+			/**
+			 * Get the time a frame was obtained.
+			 * @param frame Number of the frame, only frames which were obtained already can be requested.
+			 * @return Time the frame was obtained.
+			 */
+			Clock::time_point Obtained(int frame) const;
+
+		private:
+
+			/**
+			 * Scenes to repeat.
+			 */
+			const std::vector<cv::Mat>& scenes;
+
+			/**
+			 * Number of frames to obtain.
+			 */
+			int frames;
+
+			/**
+			 * Number of obtained frames.
+			 */
+			int obtained;
+
+			/**
+			 * Number of delivered results.
+			 */
+			const std::atomic<int>& delivered;
+
+			/**
+			 * Time each frame was obtained, allocated up front so consumers can read it while frames are obtained.
+			 */
+			std::vector<Clock::time_point> obtainedTimes;
+		};
+
+		/**
+		 * Create a random textured image which contains enough corners and edges for feature detectors.
+		 * @param size Size of the image.
+		 * @param rng Random number generator.
+		 * @return Random textured BGR image.
+		 */
+		cv::Mat RandomTexture(cv::Size size, cv::RNG& rng);
+
+		/**
+		 * Create a scene from a random background and paste the given model images at random positions.
+		 * @param size Size of the scene.
+		 * @param models Model images to paste into the scene.
+		 * @param rng Random number generator.
+		 * @return Scene BGR image.
+		 */
+		cv::Mat RandomScene(cv::Size size, const std::vector<cv::Mat>& models, cv::RNG& rng);
+
+		/**
+		 * Create a scene from a random background and warp some of the given model images into it with random
+		 * homographies, then degrade the scene with noise and blur like a camera image.
+		 * @param size Size of the scene.
+		 * @param models Model images to choose from.
+		 * @param objects Number of model images to place, each model is placed at most once.
+		 * @param rng Random number generator.
+		 * @return Scene with the indices and bounding boxes of the placed models.
+		 */
+		SyntheticScene WarpedScene(cv::Size size, const std::vector<cv::Mat>& models, int objects, cv::RNG& rng);
+
+		/**
+		 * Elapsed milliseconds since the given start time.
+		 * @param start Start time.
+		 * @return Elapsed time in milliseconds.
+		 */
+		double ElapsedMs(const Clock::time_point& start);
+
+		/**
+		 * Obtain the percentile of the given values.
+		 * @param values Values to obtain percentile from.
+		 * @param percentile Percentile between 0 and 100.
+		 * @return Percentile value or 0 if no values exist.
+		 */
+		double Percentile(std::vector<double> values, double percentile);
+
+		/**
+		 * Start or stop counting heap allocations of global new and cv::Mat data allocations. Counting is off by default,
+		 * so other benchmarks do not pay for the shared counters.
+		 * @param count <code>True</code> to count allocations.
+		 */
+		void CountAllocations(bool count);
+
+		/**
+		 * Get number of counted global new allocations, including the headers of cv::Mat data.
+		 * @return Number of heap allocations.
+		 */
+		unsigned long long HeapAllocations();
+
+		/**
+		 * Get number of counted cv::Mat data allocations of the default allocator.
+		 * @return Number of cv::Mat allocations.
+		 */
+		unsigned long long MatAllocations();
+
+		/**
+		 * Frame latency with and without the per-frame scene feature cache for growing model counts.
+		 * @param out Output stream to write results to.
+		 */
+		void SceneFeaturesBench(std::ostream& out);
+
+		/**
+		 * Frame latency of the catalog-wide index compared to per-model matching for growing catalog sizes.
+		 * @param out Output stream to write results to.
+		 */
+		void CatalogBench(std::ostream& out);
+
+		/**
+		 * 2-NN matching time of the SIMD hamming matcher compared to cv::BFMatcher for binary descriptor sets.
+		 * @param out Output stream to write results to.
+		 */
+		void HammingBench(std::ostream& out);
+
+		/**
+		 * Filtering time of the one pass match filter compared to the former insertion sort ratio test for large knn match sets.
+		 * @param out Output stream to write results to.
+		 */
+		void MatchFilterBench(std::ostream& out);
+
+		/**
+		 * Steady state frame latency of match recognition with and without keyframe tracking for a moving object.
+		 * @param out Output stream to write results to.
+		 */
+		void TrackingBench(std::ostream& out);
+
+		/**
+		 * Homography estimation time and accuracy of PROSAC compared to OpenCV RANSAC for distance sorted correspondences.
+		 * @param out Output stream to write results to.
+		 */
+		void HomographyBench(std::ostream& out);
+
+		/**
+		 * Frame hand-off throughput, latency and image allocations of the lock-free frame ring compared to the former
+		 * mutex guarded stream worker queue.
+		 * @param out Output stream to write results to.
+		 */
+		void FrameRingBench(std::ostream& out);
+
+		/**
+		 * Per stage latency of match recognition and stream throughput of sequential compared to pipelined stages.
+		 * @param out Output stream to write results to.
+		 */
+		void PipelineBench(std::ostream& out);
+
+		/**
+		 * Frame time of uneven model and region of interest workloads on the work-stealing task pool compared to the
+		 * former OpenMP loop over models.
+		 * @param out Output stream to write results to.
+		 */
+		void TaskPoolBench(std::ostream& out);
+
+		/**
+		 * Image throughput of match recognition for a batch of still images compared to executing one image after
+		 * another.
+		 * @param out Output stream to write results to.
+		 */
+		void BatchBench(std::ostream& out);
+
+		/**
+		 * Frames per second, p50 and p99 frame latency and recall of match, hash and hybrid recognition and object
+		 * detection on synthetic warped scenes across model counts, resolutions and consumer thread counts. Each
+		 * configuration is written as one JSON object per line.
+		 * @param out Output stream to write results to.
+		 */
+		void RecognitionBench(std::ostream& out);
+
+		/**
+		 * Heap and cv::Mat allocations per frame of match recognition after warm-up, with the OpenCV matcher and with
+		 * the SIMD hamming matcher and model index.
+		 * @param out Output stream to write results to.
+		 */
+		void AllocationBench(std::ostream& out);
+	}
+}
+
+#endif //COMPANION_BENCH_H
@@ -0,0 +1,84 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <companion/processing/recognition/MatchRecognition.h>
+#include <companion/processing/recognition/CatalogRecognition.h>
+#include <omp.h>
+
+void Companion::Benchmark::CatalogBench(std::ostream& out)
+{
+	const int modelCounts[] = { 10, 100, 500, 1000 };
+	const int frames = 3;
+	cv::RNG rng(4711);
+
+	cv::Ptr<cv::ORB> orb = cv::ORB::create();
+	std::vector<cv::Mat> images;
+	for (int i = 0; i < modelCounts[3]; i++)
+	{
+		images.push_back(RandomTexture(cv::Size(200, 200), rng));
+	}
+
+	cv::Mat scene = RandomScene(cv::Size(1280, 720), std::vector<cv::Mat>(images.begin(), images.begin() + 4), rng);
+
+	for (int modelCount : modelCounts)
+	{
+		PTR_FEATURE_MATCHING featureMatching = std::make_shared<FEATURE_MATCHING>(orb,
+			orb,
+			cv::DescriptorMatcher::create("BruteForce-Hamming"),
+			cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
+		PTR_MATCH_RECOGNITION perModel = std::make_shared<MATCH_RECOGNITION>(featureMatching, Companion::SCALING::SCALE_1280x720);
+		PTR_CATALOG_RECOGNITION catalog = std::make_shared<CATALOG_RECOGNITION>(featureMatching, Companion::SCALING::SCALE_1280x720);
+		double perModelMs = 0.0;
+		double catalogMs = 0.0;
+		size_t perModelFound = 0;
+		size_t catalogFound = 0;
+
+		for (int i = 0; i < modelCount; i++)
+		{
+			PTR_MODEL_FEATURE_MATCHING model = std::make_shared<MODEL_FEATURE_MATCHING>();
+			model->ID(i);
+			model->Image(images[i]);
+			perModel->AddModel(model);
+			catalog->AddModel(model);
+		}
+
+		// Warm up catalog to exclude the one time index build
+		catalog->Execute(scene.clone());
+
+		for (int frame = 0; frame < frames; frame++)
+		{
+			Clock::time_point start = Clock::now();
+			perModelFound += perModel->Execute(scene.clone()).size();
+			perModelMs += ElapsedMs(start);
+
+			start = Clock::now();
+			catalogFound += catalog->Execute(scene.clone()).size();
+			catalogMs += ElapsedMs(start);
+		}
+
+		out << "catalog models=" << modelCount
+			<< " threads=" << omp_get_max_threads()
+			<< " per_model_ms=" << (perModelMs / frames)
+			<< " catalog_ms=" << (catalogMs / frames)
+			<< " per_model_found=" << (perModelFound / frames)
+			<< " catalog_found=" << (catalogFound / frames)
+			<< " speedup=" << (perModelMs / std::max(catalogMs, 1e-9)) << std::endl;
+	}
+}
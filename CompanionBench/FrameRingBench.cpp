@@ -0,0 +1,275 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <companion/thread/FrameRing.h>
+
+/**
+ * Former StreamWorker hand-off with a mutex guarded queue and a freshly allocated image per frame, used as baseline.
+ */
+class QueueHandOff
+{
+
+public:
+
+	/**
+	 * Create a bounded queue.
+	 * @param capacity Maximum number of stored frames.
+	 */
+	QueueHandOff(size_t capacity) : capacity(capacity)
+	{
+	}
+
+	/**
+	 * Store a frame if the queue is not full.
+	 * @param frame Frame to store.
+	 * @param sequence Sequence number of the frame.
+	 * @return <code>True</code> if the frame was stored.
+	 */
+	bool TryPush(cv::Mat& frame, unsigned long sequence)
+	{
+		std::lock_guard<std::mutex> lk(this->mx);
+		if (this->queue.size() >= this->capacity)
+		{
+			this->cv.notify_one();
+			return false;
+		}
+		this->queue.push(std::make_pair(sequence, frame));
+		frame.release();
+		this->cv.notify_one();
+		return true;
+	}
+
+	/**
+	 * Wait for a frame until the queue is finished.
+	 * @param frame Obtained frame.
+	 * @param sequence Sequence number of the obtained frame.
+	 * @return <code>False</code> if the queue is finished and empty.
+	 */
+	bool Pop(cv::Mat& frame, unsigned long& sequence)
+	{
+		std::unique_lock<std::mutex> lk(this->mx);
+		this->cv.wait(lk, [this] { return this->finished || !this->queue.empty(); });
+		if (this->queue.empty())
+		{
+			return false;
+		}
+		sequence = this->queue.front().first;
+		frame = this->queue.front().second;
+		this->queue.pop();
+		return true;
+	}
+
+	/**
+	 * Wake all consumers, they stop once the queue is empty.
+	 */
+	void Finish()
+	{
+		std::lock_guard<std::mutex> lk(this->mx);
+		this->finished = true;
+		this->cv.notify_all();
+	}
+
+private:
+
+	/**
+	 * Maximum number of stored frames.
+	 */
+	size_t capacity;
+
+	/**
+	 * Indicator if no more frames are stored.
+	 */
+	bool finished = false;
+
+	/**
+	 * Mutex to guard the queue.
+	 */
+	std::mutex mx;
+
+	/**
+	 * Condition to wait for frames.
+	 */
+	std::condition_variable cv;
+
+	/**
+	 * Stored frames with their sequence number.
+	 */
+	std::queue<std::pair<unsigned long, cv::Mat>> queue;
+};
+
+/**
+ * Hand-off measurement of one run.
+ */
+struct HandOffResult
+{
+	/**
+	 * Handed off frames per second.
+	 */
+	double fps;
+
+	/**
+	 * Median hand-off latency in microseconds.
+	 */
+	double latencyP50;
+
+	/**
+	 * 99th percentile hand-off latency in microseconds.
+	 */
+	double latencyP99;
+
+	/**
+	 * Number of image buffers allocated by the producer.
+	 */
+	int allocations;
+};
+
+/**
+ * Write a synthetic decoded image into the given frame like a video decoder does.
+ * @param frame Frame to write, its buffer is reused if size and type match.
+ * @param size Image size.
+ * @param value Pixel value.
+ * @return <code>True</code> if a new buffer was allocated.
+ */
+static bool Decode(cv::Mat& frame, cv::Size size, int value)
+{
+	uchar* data = frame.data;
+	frame.create(size, CV_8UC3);
+	frame.setTo(cv::Scalar::all(value & 255));
+	return frame.data != data;
+}
+
+/**
+ * Run one producer and the given number of consumers over a hand-off implementation.
+ * @param frames Number of frames.
+ * @param consumers Number of consumer threads.
+ * @param push Push function of the producer.
+ * @param pop Pop function of the consumers, returns false if consumers should stop.
+ * @param finish Called after all frames were stored.
+ * @return Hand-off measurement.
+ */
+template<class Push, class Pop, class Finish>
+static HandOffResult RunHandOff(int frames, int consumers, Push push, Pop pop, Finish finish)
+{
+	using namespace Companion::Benchmark;
+	std::vector<Clock::time_point> pushed(frames);
+	std::vector<double> latencies(frames);
+	std::atomic<int> consumed(0);
+	std::atomic<long> checksum(0);
+	std::vector<std::thread> threads;
+	int allocations = 0;
+	cv::Size size(640, 480);
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < consumers; i++)
+	{
+		threads.push_back(std::thread([&]
+		{
+			cv::Mat frame;
+			unsigned long sequence;
+			while (pop(frame, sequence))
+			{
+				latencies[sequence] = ElapsedMs(pushed[sequence]);
+				checksum += frame.data[0];
+				consumed++;
+			}
+		}));
+	}
+
+	cv::Mat frame;
+	for (int i = 0; i < frames; i++)
+	{
+		allocations += Decode(frame, size, i) ? 1 : 0;
+		pushed[i] = Clock::now();
+		while (!push(frame, static_cast<unsigned long>(i)))
+		{
+			std::this_thread::yield();
+		}
+	}
+	finish(consumed, frames);
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	HandOffResult result;
+	result.fps = frames / (ElapsedMs(start) / 1000.0);
+	result.latencyP50 = Percentile(latencies, 50) * 1000.0;
+	result.latencyP99 = Percentile(latencies, 99) * 1000.0;
+	result.allocations = allocations;
+	return result;
+}
+
+void Companion::Benchmark::FrameRingBench(std::ostream& out)
+{
+	const int consumerCounts[] = { 1, 4 };
+	const int frames = 2000;
+	const int capacity = 5;
+
+	for (int consumers : consumerCounts)
+	{
+		QueueHandOff queue(capacity);
+		HandOffResult queueResult = RunHandOff(frames, consumers,
+			[&](cv::Mat& frame, unsigned long sequence) { return queue.TryPush(frame, sequence); },
+			[&](cv::Mat& frame, unsigned long& sequence) { return queue.Pop(frame, sequence); },
+			[&](std::atomic<int>&, int) { queue.Finish(); });
+
+		Companion::Thread::FrameRing ring(capacity);
+		std::atomic<bool> finished(false);
+		HandOffResult ringResult = RunHandOff(frames, consumers,
+			[&](cv::Mat& frame, unsigned long) { return ring.TryPush(frame); },
+			[&](cv::Mat& frame, unsigned long& sequence)
+			{
+				while (!ring.TryPop(frame, sequence))
+				{
+					if (finished)
+					{
+						return false;
+					}
+					std::this_thread::yield();
+				}
+				return true;
+			},
+			[&](std::atomic<int>& consumed, int count)
+			{
+				while (consumed < count)
+				{
+					std::this_thread::yield();
+				}
+				finished = true;
+			});
+
+		out << "frame_ring consumers=" << consumers
+			<< " frames=" << frames
+			<< " queue_fps=" << queueResult.fps
+			<< " ring_fps=" << ringResult.fps
+			<< " queue_latency_p50_us=" << queueResult.latencyP50
+			<< " ring_latency_p50_us=" << ringResult.latencyP50
+			<< " queue_latency_p99_us=" << queueResult.latencyP99
+			<< " ring_latency_p99_us=" << ringResult.latencyP99
+			<< " queue_allocations=" << queueResult.allocations
+			<< " ring_allocations=" << ringResult.allocations << std::endl;
+	}
+}
@@ -0,0 +1,75 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <companion/algo/recognition/matching/util/HammingMatcher.h>
+
+void Companion::Benchmark::HammingBench(std::ostream& out)
+{
+	const int sizes[] = { 500, 5000 };
+	const int descriptorBytes[] = { 32, 64 };
+	const int repeats = 5;
+	cv::RNG rng(4711);
+
+	for (int bytes : descriptorBytes)
+	{
+		for (int size : sizes)
+		{
+			cv::Mat query(size, bytes, CV_8U);
+			cv::Mat train(size, bytes, CV_8U);
+			std::vector<std::vector<cv::DMatch>> reference, matches;
+			cv::Ptr<cv::DescriptorMatcher> bfMatcher = cv::BFMatcher::create(cv::NORM_HAMMING);
+			cv::Ptr<cv::DescriptorMatcher> simdMatcher = HAMMING_MATCHER::create();
+			std::vector<double> bfTimes, simdTimes;
+			size_t mismatches = 0;
+
+			rng.fill(query, cv::RNG::UNIFORM, 0, 256);
+			rng.fill(train, cv::RNG::UNIFORM, 0, 256);
+
+			for (int i = 0; i < repeats; i++)
+			{
+				Clock::time_point start = Clock::now();
+				bfMatcher->knnMatch(query, train, reference, 2);
+				bfTimes.push_back(ElapsedMs(start));
+
+				start = Clock::now();
+				simdMatcher->knnMatch(query, train, matches, 2);
+				simdTimes.push_back(ElapsedMs(start));
+			}
+
+			// Indices can differ for equal distances, compare distances only
+			for (size_t q = 0; q < reference.size(); q++)
+			{
+				for (size_t n = 0; n < reference[q].size(); n++)
+				{
+					mismatches += (matches[q][n].distance != reference[q][n].distance);
+				}
+			}
+
+			out << "hamming bytes=" << bytes
+				<< " query=" << size
+				<< " train=" << size
+				<< " isa=" << HAMMING_MATCHER::InstructionSet()
+				<< " bf_ms=" << Percentile(bfTimes, 50)
+				<< " simd_ms=" << Percentile(simdTimes, 50)
+				<< " speedup=" << (Percentile(bfTimes, 50) / std::max(Percentile(simdTimes, 50), 1e-9))
+				<< " mismatches=" << mismatches << std::endl;
+		}
+	}
+}
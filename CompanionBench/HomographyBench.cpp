@@ -0,0 +1,125 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <companion/algo/recognition/matching/util/ProsacHomography.h>
+
+/**
+ * Mean corner error of an estimated homography compared to the ground truth.
+ * @param estimated Estimated homography.
+ * @param truth Ground truth homography.
+ * @param size Object size.
+ * @return Mean corner error in pixels or -1 if no homography was estimated.
+ */
+static double CornerError(const cv::Mat& estimated, const cv::Mat& truth, cv::Size size)
+{
+	std::vector<cv::Point2f> corners = { cv::Point2f(0, 0), cv::Point2f(size.width, 0),
+		cv::Point2f(size.width, size.height), cv::Point2f(0, size.height) };
+	std::vector<cv::Point2f> expected, actual;
+	double error = 0.0;
+
+	if (estimated.empty())
+	{
+		return -1.0;
+	}
+
+	cv::perspectiveTransform(corners, expected, truth);
+	cv::perspectiveTransform(corners, actual, estimated);
+	for (size_t i = 0; i < corners.size(); i++)
+	{
+		error += cv::norm(expected[i] - actual[i]);
+	}
+
+	return error / corners.size();
+}
+
+void Companion::Benchmark::HomographyBench(std::ostream& out)
+{
+	const int counts[] = { 40, 200, 1000 };
+	const double outlierRatios[] = { 0.3, 0.6 };
+	const int repeats = 50;
+	const cv::Size objectSize(400, 300);
+	cv::RNG rng(4711);
+	cv::Mat truth = (cv::Mat_<double>(3, 3) << 0.9, 0.1, 300.0, -0.05, 1.1, 150.0, 1e-4, -2e-4, 1.0);
+
+	for (int count : counts)
+	{
+		for (double outlierRatio : outlierRatios)
+		{
+			std::vector<double> ransacTimes, prosacTimes, ransacErrors, prosacErrors;
+			Companion::Algorithm::Recognition::Matching::ProsacHomography prosac(3.0, 2000);
+			double prosacIterations = 0.0;
+
+			for (int r = 0; r < repeats; r++)
+			{
+				std::vector<std::pair<float, int>> quality;
+				std::vector<cv::Point2f> object, projected, objectSorted, sceneSorted;
+				std::vector<uchar> mask;
+
+				for (int i = 0; i < count; i++)
+				{
+					object.push_back(cv::Point2f(rng.uniform(0.0f, static_cast<float>(objectSize.width)),
+						rng.uniform(0.0f, static_cast<float>(objectSize.height))));
+				}
+				cv::perspectiveTransform(object, projected, truth);
+
+				// Outliers get random positions, descriptor distance correlates with being an inlier
+				for (int i = 0; i < count; i++)
+				{
+					bool outlier = rng.uniform(0.0, 1.0) < outlierRatio;
+					if (outlier)
+					{
+						projected[i] = cv::Point2f(rng.uniform(0.0f, 1280.0f), rng.uniform(0.0f, 720.0f));
+					}
+					else
+					{
+						projected[i] += cv::Point2f(static_cast<float>(rng.gaussian(0.5)), static_cast<float>(rng.gaussian(0.5)));
+					}
+					quality.push_back(std::make_pair(outlier ? rng.uniform(20.0f, 80.0f) : rng.uniform(0.0f, 60.0f), i));
+				}
+				std::sort(quality.begin(), quality.end());
+				for (const auto& entry : quality)
+				{
+					objectSorted.push_back(object[entry.second]);
+					sceneSorted.push_back(projected[entry.second]);
+				}
+
+				Clock::time_point start = Clock::now();
+				cv::Mat ransac = cv::findHomography(objectSorted, sceneSorted, cv::RANSAC, 3.0, mask, 2000);
+				ransacTimes.push_back(ElapsedMs(start));
+				ransacErrors.push_back(CornerError(ransac, truth, objectSize));
+
+				start = Clock::now();
+				cv::Mat estimated = prosac.Estimate(objectSorted, sceneSorted, mask);
+				prosacTimes.push_back(ElapsedMs(start));
+				prosacErrors.push_back(CornerError(estimated, truth, objectSize));
+				prosacIterations += prosac.Iterations();
+			}
+
+			out << "homography matches=" << count
+				<< " outliers=" << outlierRatio
+				<< " ransac_ms=" << Percentile(ransacTimes, 50)
+				<< " prosac_ms=" << Percentile(prosacTimes, 50)
+				<< " prosac_iterations=" << (prosacIterations / repeats)
+				<< " ransac_error_px=" << Percentile(ransacErrors, 50)
+				<< " prosac_error_px=" << Percentile(prosacErrors, 50)
+				<< " speedup=" << (Percentile(ransacTimes, 50) / std::max(Percentile(prosacTimes, 50), 1e-9)) << std::endl;
+		}
+	}
+}
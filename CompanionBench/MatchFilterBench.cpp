@@ -0,0 +1,114 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <companion/algo/recognition/matching/util/MatchFilter.h>
+
+/**
+ * Former FeatureMatching::RatioTest which keeps the good matches sorted by insertion, used as baseline.
+ * @param matches Knn matches.
+ * @param good_matches Vector to store good matches.
+ * @param ratio Ratio to determine which matches are good enough.
+ * @param countMatches Maximum count of good matches.
+ */
+static void InsertionRatioTest(const std::vector<std::vector<cv::DMatch>>& matches,
+	std::vector<cv::DMatch>& good_matches,
+	float ratio,
+	size_t countMatches)
+{
+	size_t position;
+	bool insertElement;
+	for (size_t i = 0; i < matches.size(); ++i)
+	{
+		if (matches[i].size() >= 2 && (matches[i][0].distance < ratio * matches[i][1].distance))
+		{
+			position = 0;
+			insertElement = false;
+			while (position < good_matches.size() && !insertElement)
+			{
+				if (good_matches.at(position).distance > matches[i][0].distance)
+				{
+					good_matches.insert(good_matches.begin() + position, matches[i][0]);
+					insertElement = true;
+					if (good_matches.size() > countMatches)
+					{
+						good_matches.erase(good_matches.end() - 1);
+					}
+				}
+				position++;
+			}
+			if (!insertElement && good_matches.size() < countMatches)
+			{
+				good_matches.push_back(matches[i][0]);
+			}
+		}
+	}
+}
+
+void Companion::Benchmark::MatchFilterBench(std::ostream& out)
+{
+	const int matchCounts[] = { 10000, 50000, 200000 };
+	const size_t countMatches[] = { 40, 1000 };
+	const int repeats = 20;
+	cv::RNG rng(4711);
+
+	for (int matchCount : matchCounts)
+	{
+		std::vector<std::vector<cv::DMatch>> matches(matchCount);
+		for (int i = 0; i < matchCount; i++)
+		{
+			float best = rng.uniform(0.0f, 256.0f);
+			matches[i].push_back(cv::DMatch(i, rng.uniform(0, matchCount), best));
+			matches[i].push_back(cv::DMatch(i, rng.uniform(0, matchCount), best + rng.uniform(0.0f, 128.0f)));
+		}
+
+		for (size_t count : countMatches)
+		{
+			std::vector<double> insertionTimes, filterTimes, crossCheckTimes;
+			std::vector<cv::DMatch> insertionMatches, filterMatches;
+
+			for (int i = 0; i < repeats; i++)
+			{
+				insertionMatches.clear();
+				Clock::time_point start = Clock::now();
+				InsertionRatioTest(matches, insertionMatches, 0.8f, count);
+				insertionTimes.push_back(ElapsedMs(start));
+
+				filterMatches.clear();
+				start = Clock::now();
+				Companion::Algorithm::Recognition::Matching::MatchFilter::RatioTest(matches, filterMatches, 0.8f, count);
+				filterTimes.push_back(ElapsedMs(start));
+
+				std::vector<cv::DMatch> crossChecked;
+				start = Clock::now();
+				Companion::Algorithm::Recognition::Matching::MatchFilter::RatioTest(matches, crossChecked, 0.8f, count, true);
+				crossCheckTimes.push_back(ElapsedMs(start));
+			}
+
+			out << "match_filter matches=" << matchCount
+				<< " count=" << count
+				<< " insertion_ms=" << Percentile(insertionTimes, 50)
+				<< " filter_ms=" << Percentile(filterTimes, 50)
+				<< " cross_check_ms=" << Percentile(crossCheckTimes, 50)
+				<< " speedup=" << (Percentile(insertionTimes, 50) / std::max(Percentile(filterTimes, 50), 1e-9))
+				<< " same_distances=" << (insertionMatches.size() == filterMatches.size() && std::equal(insertionMatches.begin(), insertionMatches.end(), filterMatches.begin(),
+					[](const cv::DMatch& a, const cv::DMatch& b) { return a.distance == b.distance; })) << std::endl;
+		}
+	}
+}
@@ -0,0 +1,108 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <atomic>
+#include <companion/Configuration.h>
+#include <companion/processing/recognition/MatchRecognition.h>
+
+void Companion::Benchmark::PipelineBench(std::ostream& out)
+{
+	const int frames = 120;
+	const int modelCount = 4;
+	cv::RNG rng(4711);
+	std::vector<cv::Mat> objects;
+	std::vector<cv::Mat> scenes;
+
+	for (int i = 0; i < modelCount; i++)
+	{
+		objects.push_back(RandomTexture(cv::Size(200, 200), rng));
+	}
+	for (int i = 0; i < 8; i++)
+	{
+		scenes.push_back(RandomScene(cv::Size(1920, 1080), objects, rng));
+	}
+
+	cv::Ptr<cv::ORB> orb = cv::ORB::create(2000);
+	PTR_FEATURE_MATCHING featureMatching = std::make_shared<FEATURE_MATCHING>(orb,
+		orb,
+		cv::DescriptorMatcher::create("BruteForce-Hamming"),
+		cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
+	PTR_MATCH_RECOGNITION recognition = std::make_shared<MATCH_RECOGNITION>(featureMatching, Companion::SCALING::SCALE_1280x720);
+	for (int i = 0; i < modelCount; i++)
+	{
+		PTR_MODEL_FEATURE_MATCHING model = std::make_shared<MODEL_FEATURE_MATCHING>();
+		model->ID(i);
+		model->Image(objects[i]);
+		recognition->AddModel(model);
+	}
+
+	// Time of each stage executed on its own
+	std::vector<std::vector<double>> stageTimes(recognition->Stages());
+	for (size_t i = 0; i < scenes.size(); i++)
+	{
+		PTR_FRAME_STATE state = std::make_shared<FRAME_STATE>(scenes[i].clone());
+		for (int stage = 0; stage < recognition->Stages(); stage++)
+		{
+			Clock::time_point start = Clock::now();
+			recognition->ExecuteStage(stage, state);
+			stageTimes[stage].push_back(ElapsedMs(start));
+		}
+	}
+
+	double sum = 0;
+	double slowest = 0;
+	out << "pipeline stages=" << recognition->Stages();
+	for (size_t stage = 0; stage < stageTimes.size(); stage++)
+	{
+		double time = Percentile(stageTimes[stage], 50);
+		sum += time;
+		slowest = std::max(slowest, time);
+		out << " stage" << stage << "_ms=" << time;
+	}
+	out << " sum_ms=" << sum << " slowest_ms=" << slowest << std::endl;
+
+	// Throughput of the stream worker with one sequential consumer compared to one consumer per stage
+	for (int pipelined = 0; pipelined <= 1; pipelined++)
+	{
+		std::atomic<int> delivered(0);
+		std::atomic<int> found(0);
+		Companion::Configuration configuration;
+
+		configuration.Source(std::make_shared<SceneStream>(scenes, frames, delivered));
+		configuration.Processing(recognition);
+		configuration.Pipeline(pipelined == 1);
+		configuration.ImageBuffer(4);
+		configuration.ErrorCallback([&](Companion::Error::Code) { delivered++; });
+		configuration.ResultCallback([&](CALLBACK_RESULT results, cv::Mat)
+		{
+			found += static_cast<int>(results.size());
+			delivered++;
+		});
+
+		Clock::time_point start = Clock::now();
+		configuration.Run();
+		double elapsed = ElapsedMs(start);
+
+		out << "pipeline mode=" << (pipelined == 1 ? "pipelined" : "sequential")
+			<< " frames=" << delivered
+			<< " found=" << found
+			<< " fps=" << (delivered / (elapsed / 1000.0)) << std::endl;
+	}
+}
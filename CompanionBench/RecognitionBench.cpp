@@ -0,0 +1,229 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <companion/Configuration.h>
+#include <companion/algo/recognition/hashing/LSH.h>
+#include <companion/model/result/RecognitionResult.h>
+#include <companion/processing/detection/ObjectDetection.h>
+#include <companion/processing/recognition/HashRecognition.h>
+#include <companion/processing/recognition/HybridRecognition.h>
+#include <companion/processing/recognition/MatchRecognition.h>
+
+namespace
+{
+	/**
+	 * Create an ORB feature matching as used by the match and hybrid recognition.
+	 * @return Feature matching algorithm.
+	 */
+	PTR_FEATURE_MATCHING CreateFeatureMatching()
+	{
+		cv::Ptr<cv::ORB> orb = cv::ORB::create(2000);
+		return std::make_shared<FEATURE_MATCHING>(orb,
+			orb,
+			cv::DescriptorMatcher::create("BruteForce-Hamming"),
+			cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
+	}
+
+	/**
+	 * Create the processing of the given algorithm with all models added.
+	 * @param algorithm Name of the algorithm, one of match, hash, hybrid or detection.
+	 * @param models Model images, the index is used as model ID.
+	 * @param scaling Scaling of the scenes.
+	 * @return Image processing to benchmark.
+	 */
+	PTR_IMAGE_PROCESSING CreateProcessing(const std::string& algorithm,
+		const std::vector<cv::Mat>& models,
+		Companion::SCALING scaling)
+	{
+		if (algorithm == "match")
+		{
+			PTR_MATCH_RECOGNITION recognition = std::make_shared<MATCH_RECOGNITION>(CreateFeatureMatching(), scaling);
+			for (size_t i = 0; i < models.size(); i++)
+			{
+				PTR_MODEL_FEATURE_MATCHING model = std::make_shared<MODEL_FEATURE_MATCHING>();
+				model->ID(static_cast<int>(i));
+				model->Image(models[i]);
+				recognition->AddModel(model);
+			}
+			return recognition;
+		}
+
+		PTR_HASH_RECOGNITION hash = std::make_shared<HASH_RECOGNITION>(models.front().size(),
+			std::make_shared<SHAPE_DETECTION>(),
+			std::make_shared<HASHING_LSH>());
+
+		if (algorithm == "hash")
+		{
+			for (size_t i = 0; i < models.size(); i++)
+			{
+				hash->AddModel(static_cast<int>(i), models[i]);
+			}
+			return hash;
+		}
+
+		if (algorithm == "hybrid")
+		{
+			PTR_HYBRID_RECOGNITION recognition = std::make_shared<HYBRID_RECOGNITION>(hash, CreateFeatureMatching(), 100);
+			for (size_t i = 0; i < models.size(); i++)
+			{
+				recognition->AddModel(models[i], static_cast<int>(i));
+			}
+			return recognition;
+		}
+
+		return std::make_shared<OBJECT_DETECTION>(std::make_shared<SHAPE_DETECTION>());
+	}
+
+	/**
+	 * Count the ground truth objects of a scene which are found by the given results. Recognition results must have
+	 * the ID of a placed model, detection results must overlap a placed model with an IoU of at least 0.5.
+	 * @param scene Scene with its ground truth.
+	 * @param results Results obtained for the scene.
+	 * @return Number of found ground truth objects.
+	 */
+	int Found(const Companion::Benchmark::SyntheticScene& scene, const CALLBACK_RESULT& results)
+	{
+		int found = 0;
+
+		for (size_t i = 0; i < scene.models.size(); i++)
+		{
+			bool hit = false;
+			for (size_t j = 0; j < results.size() && !hit; j++)
+			{
+				PTR_RESULT_RECOGNITION recognition = std::dynamic_pointer_cast<RESULT_RECOGNITION>(results[j]);
+				if (recognition != nullptr)
+				{
+					hit = recognition->Id() == scene.models[i];
+				}
+				else if (results[j]->Drawable() != nullptr)
+				{
+					cv::Rect area = results[j]->Drawable()->CutArea();
+					double intersection = (area & scene.areas[i]).area();
+					double unified = area.area() + scene.areas[i].area() - intersection;
+					hit = unified > 0 && intersection / unified >= 0.5;
+				}
+			}
+			found += hit ? 1 : 0;
+		}
+
+		return found;
+	}
+}
+
+void Companion::Benchmark::RecognitionBench(std::ostream& out)
+{
+	const int frames = 16;
+	const int sceneCount = 4;
+	const int objectsPerScene = 3;
+	const std::vector<std::string> algorithms = { "match", "hash", "hybrid", "detection" };
+	const std::vector<int> modelCounts = { 1, 4, 16 };
+	// Scene resolution of each scaling, scenes are created at the size the recognition scales to
+	const std::vector<std::pair<Companion::SCALING, cv::Size>> scalings = {
+		std::make_pair(Companion::SCALING::SCALE_640x360, cv::Size(640, 360)),
+		std::make_pair(Companion::SCALING::SCALE_1280x720, cv::Size(1280, 720)),
+		std::make_pair(Companion::SCALING::SCALE_1920x1080, cv::Size(1920, 1080)) };
+	std::vector<int> threadCounts = { 1, 2, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) };
+	cv::RNG rng(4711);
+	std::vector<cv::Mat> allModels;
+
+	threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
+	for (int i = 0; i < modelCounts.back(); i++)
+	{
+		allModels.push_back(RandomTexture(cv::Size(200, 200), rng));
+	}
+
+	for (size_t m = 0; m < modelCounts.size(); m++)
+	{
+		std::vector<cv::Mat> models(allModels.begin(), allModels.begin() + modelCounts[m]);
+
+		for (size_t s = 0; s < scalings.size(); s++)
+		{
+			cv::Size resolution = scalings[s].second;
+			std::vector<SyntheticScene> syntheticScenes;
+			std::vector<cv::Mat> scenes;
+
+			// Same scenes for every algorithm and thread count of this configuration
+			for (int i = 0; i < sceneCount; i++)
+			{
+				syntheticScenes.push_back(WarpedScene(resolution, models, objectsPerScene, rng));
+				scenes.push_back(syntheticScenes.back().image);
+			}
+
+			for (size_t a = 0; a < algorithms.size(); a++)
+			{
+				PTR_IMAGE_PROCESSING processing = CreateProcessing(algorithms[a], models, scalings[s].first);
+
+				for (size_t t = 0; t < threadCounts.size(); t++)
+				{
+					std::atomic<int> delivered(0);
+					std::mutex resultMutex;
+					std::vector<double> latencies;
+					int objects = 0;
+					int found = 0;
+					Companion::Configuration configuration;
+					std::shared_ptr<SceneStream> stream = std::make_shared<SceneStream>(scenes, frames, delivered);
+
+					configuration.Source(stream);
+					configuration.Processing(processing);
+					configuration.ConsumerThreads(threadCounts[t]);
+					configuration.ImageBuffer(threadCounts[t]);
+					configuration.ErrorCallback([&](Companion::Error::Code)
+					{
+						std::lock_guard<std::mutex> lock(resultMutex);
+						delivered++;
+					});
+					configuration.ResultCallback([&](CALLBACK_RESULT results, cv::Mat)
+					{
+						std::lock_guard<std::mutex> lock(resultMutex);
+						// Results are delivered in frame order, failed frames count as delivered too
+						int frame = delivered;
+						const SyntheticScene& scene = syntheticScenes[frame % syntheticScenes.size()];
+						latencies.push_back(ElapsedMs(stream->Obtained(frame)));
+						objects += static_cast<int>(scene.models.size());
+						found += Found(scene, results);
+						delivered++;
+					});
+
+					Clock::time_point start = Clock::now();
+					configuration.Run();
+					double elapsed = ElapsedMs(start);
+
+					out << "{\"benchmark\":\"recognition\""
+						<< ",\"algorithm\":\"" << algorithms[a] << "\""
+						<< ",\"models\":" << modelCounts[m]
+						<< ",\"width\":" << resolution.width
+						<< ",\"height\":" << resolution.height
+						<< ",\"threads\":" << threadCounts[t]
+						<< ",\"frames\":" << delivered
+						<< ",\"fps\":" << (delivered / (elapsed / 1000.0))
+						<< ",\"p50_ms\":" << Percentile(latencies, 50)
+						<< ",\"p99_ms\":" << Percentile(latencies, 99)
+						<< ",\"recall\":" << (objects > 0 ? static_cast<double>(found) / objects : 0.0)
+						<< "}" << std::endl;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,85 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <companion/algo/recognition/matching/FeatureMatching.h>
+#include <omp.h>
+
+void Companion::Benchmark::SceneFeaturesBench(std::ostream& out)
+{
+	const int modelCounts[] = { 1, 10, 50, 100, 300 };
+	const int frames = 3;
+	cv::RNG rng(4711);
+
+	cv::Ptr<cv::ORB> orb = cv::ORB::create();
+	PTR_FEATURE_MATCHING featureMatching = std::make_shared<FEATURE_MATCHING>(orb,
+		orb,
+		cv::DescriptorMatcher::create("BruteForce-Hamming"),
+		cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
+
+	std::vector<cv::Mat> images;
+	std::vector<PTR_MODEL_FEATURE_MATCHING> models;
+	for (int i = 0; i < modelCounts[4]; i++)
+	{
+		PTR_MODEL_FEATURE_MATCHING model = std::make_shared<MODEL_FEATURE_MATCHING>();
+		images.push_back(RandomTexture(cv::Size(200, 200), rng));
+		model->ID(i);
+		model->Image(images.back());
+		featureMatching->CalculateKeyPoints(model);
+		models.push_back(model);
+	}
+
+	cv::Mat scene = RandomScene(cv::Size(1280, 720), std::vector<cv::Mat>(images.begin(), images.begin() + 4), rng);
+
+	for (int modelCount : modelCounts)
+	{
+		double uncached = 0.0;
+		double cached = 0.0;
+
+		for (int frame = 0; frame < frames; frame++)
+		{
+			for (int useCache = 0; useCache <= 1; useCache++)
+			{
+				PTR_MODEL_FEATURE_MATCHING sceneModel = std::make_shared<MODEL_FEATURE_MATCHING>();
+				Clock::time_point start = Clock::now();
+
+				sceneModel->Image(scene);
+				if (useCache)
+				{
+					featureMatching->CalculateSceneFeatures(sceneModel);
+				}
+
+				// Same model loop as MatchRecognition::Execute
+				#pragma omp parallel for
+				for (int x = 0; x < modelCount; x++)
+				{
+					featureMatching->ExecuteAlgorithm(sceneModel, models.at(x), nullptr);
+				}
+
+				(useCache ? cached : uncached) += ElapsedMs(start);
+			}
+		}
+
+		out << "scene_features models=" << modelCount
+			<< " threads=" << omp_get_max_threads()
+			<< " uncached_ms=" << (uncached / frames)
+			<< " cached_ms=" << (cached / frames)
+			<< " speedup=" << (uncached / std::max(cached, 1e-9)) << std::endl;
+	}
+}
@@ -0,0 +1,98 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <cmath>
+#include <omp.h>
+#include <companion/thread/TaskPool.h>
+
+/**
+ * Synthetic matching work of a model in a region of interest.
+ * @param cost Number of iterations.
+ * @return Checksum to keep the work from being optimized away.
+ */
+static double MatchWork(int cost)
+{
+	double value = 0;
+	for (int i = 0; i < cost; i++)
+	{
+		value += std::sqrt(static_cast<double>(i) + value);
+	}
+	return value;
+}
+
+void Companion::Benchmark::TaskPoolBench(std::ostream& out)
+{
+	const int models = 24;
+	const int rois = 4;
+	const int frames = 50;
+	const int cost = 20000;
+	std::vector<int> costs(models * rois);
+	PTR_TASK_POOL pool = Companion::Thread::TaskPool::Shared();
+	double checksum = 0;
+
+	// Uneven load, few models in few regions are expensive like large or well textured objects
+	for (size_t i = 0; i < costs.size(); i++)
+	{
+		costs[i] = i % 7 == 0 ? cost * 10 : cost;
+	}
+
+	// Former loop over models, each model matches all its regions
+	Clock::time_point start = Clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		std::vector<double> results(models);
+		#pragma omp parallel for
+		for (int x = 0; x < models; x++)
+		{
+			for (int roi = 0; roi < rois; roi++)
+			{
+				results[x] += MatchWork(costs[roi * models + x]);
+			}
+		}
+		for (double result : results)
+		{
+			checksum += result;
+		}
+	}
+	double ompMs = ElapsedMs(start) / frames;
+
+	// Each model and region pair is a task, results are gathered per slot
+	start = Clock::now();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		std::vector<double> results(pool->Concurrency());
+		pool->ParallelFor(static_cast<int>(costs.size()), [&](int task, int slot)
+		{
+			results[slot] += MatchWork(costs[task]);
+		});
+		for (double result : results)
+		{
+			checksum += result;
+		}
+	}
+	double poolMs = ElapsedMs(start) / frames;
+
+	out << "task_pool models=" << models
+		<< " rois=" << rois
+		<< " threads=" << pool->Concurrency()
+		<< " omp_frame_ms=" << ompMs
+		<< " pool_frame_ms=" << poolMs
+		<< " checksum=" << (checksum > 0 ? 1 : 0) << std::endl;
+}
@@ -0,0 +1,75 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <companion/processing/recognition/MatchRecognition.h>
+
+void Companion::Benchmark::TrackingBench(std::ostream& out)
+{
+	const int frames = 60;
+	const int keyframeIntervals[] = { 0, 10, 30 };
+	cv::RNG rng(4711);
+
+	cv::Mat object = RandomTexture(cv::Size(240, 240), rng);
+	cv::Mat background = RandomTexture(cv::Size(1280, 720), rng);
+	std::vector<cv::Mat> scenes;
+
+	// Object moves slowly over a static background
+	for (int i = 0; i < frames; i++)
+	{
+		cv::Mat scene = background.clone();
+		object.copyTo(scene(cv::Rect(200 + 4 * i, 150 + 2 * i, object.cols, object.rows)));
+		scenes.push_back(scene);
+	}
+
+	for (int keyframeInterval : keyframeIntervals)
+	{
+		cv::Ptr<cv::ORB> orb = cv::ORB::create(2000);
+		PTR_FEATURE_MATCHING featureMatching = std::make_shared<FEATURE_MATCHING>(orb,
+			orb,
+			cv::DescriptorMatcher::create("BruteForce-Hamming"),
+			cv::DescriptorMatcher::BRUTEFORCE_HAMMING);
+		PTR_MATCH_RECOGNITION recognition = std::make_shared<MATCH_RECOGNITION>(featureMatching, Companion::SCALING::SCALE_1280x720);
+		PTR_MODEL_FEATURE_MATCHING model = std::make_shared<MODEL_FEATURE_MATCHING>();
+		std::vector<double> times;
+		int found = 0;
+
+		model->ID(0);
+		model->Image(object);
+		recognition->AddModel(model);
+
+		if (keyframeInterval > 0)
+		{
+			recognition->Tracking(std::make_shared<KLT_TRACKING>(keyframeInterval));
+		}
+
+		for (int i = 0; i < frames; i++)
+		{
+			Clock::time_point start = Clock::now();
+			found += static_cast<int>(recognition->Execute(scenes[i].clone()).size());
+			times.push_back(ElapsedMs(start));
+		}
+
+		out << "tracking keyframe_interval=" << keyframeInterval
+			<< " frames=" << frames
+			<< " found=" << found
+			<< " p50_ms=" << Percentile(times, 50)
+			<< " p95_ms=" << Percentile(times, 95) << std::endl;
+	}
+}
@@ -0,0 +1,66 @@
+/*
+ * This program is an object recognition framework written with OpenCV.
+ * Copyright (C) 2016-2018 Andreas Sekulski, Dimitri Kotlovsky
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <functional>
+
+int main(int argc, char* argv[])
+{
+	std::map<std::string, std::function<void(std::ostream&)>> benchmarks;
+	benchmarks["scene_features"] = Companion::Benchmark::SceneFeaturesBench;
+	benchmarks["catalog"] = Companion::Benchmark::CatalogBench;
+	benchmarks["hamming"] = Companion::Benchmark::HammingBench;
+	benchmarks["match_filter"] = Companion::Benchmark::MatchFilterBench;
+	benchmarks["tracking"] = Companion::Benchmark::TrackingBench;
+	benchmarks["homography"] = Companion::Benchmark::HomographyBench;
+	benchmarks["frame_ring"] = Companion::Benchmark::FrameRingBench;
+	benchmarks["pipeline"] = Companion::Benchmark::PipelineBench;
+	benchmarks["task_pool"] = Companion::Benchmark::TaskPoolBench;
+	benchmarks["batch"] = Companion::Benchmark::BatchBench;
+	benchmarks["recognition"] = Companion::Benchmark::RecognitionBench;
+	benchmarks["allocations"] = Companion::Benchmark::AllocationBench;
+
+	if (argc > 1 && std::string(argv[1]) == "--list")
+	{
+		for (const auto& benchmark : benchmarks)
+		{
+			std::cout << benchmark.first << std::endl;
+		}
+		return 0;
+	}
+
+	for (const auto& benchmark : benchmarks)
+	{
+		bool selected = argc <= 1;
+		for (int i = 1; i < argc && !selected; i++)
+		{
+			selected = (benchmark.first == argv[i]);
+		}
+
+		if (selected)
+		{
+			benchmark.second(std::cout);
+		}
+	}
+
+	return 0;
+}